@@ -9,7 +9,8 @@ namespace game {
 	class Enemy : public SceneNode {
 
 	public:
-		Enemy(int enemyType, const std::string name, const Resource *geometry, const Resource *material, Resource* texture, SceneNode* player, ResourceManager* resman);
+		// Behaviour is driven by the entity systems, see Game::AddEnemyEntity
+		Enemy(int enemyType, const std::string name, const Resource *geometry, const Resource *material, Resource* texture);
 		~Enemy();
 
 		class EnemyException : public std::exception
@@ -30,49 +31,18 @@ namespace game {
 		void Pitch(float angle);
 		void Yaw(float angle);
 		void Roll(float angle);
-		bool Shoot();
-		glm::quat* GetShotOrientation();
-		glm::vec3 GetShotDirection();
-		void SetParentEnemy(Enemy*);
-		Enemy* GetParentEnemy();
 		int GetType();
 		void SetType(int t);
-		void SetAgro(bool agro);
-		float LoseHealth(float dmg);
-
-
-	protected:
-
-		void Update();
-
-		SceneNode* CreateMissileInstance(std::string entity_name, std::string object_name, std::string material_name);
 
 		enum enemy_type {
 			STATIONARY = 0,
 			MOVING = 1,
 			FLYING = 2
 		};
-		int type;
-		float damage;
-		float health;
-		float time;
-		float shoottime;
-		float incrementingFloat;
-		bool hasShot;
-		int shotCount;
-		bool agro;
 
-		Enemy* parentEnemy;
-
-		glm::quat shotOrientation;
-		glm::vec3 shotDirection;
-
-		SceneNode* player;
-		//glm::vec3 playerpos;
-
-		ResourceManager* enemyResMan;
+	protected:
 
-		void AttackCollisions();
+		int type;
 
 		glm::vec3 forward_; // Initial forward vector
 		glm::vec3 side_; // Initial side vector
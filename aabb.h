@@ -0,0 +1,156 @@
+#ifndef AABB_H_
+#define AABB_H_
+
+#include <utility>
+#include <glm/glm.hpp>
+
+namespace game {
+
+	// Where a moving point first touches a box
+	struct SweepHit {
+		float t; // Fraction of the motion, in [0, 1]
+		glm::vec3 normal; // Outward normal of the face touched
+		glm::vec3 point; // Contact point on that face
+	};
+
+	// Axis-aligned bounding box
+	struct AABB {
+		glm::vec3 min;
+		glm::vec3 max;
+
+		AABB(void) : min(1e30f), max(-1e30f) {}
+		AABB(glm::vec3 min, glm::vec3 max) : min(min), max(max) {}
+
+		// Box enclosing the eight corners of SceneNode::boundingBox
+		static AABB FromCorners(const glm::vec3 *corners) {
+			AABB box;
+			for (int i = 0; i < 8; i++) {
+				box.Grow(corners[i]);
+			}
+			return box;
+		}
+
+		void Grow(glm::vec3 point) {
+			min = glm::min(min, point);
+			max = glm::max(max, point);
+		}
+
+		void Grow(const AABB &box) {
+			min = glm::min(min, box.min);
+			max = glm::max(max, box.max);
+		}
+
+		glm::vec3 GetCenter(void) const {
+			return (min + max) * 0.5f;
+		}
+
+		// Half the surface area, enough to compare costs
+		float GetHalfArea(void) const {
+			glm::vec3 extent = max - min;
+			return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+		}
+
+		// Strictly inside the box
+		bool Contains(glm::vec3 point) const {
+			return point.x > min.x && point.x < max.x &&
+				point.y > min.y && point.y < max.y &&
+				point.z > min.z && point.z < max.z;
+		}
+
+		bool OverlapsSphere(glm::vec3 center, float radius) const {
+			glm::vec3 closest = glm::clamp(center, min, max);
+			glm::vec3 offset = closest - center;
+			return glm::dot(offset, offset) <= radius * radius;
+		}
+
+		// Reciprocal of each component of 'dir', for IntersectRay. Zero
+		// components map to a huge value instead of infinity, so rays lying
+		// in the plane of a face do not turn the slab test into NaN
+		static glm::vec3 InverseDirection(glm::vec3 dir) {
+			glm::vec3 inv_dir;
+			for (int i = 0; i < 3; i++) {
+				inv_dir[i] = (dir[i] != 0.0f) ? 1.0f / dir[i] : 1e30f;
+			}
+			return inv_dir;
+		}
+
+		// Slab test of the ray 'origin + t * dir' against the box, where
+		// 'inv_dir' comes from InverseDirection(dir). On a
+		// hit within [0, t_max], sets 't_hit' to the entry point (0 if the
+		// origin is inside)
+		bool IntersectRay(glm::vec3 origin, glm::vec3 inv_dir, float t_max, float &t_hit) const {
+			glm::vec3 t0 = (min - origin) * inv_dir;
+			glm::vec3 t1 = (max - origin) * inv_dir;
+			glm::vec3 t_near = glm::min(t0, t1);
+			glm::vec3 t_far = glm::max(t0, t1);
+			float enter = glm::max(glm::max(t_near.x, t_near.y), glm::max(t_near.z, 0.0f));
+			float exit = glm::min(glm::min(t_far.x, t_far.y), glm::min(t_far.z, t_max));
+			if (enter > exit) {
+				return false;
+			}
+			t_hit = enter;
+			return true;
+		}
+
+		// Slab test of a point moving from 'from' to 'to'. Reports the first
+		// face crossed; a point that starts inside leaves through the
+		// closest face, with t = 0
+		bool Sweep(glm::vec3 from, glm::vec3 to, SweepHit &hit) const {
+			glm::vec3 dir = to - from;
+			glm::vec3 inv_dir = InverseDirection(dir);
+			float enter = -1e30f;
+			float exit = 1e30f;
+			int axis = 0;
+			float side = -1.0f;
+			for (int i = 0; i < 3; i++) {
+				float t_min = (min[i] - from[i]) * inv_dir[i];
+				float t_max = (max[i] - from[i]) * inv_dir[i];
+				float face = -1.0f;
+				if (t_min > t_max) {
+					std::swap(t_min, t_max);
+					face = 1.0f;
+				}
+				if (t_min > enter) {
+					enter = t_min;
+					axis = i;
+					side = face;
+				}
+				exit = glm::min(exit, t_max);
+			}
+			if (enter > exit || exit < 0.0f || enter > 1.0f) {
+				return false;
+			}
+
+			hit.normal = glm::vec3(0.0f);
+			if (enter >= 0.0f) {
+				hit.t = enter;
+				hit.normal[axis] = side;
+				hit.point = from + dir * enter;
+				return true;
+			}
+
+			// Started inside: push out along the shallowest axis
+			float depth = 1e30f;
+			for (int i = 0; i < 3; i++) {
+				if (from[i] - min[i] < depth) {
+					depth = from[i] - min[i];
+					axis = i;
+					side = -1.0f;
+				}
+				if (max[i] - from[i] < depth) {
+					depth = max[i] - from[i];
+					axis = i;
+					side = 1.0f;
+				}
+			}
+			hit.t = 0.0f;
+			hit.normal[axis] = side;
+			hit.point = from;
+			hit.point[axis] = (side < 0.0f) ? min[axis] : max[axis];
+			return true;
+		}
+	};
+
+} // namespace game
+
+#endif // AABB_H_
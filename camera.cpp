@@ -10,6 +10,8 @@
 namespace game {
 
 Camera::Camera(void){
+
+    interpolation_ = 1.0f;
 }
 
 
@@ -111,6 +113,20 @@ void Camera::SetView(glm::vec3 position, glm::vec3 look_at, glm::vec3 up){
     // Reset orientation and position of camera
     position_ = position;
     orientation_ = glm::quat();
+    SaveState();
+}
+
+
+void Camera::SaveState(void){
+
+    previous_position_ = position_;
+    previous_orientation_ = orientation_;
+}
+
+
+void Camera::SetInterpolation(float interpolation){
+
+    interpolation_ = interpolation;
 }
 
 
@@ -145,8 +161,10 @@ void Camera::SetupViewMatrix(void){
     // Get current vectors of coordinate system
     // [side, up, forward]
     // See slide in "Camera control" for details
-    glm::vec3 current_forward = orientation_ * forward_;
-    glm::vec3 current_side = orientation_ * side_;
+    glm::quat orientation = glm::slerp(previous_orientation_, orientation_, interpolation_);
+    glm::vec3 position = glm::mix(previous_position_, position_, interpolation_);
+    glm::vec3 current_forward = orientation * forward_;
+    glm::vec3 current_side = orientation * side_;
     glm::vec3 current_up = glm::cross(current_forward, current_side);
     current_up = glm::normalize(current_up);
 
@@ -169,7 +187,7 @@ void Camera::SetupViewMatrix(void){
     view_matrix_[2][2] = current_forward[2];
 
     // Create translation to camera position
-    glm::mat4 trans = glm::translate(glm::mat4(1.0), -position_);
+    glm::mat4 trans = glm::translate(glm::mat4(1.0), -position);
 
     // Combine translation and view matrix in proper order
     view_matrix_ *= trans;
@@ -48,9 +48,18 @@ namespace game {
             // Set all camera-related variables in shader program
             void SetupShader(GLuint program);
 
+            // Keep the position and orientation of the last simulation
+            // tick. The view is drawn between them and the current ones,
+            // by the fraction of a tick set with SetInterpolation
+            void SaveState(void);
+            void SetInterpolation(float interpolation);
+
         protected:
             glm::vec3 position_; // Position of camera
             glm::quat orientation_; // Orientation of camera
+            glm::vec3 previous_position_; // Position and orientation at the last tick
+            glm::quat previous_orientation_;
+            float interpolation_; // Fraction of a tick drawn past the last one
             glm::vec3 forward_; // Initial forward vector
             glm::vec3 side_; // Initial side vector
             glm::mat4 view_matrix_; // View matrix
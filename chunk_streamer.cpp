@@ -0,0 +1,393 @@
+#include <cmath>
+#include <algorithm>
+
+#include "chunk_streamer.h"
+#include "random.h"
+#include "world_snapshot.h"
+
+namespace game {
+
+	// Sides of the buildings in a chunk. Lots are kept half the largest
+	// side away from the edges of their chunk, so none crosses into a
+	// neighbour
+	const int chunk_building_min_g = 4;
+	const int chunk_building_max_g = 23;
+
+	// Floats per baked vertex: position (3), normal (3), color (3),
+	// texture coordinates (2), as in the cube of the resource manager
+	const int chunk_vertex_att_g = 11;
+
+	// Floor slab under each chunk, with its top at y = 0
+	const float chunk_floor_depth_g = 10.0f;
+
+	// Side of the cells of the collision grid of each chunk
+	const float chunk_grid_cell_g = 32.0f;
+
+
+	ChunkStreamer::ChunkStreamer(void) {
+
+		seed_ = 0;
+		world_min_ = glm::vec2(0.0f);
+		world_max_ = glm::vec2(0.0f);
+		chunk_size_ = 200.0f;
+		radius_ = 300.0f;
+		spacing_ = 36.0f;
+		city_min_ = glm::vec2(-1e30f);
+		city_max_ = glm::vec2(1e30f);
+		loader_count_ = 2;
+		snapshot_ = NULL;
+		stop_ = false;
+		started_ = false;
+	}
+
+
+	ChunkStreamer::~ChunkStreamer() {
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stop_ = true;
+		}
+		work_cv_.notify_all();
+		for (size_t i = 0; i < loaders_.size(); i++) {
+			loaders_[i].join();
+		}
+
+		// Attached chunks belong to the streamer until they are detached
+		for (std::map<uint64_t, Slot>::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+			delete it->second.chunk;
+		}
+	}
+
+
+	void ChunkStreamer::SetSeed(uint64_t seed) {
+
+		seed_ = seed;
+	}
+
+
+	void ChunkStreamer::SetWorld(glm::vec2 min, glm::vec2 max) {
+
+		world_min_ = min;
+		world_max_ = max;
+	}
+
+
+	void ChunkStreamer::SetChunkSize(float size) {
+
+		chunk_size_ = size;
+	}
+
+
+	void ChunkStreamer::SetRadius(float radius) {
+
+		radius_ = radius;
+	}
+
+
+	void ChunkStreamer::SetSpacing(float spacing) {
+
+		spacing_ = spacing;
+	}
+
+
+	void ChunkStreamer::SetCityArea(glm::vec2 min, glm::vec2 max) {
+
+		city_min_ = min;
+		city_max_ = max;
+	}
+
+
+	void ChunkStreamer::SetLoaderCount(int loaders) {
+
+		loader_count_ = loaders;
+	}
+
+
+	void ChunkStreamer::SetSnapshot(const WorldSnapshot *snapshot) {
+
+		snapshot_ = snapshot;
+	}
+
+
+	void ChunkStreamer::Update(glm::vec3 center, std::vector<WorldChunk *> &attached, std::vector<WorldChunk *> &detached) {
+
+		if (!started_) {
+			StartLoaders();
+		}
+
+		glm::vec2 point(center.x, center.z);
+		float prefetch = radius_ + chunk_size_;
+		float evict = radius_ + 2.0f * chunk_size_;
+		int columns = (int) std::ceil((world_max_.x - world_min_.x) / chunk_size_);
+		int rows = (int) std::ceil((world_max_.y - world_min_.y) / chunk_size_);
+		int first_column = std::max((int) std::floor((point.x - prefetch - world_min_.x) / chunk_size_), 0);
+		int last_column = std::min((int) std::floor((point.x + prefetch - world_min_.x) / chunk_size_), columns - 1);
+		int first_row = std::max((int) std::floor((point.y - prefetch - world_min_.y) / chunk_size_), 0);
+		int last_row = std::min((int) std::floor((point.y + prefetch - world_min_.y) / chunk_size_), rows - 1);
+
+		std::unique_lock<std::mutex> lock(mutex_);
+
+		// Queue the chunks the player may reach soon, nearest first
+		std::vector<std::pair<float, uint64_t> > wanted;
+		for (int row = first_row; row <= last_row; row++) {
+			for (int column = first_column; column <= last_column; column++) {
+				float distance = GetDistance(column, row, point);
+				uint64_t key = GetKey(column, row);
+				if (distance > prefetch || slots_.count(key)) {
+					continue;
+				}
+				WorldChunk *chunk = new WorldChunk();
+				chunk->column = column;
+				chunk->row = row;
+				chunk->min = world_min_ + glm::vec2((float) column, (float) row) * chunk_size_;
+				chunk->max = glm::min(chunk->min + glm::vec2(chunk_size_), world_max_);
+				chunk->buildings = NULL;
+				chunk->ground = NULL;
+				chunk->geometry = NULL;
+				Slot slot = { chunk, QUEUED };
+				slots_[key] = slot;
+				wanted.push_back(std::make_pair(distance, key));
+			}
+		}
+		std::sort(wanted.begin(), wanted.end());
+		for (size_t i = 0; i < wanted.size(); i++) {
+			queue_.push_back(wanted[i].second);
+		}
+		if (!wanted.empty()) {
+			work_cv_.notify_all();
+		}
+
+		// Attach the chunks within the radius. A chunk the loaders have
+		// not reached yet is generated here rather than waited for
+		for (int row = first_row; row <= last_row; row++) {
+			for (int column = first_column; column <= last_column; column++) {
+				if (GetDistance(column, row, point) > radius_) {
+					continue;
+				}
+				Slot &slot = slots_[GetKey(column, row)];
+				if (slot.state == ATTACHED) {
+					continue;
+				}
+				if (slot.state == QUEUED) {
+					queue_.erase(std::find(queue_.begin(), queue_.end(), GetKey(column, row)));
+					slot.state = GENERATING;
+					WorldChunk *chunk = slot.chunk;
+					lock.unlock();
+					Generate(*chunk);
+					lock.lock();
+				} else {
+					uint64_t key = GetKey(column, row);
+					ready_cv_.wait(lock, [&]() { return slots_[key].state == READY; });
+				}
+				Slot &ready = slots_[GetKey(column, row)];
+				ready.state = ATTACHED;
+				attached.push_back(ready.chunk);
+			}
+		}
+
+		// Detach a chunk past the radius by a chunk, and drop chunks
+		// generated ahead of time that the player turned away from
+		std::map<uint64_t, Slot>::iterator it = slots_.begin();
+		while (it != slots_.end()) {
+			Slot &slot = it->second;
+			float distance = GetDistance(slot.chunk->column, slot.chunk->row, point);
+			if (slot.state == ATTACHED && distance > prefetch) {
+				detached.push_back(slot.chunk);
+				it = slots_.erase(it);
+			} else if ((slot.state == READY || slot.state == QUEUED) && distance > evict) {
+				std::map<uint64_t, Slot>::iterator next = it;
+				++next;
+				Discard(it);
+				it = next;
+			} else {
+				++it;
+			}
+		}
+	}
+
+
+	void ChunkStreamer::Release(WorldChunk *chunk) {
+
+		delete chunk;
+	}
+
+
+	void ChunkStreamer::GetAttached(std::vector<WorldChunk *> &chunks) const {
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (std::map<uint64_t, Slot>::const_iterator it = slots_.begin(); it != slots_.end(); ++it) {
+			if (it->second.state == ATTACHED) {
+				chunks.push_back(it->second.chunk);
+			}
+		}
+	}
+
+
+	void ChunkStreamer::StartLoaders(void) {
+
+		started_ = true;
+		for (int i = 0; i < loader_count_; i++) {
+			loaders_.push_back(std::thread(&ChunkStreamer::LoaderLoop, this));
+		}
+	}
+
+
+	void ChunkStreamer::LoaderLoop(void) {
+
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (true) {
+			work_cv_.wait(lock, [&]() { return stop_ || !queue_.empty(); });
+			if (stop_) {
+				return;
+			}
+
+			// A chunk being generated is never discarded, so its slot is
+			// still there afterwards
+			uint64_t key = queue_.front();
+			queue_.pop_front();
+			slots_[key].state = GENERATING;
+			WorldChunk *chunk = slots_[key].chunk;
+			lock.unlock();
+			Generate(*chunk);
+			lock.lock();
+			slots_[key].state = READY;
+			ready_cv_.notify_all();
+		}
+	}
+
+
+	void ChunkStreamer::Generate(WorldChunk &chunk) const {
+
+		if (snapshot_ && snapshot_->GetChunk(chunk)) {
+			Bake(chunk);
+			BuildCollision(chunk);
+			return;
+		}
+
+		// The layout depends only on the seed and the chunk coordinates
+		Random random(seed_, GetKey(chunk.column, chunk.row));
+		CityGenerator generator;
+		generator.SetBuildingSize(chunk_building_min_g, chunk_building_max_g);
+		float inset = chunk_building_max_g / 2.0f;
+		glm::vec2 min = glm::max(chunk.min + inset, city_min_);
+		glm::vec2 max = glm::min(chunk.max - inset, city_max_);
+		if (min.x < max.x && min.y < max.y) {
+			generator.Generate(min, max, spacing_, random, chunk.lots);
+		}
+
+		for (size_t i = 0; i < chunk.lots.size(); i++) {
+			const BuildingLot &lot = chunk.lots[i];
+			glm::vec3 position(lot.center.x, lot.size.y / 2.0f, lot.center.y);
+			glm::vec3 half = lot.size / 2.0f;
+			chunk.boxes.push_back(AABB(position - half, position + half));
+
+			// Top corners then bottom ones; each set is -x+z, +x+z, -x-z, +x-z
+			for (int y = 1; y >= -1; y -= 2) {
+				for (int z = 1; z >= -1; z -= 2) {
+					for (int x = -1; x <= 1; x += 2) {
+						chunk.corners.push_back(position + half * glm::vec3((float) x, (float) y, (float) z));
+					}
+				}
+			}
+		}
+		chunk.boxes.push_back(AABB(glm::vec3(chunk.min.x, -chunk_floor_depth_g, chunk.min.y), glm::vec3(chunk.max.x, 0.0f, chunk.max.y)));
+
+		Bake(chunk);
+		BuildCollision(chunk);
+	}
+
+
+	void ChunkStreamer::BuildCollision(WorldChunk &chunk) const {
+
+		chunk.grid.Reset(chunk.min, chunk.max, chunk_grid_cell_g);
+		for (size_t i = 0; i < chunk.boxes.size(); i++) {
+			const AABB &box = chunk.boxes[i];
+			chunk.grid.Insert((int) i, glm::vec2(box.min.x, box.min.z), glm::vec2(box.max.x, box.max.z));
+		}
+		chunk.grid.Build();
+		chunk.bvh.Build(chunk.boxes);
+
+		int cells = chunk.grid.GetCellCount();
+		chunk.cell_boxes.resize(cells);
+		for (int cell = 0; cell < cells; cell++) {
+			int count;
+			const int *items = chunk.grid.GetItems(cell, count);
+			for (int i = 0; i < count; i++) {
+				chunk.cell_boxes[cell].Add(chunk.boxes[items[i]]);
+			}
+		}
+	}
+
+
+	void ChunkStreamer::Bake(WorldChunk &chunk) const {
+
+		// Each face is spanned by two axes u and v with u x v pointing out
+		// of the cube, so both triangles wind counter-clockwise
+		static const int axes[6][3] = {
+			{ 0, 1, 2 }, { 0, 2, 1 }, // +x, -x: normal axis, u axis, v axis
+			{ 1, 2, 0 }, { 1, 0, 2 }, // +y, -y
+			{ 2, 0, 1 }, { 2, 1, 0 }  // +z, -z
+		};
+		static const float corners[6][2] = {
+			{ 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f },
+			{ 1.0f, 1.0f }, { 0.0f, 1.0f }, { 0.0f, 0.0f }
+		};
+
+		chunk.vertices.reserve(chunk.lots.size() * 36 * chunk_vertex_att_g);
+		for (size_t i = 0; i < chunk.lots.size(); i++) {
+			const BuildingLot &lot = chunk.lots[i];
+			glm::vec3 position(lot.center.x, lot.size.y / 2.0f, lot.center.y);
+			for (int face = 0; face < 6; face++) {
+				float sign = (face % 2 == 0) ? 1.0f : -1.0f;
+				glm::vec3 normal(0.0f);
+				normal[axes[face][0]] = sign;
+				for (int k = 0; k < 6; k++) {
+					// Point on the unit cube, then placed on the lot
+					glm::vec3 unit(0.0f);
+					unit[axes[face][0]] = 0.5f * sign;
+					unit[axes[face][1]] = corners[k][0] - 0.5f;
+					unit[axes[face][2]] = corners[k][1] - 0.5f;
+					glm::vec3 vertex = position + unit * lot.size;
+					glm::vec3 color = unit + 0.5f;
+					for (int a = 0; a < 3; a++) {
+						chunk.vertices.push_back(vertex[a]);
+					}
+					for (int a = 0; a < 3; a++) {
+						chunk.vertices.push_back(normal[a]);
+					}
+					for (int a = 0; a < 3; a++) {
+						chunk.vertices.push_back(color[a]);
+					}
+					chunk.vertices.push_back(corners[k][0]);
+					chunk.vertices.push_back(corners[k][1]);
+				}
+			}
+		}
+	}
+
+
+	uint64_t ChunkStreamer::GetKey(int column, int row) {
+
+		return ((uint64_t) (uint32_t) column << 32) | (uint32_t) row;
+	}
+
+
+	float ChunkStreamer::GetDistance(int column, int row, glm::vec2 point) const {
+
+		glm::vec2 min = world_min_ + glm::vec2((float) column, (float) row) * chunk_size_;
+		glm::vec2 max = min + glm::vec2(chunk_size_);
+		glm::vec2 nearest = glm::clamp(point, min, max);
+		return glm::length(point - nearest);
+	}
+
+
+	void ChunkStreamer::Discard(std::map<uint64_t, Slot>::iterator it) {
+
+		if (it->second.state == QUEUED) {
+			queue_.erase(std::find(queue_.begin(), queue_.end(), it->first));
+		}
+		delete it->second.chunk;
+		slots_.erase(it);
+	}
+
+} // namespace game
@@ -0,0 +1,140 @@
+#ifndef CHUNK_STREAMER_H_
+#define CHUNK_STREAMER_H_
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdint.h>
+#include <glm/glm.hpp>
+
+#include "aabb.h"
+#include "city_generator.h"
+#include "uniform_grid.h"
+#include "static_bvh.h"
+#include "point_box_batch.h"
+#include "component_array.h"
+
+namespace game {
+
+	class SceneNode;
+	class Resource;
+	class WorldSnapshot;
+
+	// Static content of one square of the world
+	//
+	// Everything but the fields set by the owner is generated from the
+	// world seed and the coordinates of the chunk alone, on a loader
+	// thread. Each chunk carries its own collision structures, so
+	// attaching or detaching one leaves the others untouched
+	struct WorldChunk {
+		int column;
+		int row;
+		glm::vec2 min; // Bounds on the XZ plane
+		glm::vec2 max;
+		std::vector<BuildingLot> lots;
+		std::vector<AABB> boxes; // One per lot, then the ground slab
+		std::vector<glm::vec3> corners; // Eight per lot, ordered like SceneNode::boundingBox
+		std::vector<float> vertices; // Lots baked into one triangle list in world space, 11 floats per vertex
+
+		// Grid and hierarchy over 'boxes', holding their indices, and
+		// the boxes of each grid cell packed for batch point tests, in
+		// the order the grid lists them
+		UniformGrid grid;
+		StaticBVH bvh;
+		std::vector<BoxSoA> cell_boxes;
+
+		// Set by the owner of the streamer while the chunk is attached
+		SceneNode *buildings;
+		SceneNode *ground;
+		Resource *geometry;
+		std::vector<EntityId> entities; // Spawned on the chunk, and evicted with it
+	};
+
+	// Keeps the chunks of the world around a point resident
+	//
+	// Chunks a little beyond the radius are generated ahead of time on
+	// loader threads. Attaching and detaching depend only on the position
+	// passed to Update: a chunk entering the radius is attached at once,
+	// waiting for (or generating) it if needed, and a chunk is detached
+	// once it is a chunk past the radius. So the resident set never
+	// depends on thread timing, and memory depends on the radius, not on
+	// the size of the world
+	class ChunkStreamer {
+
+	public:
+		ChunkStreamer(void);
+		~ChunkStreamer();
+
+		// Configuration; set before the first Update
+		void SetSeed(uint64_t seed);
+		void SetWorld(glm::vec2 min, glm::vec2 max);
+		void SetChunkSize(float size);
+		void SetRadius(float radius);
+		void SetSpacing(float spacing); // Least distance between buildings
+		void SetCityArea(glm::vec2 min, glm::vec2 max); // Building centers stay in this rectangle
+		void SetLoaderCount(int loaders);
+
+		// Chunks found in 'snapshot' are copied from it rather than
+		// generated. The snapshot must outlive the streamer
+		void SetSnapshot(const WorldSnapshot *snapshot);
+
+		// Stream around 'center'. Chunks to attach are appended to
+		// 'attached', and chunks to detach to 'detached'; hand the latter
+		// back with Release once their scene nodes are gone
+		void Update(glm::vec3 center, std::vector<WorldChunk *> &attached, std::vector<WorldChunk *> &detached);
+		void Release(WorldChunk *chunk);
+
+		// Attached chunks, in a fixed order
+		void GetAttached(std::vector<WorldChunk *> &chunks) const;
+
+		// Key of the chunk at 'column' and 'row', also the stream of its
+		// generator
+		static uint64_t GetKey(int column, int row);
+
+	private:
+		enum ChunkState { QUEUED, GENERATING, READY, ATTACHED };
+		struct Slot {
+			WorldChunk *chunk;
+			ChunkState state;
+		};
+
+		uint64_t seed_;
+		glm::vec2 world_min_;
+		glm::vec2 world_max_;
+		float chunk_size_;
+		float radius_;
+		float spacing_;
+		glm::vec2 city_min_;
+		glm::vec2 city_max_;
+		int loader_count_;
+		const WorldSnapshot *snapshot_;
+
+		std::map<uint64_t, Slot> slots_; // By chunk key; ordered, so iteration is stable
+		std::deque<uint64_t> queue_; // Chunks waiting for a loader
+		std::vector<std::thread> loaders_;
+		mutable std::mutex mutex_;
+		std::condition_variable work_cv_; // Signalled when the queue grows or on shutdown
+		std::condition_variable ready_cv_; // Signalled when a chunk is generated
+		bool stop_;
+		bool started_;
+
+		void StartLoaders(void);
+		void LoaderLoop(void);
+		void Generate(WorldChunk &chunk) const;
+		void Bake(WorldChunk &chunk) const;
+		void BuildCollision(WorldChunk &chunk) const;
+
+		float GetDistance(int column, int row, glm::vec2 point) const;
+		void Discard(std::map<uint64_t, Slot>::iterator it);
+
+		ChunkStreamer(const ChunkStreamer &);
+		ChunkStreamer &operator=(const ChunkStreamer &);
+
+	}; // class ChunkStreamer
+
+} // namespace game
+
+#endif // CHUNK_STREAMER_H_
@@ -0,0 +1,150 @@
+#include <cmath>
+#include <algorithm>
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/constants.hpp>
+
+#include "city_generator.h"
+
+namespace game {
+
+	CityGenerator::CityGenerator(void) {
+
+		min_size_ = 4;
+		max_size_ = 23;
+		attempts_ = 30;
+	}
+
+
+	CityGenerator::~CityGenerator() {
+	}
+
+
+	void CityGenerator::SetBuildingSize(int min_size, int max_size) {
+
+		min_size_ = min_size;
+		max_size_ = max_size;
+	}
+
+
+	void CityGenerator::SetAttempts(int attempts) {
+
+		attempts_ = attempts;
+	}
+
+
+	void CityGenerator::Generate(glm::vec2 min, glm::vec2 max, float spacing, Random &random, std::vector<BuildingLot> &lots) {
+
+		occupancy_.Reset((int) std::ceil(max.x - min.x), (int) std::ceil(max.y - min.y));
+
+		std::vector<glm::vec2> points;
+		SamplePoints(min, max, spacing, random, points);
+		for (size_t i = 0; i < points.size(); i++) {
+			BuildingLot lot;
+			if (PlaceLot(min, points[i], random, lot)) {
+				lots.push_back(lot);
+			}
+		}
+	}
+
+
+	const OccupancyGrid &CityGenerator::GetOccupancy(void) const {
+
+		return occupancy_;
+	}
+
+
+	void CityGenerator::SamplePoints(glm::vec2 min, glm::vec2 max, float spacing, Random &random, std::vector<glm::vec2> &points) const {
+
+		glm::vec2 extent = max - min;
+		if (extent.x <= 0.0f || extent.y <= 0.0f || spacing <= 0.0f) {
+			return;
+		}
+
+		// A cell this size fits at most one point, so each candidate is
+		// checked against the points of the 5x5 cells around it
+		float cell = spacing / std::sqrt(2.0f);
+		int columns = (int) std::ceil(extent.x / cell);
+		int rows = (int) std::ceil(extent.y / cell);
+		std::vector<int> grid((size_t) columns * rows, -1);
+		std::vector<int> active;
+		float spacing2 = spacing * spacing;
+
+		glm::vec2 first = min + glm::vec2(random.NextFloat() * extent.x, random.NextFloat() * extent.y);
+		points.push_back(first);
+		active.push_back(0);
+		grid[(size_t) ((int) ((first.y - min.y) / cell)) * columns + (int) ((first.x - min.x) / cell)] = 0;
+
+		while (!active.empty()) {
+			int slot = random.NextInt((int) active.size());
+			glm::vec2 origin = points[active[slot]];
+			bool placed = false;
+
+			for (int attempt = 0; attempt < attempts_ && !placed; attempt++) {
+				// Uniform in the ring between one and two spacings away
+				float angle = random.NextFloat() * 2.0f * glm::pi<float>();
+				float radius = spacing * std::sqrt(1.0f + 3.0f * random.NextFloat());
+				glm::vec2 candidate = origin + radius * glm::vec2(std::cos(angle), std::sin(angle));
+				if (candidate.x < min.x || candidate.y < min.y || candidate.x >= max.x || candidate.y >= max.y) {
+					continue;
+				}
+
+				int column = (int) ((candidate.x - min.x) / cell);
+				int row = (int) ((candidate.y - min.y) / cell);
+				bool clear = true;
+				for (int z = std::max(row - 2, 0); z <= std::min(row + 2, rows - 1) && clear; z++) {
+					for (int x = std::max(column - 2, 0); x <= std::min(column + 2, columns - 1); x++) {
+						int other = grid[(size_t) z * columns + x];
+						if (other >= 0) {
+							glm::vec2 offset = points[other] - candidate;
+							if (glm::dot(offset, offset) < spacing2) {
+								clear = false;
+								break;
+							}
+						}
+					}
+				}
+				if (clear) {
+					grid[(size_t) row * columns + column] = (int) points.size();
+					active.push_back((int) points.size());
+					points.push_back(candidate);
+					placed = true;
+				}
+			}
+
+			// A point with no room around it is retired
+			if (!placed) {
+				active[slot] = active.back();
+				active.pop_back();
+			}
+		}
+	}
+
+
+	bool CityGenerator::PlaceLot(glm::vec2 min, glm::vec2 center, Random &random, BuildingLot &lot) {
+
+		lot.center = center;
+		lot.size = glm::vec3((float) RandomSize(random), (float) RandomSize(random), (float) RandomSize(random));
+
+		// If the footprint runs into another lot, fall back to the
+		// smallest one before giving up on the point
+		for (int attempt = 0; attempt < 2; attempt++) {
+			int x0 = (int) std::floor(center.x - min.x - lot.size.x / 2.0f);
+			int z0 = (int) std::floor(center.y - min.y - lot.size.z / 2.0f);
+			int x1 = (int) std::ceil(center.x - min.x + lot.size.x / 2.0f);
+			int z1 = (int) std::ceil(center.y - min.y + lot.size.z / 2.0f);
+			if (!occupancy_.Test(x0, z0, x1, z1)) {
+				occupancy_.Fill(x0, z0, x1, z1);
+				return true;
+			}
+			lot.size.x = lot.size.z = (float) min_size_;
+		}
+		return false;
+	}
+
+
+	int CityGenerator::RandomSize(Random &random) const {
+
+		return min_size_ + random.NextInt(max_size_ - min_size_ + 1);
+	}
+
+} // namespace game
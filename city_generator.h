@@ -0,0 +1,60 @@
+#ifndef CITY_GENERATOR_H_
+#define CITY_GENERATOR_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "occupancy_grid.h"
+#include "random.h"
+
+namespace game {
+
+	// Ground footprint and height of a building
+	struct BuildingLot {
+		glm::vec2 center; // On the XZ plane
+		glm::vec3 size;
+	};
+
+	// Lays out the buildings of a city
+	//
+	// Lot centers come from Poisson-disk sampling (Bridson's algorithm):
+	// new points are tried in a ring around points already placed and kept
+	// if no point is closer than the spacing, which a background grid with
+	// at most one point per cell answers in constant time. Footprints are
+	// then marked in a packed occupancy grid, so lots never overlap. Both
+	// steps are linear in the area
+	class CityGenerator {
+
+	public:
+		CityGenerator(void);
+		~CityGenerator();
+
+		// Sides of the buildings are whole numbers in [min_size, max_size]
+		void SetBuildingSize(int min_size, int max_size);
+
+		// Candidates tried around a point before it stops spawning others
+		void SetAttempts(int attempts);
+
+		// Fill the rectangle from 'min' to 'max' (x and z) with lots whose
+		// centers are at least 'spacing' apart. Lots are appended to 'lots'.
+		// The layout only depends on the state of 'random'
+		void Generate(glm::vec2 min, glm::vec2 max, float spacing, Random &random, std::vector<BuildingLot> &lots);
+
+		// Cells taken by the lots of the last Generate, one per unit
+		const OccupancyGrid &GetOccupancy(void) const;
+
+	private:
+		int min_size_;
+		int max_size_;
+		int attempts_;
+		OccupancyGrid occupancy_;
+
+		void SamplePoints(glm::vec2 min, glm::vec2 max, float spacing, Random &random, std::vector<glm::vec2> &points) const;
+		bool PlaceLot(glm::vec2 min, glm::vec2 center, Random &random, BuildingLot &lot);
+		int RandomSize(Random &random) const;
+
+	}; // class CityGenerator
+
+} // namespace game
+
+#endif // CITY_GENERATOR_H_
@@ -0,0 +1,117 @@
+#ifndef COMPONENT_ARRAY_H_
+#define COMPONENT_ARRAY_H_
+
+#include <vector>
+#include <stdint.h>
+
+namespace game {
+
+	// Identifier of an entity: the dense index of its scene node in the
+	// low bits, and the generation of that index in the high bits. The
+	// index of a deleted node is reused, which keeps the sparse arrays as
+	// large as the most nodes alive at once; the generation grows on each
+	// reuse, so an identifier kept past the death of its entity matches
+	// nothing instead of the next entity at its index
+	typedef uint32_t EntityId;
+
+	const EntityId INVALID_ENTITY = 0xFFFFFFFF;
+
+	const int entity_index_bits_g = 22;
+	const uint32_t entity_index_mask_g = (1u << entity_index_bits_g) - 1;
+	// Generations wrap before reaching the one of INVALID_ENTITY
+	const uint32_t entity_generation_count_g = (INVALID_ENTITY >> entity_index_bits_g);
+
+	inline uint32_t GetEntityIndex(EntityId entity) {
+		return entity & entity_index_mask_g;
+	}
+
+	inline uint32_t GetEntityGeneration(EntityId entity) {
+		return entity >> entity_index_bits_g;
+	}
+
+	inline EntityId MakeEntityId(uint32_t index, uint32_t generation) {
+		return (generation << entity_index_bits_g) | index;
+	}
+
+	// Sparse set holding one component of type T per entity
+	//
+	// Components are packed in a dense array so that systems iterate them
+	// contiguously. Removal swaps the last component into the hole, so it
+	// is O(1) but does not preserve order. When removing while iterating,
+	// iterate from the back. The sparse array is indexed by entity index,
+	// and lookups check the generation, so a stale identifier finds no
+	// component
+	template <typename T>
+	class ComponentArray {
+
+	public:
+		// Add a component to an entity, replacing any previous one
+		T &Add(EntityId entity, const T &component) {
+			uint32_t index = GetEntityIndex(entity);
+			if (index >= sparse_.size()) {
+				sparse_.resize(index + 1, INVALID_ENTITY);
+			}
+			if (sparse_[index] != INVALID_ENTITY) {
+				dense_[sparse_[index]] = component;
+				entities_[sparse_[index]] = entity;
+				return dense_[sparse_[index]];
+			}
+			sparse_[index] = (uint32_t) dense_.size();
+			dense_.push_back(component);
+			entities_.push_back(entity);
+			return dense_.back();
+		}
+
+		// Remove the component of an entity, if it has one
+		void Remove(EntityId entity) {
+			if (!Has(entity)) {
+				return;
+			}
+			uint32_t index = GetEntityIndex(entity);
+			uint32_t hole = sparse_[index];
+			uint32_t last = (uint32_t) dense_.size() - 1;
+			if (hole != last) {
+				dense_[hole] = dense_[last];
+				entities_[hole] = entities_[last];
+				sparse_[GetEntityIndex(entities_[hole])] = hole;
+			}
+			dense_.pop_back();
+			entities_.pop_back();
+			sparse_[index] = INVALID_ENTITY;
+		}
+
+		bool Has(EntityId entity) const {
+			uint32_t index = GetEntityIndex(entity);
+			return index < sparse_.size() && sparse_[index] != INVALID_ENTITY && entities_[sparse_[index]] == entity;
+		}
+
+		// Component of an entity, or NULL
+		T *Get(EntityId entity) {
+			return Has(entity) ? &dense_[sparse_[GetEntityIndex(entity)]] : NULL;
+		}
+
+		// Dense access
+		int Size(void) const { return (int) dense_.size(); }
+		T &operator[](int i) { return dense_[i]; }
+		const T &operator[](int i) const { return dense_[i]; }
+		EntityId GetEntity(int i) const { return entities_[i]; }
+		int GetIndex(EntityId entity) const { return Has(entity) ? (int) sparse_[GetEntityIndex(entity)] : -1; }
+
+		void Clear(void) {
+			for (size_t i = 0; i < entities_.size(); i++) {
+				sparse_[GetEntityIndex(entities_[i])] = INVALID_ENTITY;
+			}
+			dense_.clear();
+			entities_.clear();
+		}
+
+	private:
+		std::vector<T> dense_; // Packed components
+		std::vector<EntityId> entities_; // Owner of each packed component
+		std::vector<uint32_t> sparse_; // Entity index -> index in dense_
+
+	}; // class ComponentArray
+
+} // namespace game
+
+#endif // COMPONENT_ARRAY_H_
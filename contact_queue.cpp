@@ -0,0 +1,42 @@
+#include "contact_queue.h"
+
+namespace game {
+
+	ContactQueue::ContactQueue(void) {
+	}
+
+
+	ContactQueue::~ContactQueue() {
+	}
+
+
+	void ContactQueue::Push(const Contact &contact) {
+
+		contacts_.push_back(contact);
+	}
+
+
+	void ContactQueue::Append(const ContactQueue &other) {
+
+		contacts_.insert(contacts_.end(), other.contacts_.begin(), other.contacts_.end());
+	}
+
+
+	void ContactQueue::Clear(void) {
+
+		contacts_.clear();
+	}
+
+
+	int ContactQueue::Size(void) const {
+
+		return (int) contacts_.size();
+	}
+
+
+	const Contact &ContactQueue::operator[](int i) const {
+
+		return contacts_[i];
+	}
+
+} // namespace game
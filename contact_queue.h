@@ -0,0 +1,56 @@
+#ifndef CONTACT_QUEUE_H_
+#define CONTACT_QUEUE_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "component_array.h"
+
+namespace game {
+
+	// Kinds of contact found by collision detection
+	enum ContactType {
+		HELI_BUILDING, // The player moved into a building
+		MISSILE_BUILDING, // A player missile hit a building
+		PROJECTILE_BLOCKED, // Any other projectile is inside a building
+		ENEMY_HIT, // A weapon hit an enemy
+		HOSTAGE_REACHED // The player is close enough to pick up a hostage
+	};
+
+	// A contact, with what its response needs to know
+	struct Contact {
+		ContactType type;
+		EntityId entity; // Enemy or hostage touched; INVALID_ENTITY for world geometry
+		int projectile; // Index in the projectile store, or -1
+		float damage; // Damage dealt by ENEMY_HIT
+		glm::vec3 point; // Where a building was hit
+		glm::vec3 normal; // Face of the building that was hit
+	};
+
+	// Contacts found during a frame, handled once detection is over
+	//
+	// Detection only reads the world and pushes contacts; responses then
+	// walk the queue in order and change the world. Nothing is created or
+	// destroyed while detection loops run, so detection jobs can fill
+	// queues of their own and append them in a fixed order
+	class ContactQueue {
+
+	public:
+		ContactQueue(void);
+		~ContactQueue();
+
+		void Push(const Contact &contact);
+		void Append(const ContactQueue &other);
+		void Clear(void);
+
+		int Size(void) const;
+		const Contact &operator[](int i) const;
+
+	private:
+		std::vector<Contact> contacts_;
+
+	}; // class ContactQueue
+
+} // namespace game
+
+#endif // CONTACT_QUEUE_H_
@@ -0,0 +1,403 @@
+// Microbenchmarks of the engine hot paths
+//
+// Each benchmark runs its body in batches until a minimum time has
+// passed, a few times over, and prints the median time per call and per
+// item (node, triangle, segment, projectile...). Nothing here needs an
+// OpenGL context: drawing is covered by the CPU work it does per node.
+//
+// Options:
+//   --filter TEXT    only run the benchmarks whose name contains TEXT
+//   --min-time S     least time each measurement runs for (default 0.2)
+//   --repeats N      measurements per benchmark, of which the median is
+//                    printed (default 5)
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stack>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "bin/path_config.h"
+#include "scene_graph.h"
+#include "resource_manager.h"
+#include "aabb.h"
+#include "static_bvh.h"
+#include "point_box_batch.h"
+#include "projectile_store.h"
+#include "chunk_streamer.h"
+#include "job_system.h"
+#include "random.h"
+
+using namespace game;
+
+const double default_min_time_g = 0.2;
+const int default_repeats_g = 5;
+
+// Scene like the game's: a root holding groups of a few nodes each
+const int bench_groups_g = 400;
+const int bench_group_size_g = 5;
+
+const int bench_resources_g = 200;
+const int bench_boxes_g = 1000;
+const int bench_segments_g = 1000;
+const int bench_points_g = 10000;
+const int bench_projectiles_g = 10000;
+const float bench_world_size_g = 600.0f;
+
+// Results are summed into this so the compiler keeps the work
+static volatile float sink_g;
+
+
+// Selection and length of the measurements
+struct BenchOptions {
+	std::string filter;
+	double min_time;
+	int repeats;
+};
+
+static BenchOptions options_g = { "", default_min_time_g, default_repeats_g };
+
+
+// Time 'body', which handles 'items' items per call, and print the
+// median over the repeats
+static void Run(const std::string &name, int items, const std::function<void(void)> &body) {
+
+	if (name.find(options_g.filter) == std::string::npos) {
+		return;
+	}
+
+	// Find a batch long enough to time, then measure it repeatedly
+	body();
+	long long calls = 1;
+	std::vector<double> per_call;
+	while ((int) per_call.size() < options_g.repeats) {
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (long long i = 0; i < calls; i++) {
+			body();
+		}
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (seconds < options_g.min_time) {
+			calls = (seconds > 0.0) ? std::max(calls * 2, (long long) (calls * options_g.min_time * 1.2 / seconds)) : calls * 10;
+			per_call.clear();
+			continue;
+		}
+		per_call.push_back(seconds / calls);
+	}
+	std::sort(per_call.begin(), per_call.end());
+	double median = per_call[per_call.size() / 2];
+
+	std::cout << std::left << std::setw(36) << name << std::right
+		<< std::setw(14) << std::fixed << std::setprecision(3) << median * 1e6 << " us"
+		<< std::setw(12) << std::setprecision(2) << median * 1e9 / items << " ns/item"
+		<< std::setw(10) << calls << " calls" << std::endl;
+}
+
+
+// Scene graph of bench_groups_g groups under the root, with names like
+// the game's. Returns the root
+static SceneNode *BuildScene(std::vector<SceneNode *> &nodes) {
+
+	Random random(1, 0);
+	SceneNode *root = new SceneNode("Root", NULL, NULL, NULL);
+	root->SetAngM(glm::quat());
+	nodes.push_back(root);
+	for (int i = 0; i < bench_groups_g; i++) {
+		std::stringstream ss;
+		ss << "Group" << i;
+		SceneNode *group = new SceneNode(ss.str(), NULL, NULL, NULL);
+		group->SetPosition(glm::vec3(random.NextFloat(0.0f, bench_world_size_g), 0.0f, random.NextFloat(0.0f, bench_world_size_g)));
+		group->SetAngM(glm::angleAxis(0.01f, glm::vec3(0.0f, 1.0f, 0.0f)));
+		root->AddChild(group);
+		nodes.push_back(group);
+		for (int j = 1; j < bench_group_size_g; j++) {
+			std::stringstream part;
+			part << ss.str() << "Part" << j;
+			SceneNode *node = new SceneNode(part.str(), NULL, NULL, NULL);
+			node->SetPosition(glm::vec3(0.0f, (float) j, 0.0f));
+			node->SetScale(glm::vec3(2.0f));
+			node->SetAngM(glm::quat());
+			group->AddChild(node);
+			nodes.push_back(node);
+		}
+	}
+	return root;
+}
+
+
+static void BenchSceneGraph(void) {
+
+	std::vector<SceneNode *> nodes;
+	SceneGraph scene;
+	scene.SetRoot(BuildScene(nodes));
+	int count = (int) nodes.size();
+
+	// Lookups walk the tree depth first, last child first, until they
+	// find the node; the first part of the first group comes last
+	std::string name = "Group0Part1";
+	NameId id = StringInterner::Find(name);
+	Run("scene_graph/get_node_by_name", count, [&]() {
+		sink_g = sink_g + (float) scene.GetNode(name)->GetIndex();
+	});
+	Run("scene_graph/get_node_by_id", count, [&]() {
+		sink_g = sink_g + (float) scene.GetNode(id)->GetIndex();
+	});
+
+	Run("scene_graph/update", count, [&]() {
+		scene.Update();
+	});
+	JobSystem jobs;
+	Run("scene_graph/update_jobs", count, [&]() {
+		scene.Update(jobs);
+	});
+
+	// The traversal of SceneGraph::Draw and the transformations it
+	// composes, without the OpenGL calls
+	SceneNode::SetInterpolation(0.5f);
+	Run("scene_node/compose_transforms", count, [&]() {
+		std::stack<SceneNode *> stck;
+		std::stack<glm::mat4> transf;
+		stck.push(nodes[0]);
+		transf.push(glm::mat4(1.0f));
+		float sum = 0.0f;
+		while (!stck.empty()) {
+			SceneNode *current = stck.top();
+			stck.pop();
+			glm::mat4 parent_transf = transf.top();
+			transf.pop();
+			current->RefreshVisibility();
+			if (!current->GetVisible()) {
+				continue;
+			}
+			glm::mat4 local_transf;
+			glm::mat4 current_transf = current->ComposeTransform(parent_transf, local_transf);
+			sum += local_transf[3][0];
+			for (std::vector<SceneNode *>::const_iterator it = current->children_begin(); it != current->children_end(); ++it) {
+				stck.push(*it);
+				transf.push(current_transf);
+			}
+		}
+		sink_g = sink_g + sum;
+	});
+
+	for (size_t i = 0; i < nodes.size(); i++) {
+		delete nodes[i];
+	}
+}
+
+
+static void BenchResources(void) {
+
+	// Resources are only named without OpenGL
+	ResourceManager resman;
+	resman.SetHeadless(true);
+	std::vector<std::string> names;
+	for (int i = 0; i < bench_resources_g; i++) {
+		std::stringstream ss;
+		ss << "Resource" << i;
+		names.push_back(ss.str());
+		resman.AddResource(Mesh, ss.str(), (GLuint) 0, (GLuint) 0, i);
+	}
+	std::vector<NameId> ids;
+	for (size_t i = 0; i < names.size(); i++) {
+		ids.push_back(StringInterner::Find(names[i]));
+	}
+	Run("resource_manager/get_resource_by_name", bench_resources_g, [&]() {
+		int sum = 0;
+		for (size_t i = 0; i < names.size(); i++) {
+			sum += resman.GetResource(names[i])->GetSize();
+		}
+		sink_g = sink_g + (float) sum;
+	});
+	Run("resource_manager/get_resource_by_id", bench_resources_g, [&]() {
+		int sum = 0;
+		for (size_t i = 0; i < ids.size(); i++) {
+			sum += resman.GetResource(ids[i])->GetSize();
+		}
+		sink_g = sink_g + (float) sum;
+	});
+
+	// The largest model of the game
+	std::string filename = std::string(MATERIAL_DIRECTORY) + std::string("/tank2.obj");
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	ResourceManager::ParseMesh(filename.c_str(), vertices, indices);
+	Run("resource_manager/parse_mesh", (int) indices.size() / 3, [&]() {
+		ResourceManager::ParseMesh(filename.c_str(), vertices, indices);
+	});
+}
+
+
+// Buildings scattered over the world, as in the game
+static void MakeBoxes(Random &random, std::vector<AABB> &boxes) {
+
+	for (int i = 0; i < bench_boxes_g; i++) {
+		glm::vec3 center(random.NextFloat(0.0f, bench_world_size_g), 0.0f, random.NextFloat(0.0f, bench_world_size_g));
+		glm::vec3 half(random.NextFloat(2.0f, 12.0f), random.NextFloat(5.0f, 40.0f), random.NextFloat(2.0f, 12.0f));
+		boxes.push_back(AABB(center - half, center + half));
+	}
+}
+
+
+static void BenchCollisions(void) {
+
+	Random random(1, 1);
+	std::vector<AABB> boxes;
+	MakeBoxes(random, boxes);
+
+	// Segments of one tick of motion, mostly in the air
+	std::vector<glm::vec3> from;
+	std::vector<glm::vec3> to;
+	for (int i = 0; i < bench_segments_g; i++) {
+		glm::vec3 start(random.NextFloat(0.0f, bench_world_size_g), random.NextFloat(0.0f, 60.0f), random.NextFloat(0.0f, bench_world_size_g));
+		glm::vec3 direction = glm::normalize(glm::vec3(random.NextFloat(-1.0f, 1.0f), random.NextFloat(-0.2f, 0.2f), random.NextFloat(-1.0f, 1.0f)));
+		from.push_back(start);
+		to.push_back(start + direction * 5.0f);
+	}
+
+	// Every segment against every box, as the helicopter is tested
+	Run("aabb/sweep", bench_segments_g * bench_boxes_g, [&]() {
+		int hits = 0;
+		SweepHit hit;
+		for (int i = 0; i < bench_segments_g; i++) {
+			for (int b = 0; b < bench_boxes_g; b++) {
+				hits += boxes[b].Sweep(from[i], to[i], hit);
+			}
+		}
+		sink_g = sink_g + (float) hits;
+	});
+
+	StaticBVH bvh;
+	bvh.Build(boxes);
+	Run("static_bvh/build", bench_boxes_g, [&]() {
+		StaticBVH rebuilt;
+		rebuilt.Build(boxes);
+		sink_g = sink_g + (float) rebuilt.GetItemCount();
+	});
+	Run("static_bvh/intersect_segment", bench_segments_g, [&]() {
+		int hits = 0;
+		RayHit hit;
+		for (int i = 0; i < bench_segments_g; i++) {
+			hits += bvh.IntersectSegment(from[i], to[i], hit);
+		}
+		sink_g = sink_g + (float) hits;
+	});
+	Run("static_bvh/intersect_ray", bench_segments_g, [&]() {
+		int hits = 0;
+		RayHit hit;
+		for (int i = 0; i < bench_segments_g; i++) {
+			hits += bvh.IntersectRay(from[i], glm::normalize(to[i] - from[i]), 300.0f, hit);
+		}
+		sink_g = sink_g + (float) hits;
+	});
+
+	BoxSoA box_soa;
+	for (size_t i = 0; i < boxes.size(); i++) {
+		box_soa.Add(boxes[i]);
+	}
+	PointSoA points;
+	for (int i = 0; i < bench_points_g; i++) {
+		points.Add(glm::vec3(random.NextFloat(0.0f, bench_world_size_g), random.NextFloat(0.0f, 100.0f), random.NextFloat(0.0f, bench_world_size_g)));
+	}
+	std::vector<int> point_hits(bench_points_g);
+	Run("point_box_batch/find", bench_points_g, [&]() {
+		PointBoxBatch::FindContainingBoxes(points, box_soa, point_hits.data());
+		sink_g = sink_g + (float) point_hits[0];
+	});
+}
+
+
+static void BenchProjectiles(void) {
+
+	// Projectiles that stand still and never expire, so every call does
+	// the same work
+	Random random(1, 2);
+	ProjectileStore store;
+	for (int i = 0; i < bench_projectiles_g; i++) {
+		Projectile projectile = { (ProjectileType) (i % PROJECTILE_TYPE_COUNT), 0.0f, -1.0f,
+			glm::vec3(1.0f, 0.0f, 0.0f),
+			glm::vec3(random.NextFloat(0.0f, bench_world_size_g), random.NextFloat(0.0f, 100.0f), random.NextFloat(0.0f, bench_world_size_g)),
+			glm::quat(), 1.0f };
+		store.Add(projectile, 1e30f);
+	}
+	glm::vec3 world_min(0.0f, -1.0f, 0.0f);
+	glm::vec3 world_max(bench_world_size_g, 350.0f, bench_world_size_g);
+
+	Run("projectile_store/integrate", bench_projectiles_g, [&]() {
+		store.Integrate(world_min, world_max, 1.0f / 60.0f);
+	});
+
+	std::vector<float> instances;
+	int first[PROJECTILE_TYPE_COUNT];
+	int count[PROJECTILE_TYPE_COUNT];
+	Run("projectile_store/write_instances", bench_projectiles_g, [&]() {
+		store.WriteInstances(instances, first, count, 0.5f);
+		sink_g = sink_g + instances[0];
+	});
+
+	// A tenth of the projectiles die and as many are fired
+	int turnover = bench_projectiles_g / 10;
+	Projectile fired = { PLAYER_BULLET, 0.0f, -1.0f, glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(300.0f, 50.0f, 300.0f), glm::quat(), 1.0f };
+	Run("projectile_store/kill_compact_add", turnover, [&]() {
+		for (int i = 0; i < turnover; i++) {
+			store.Kill(i * 10);
+		}
+		store.Compact();
+		for (int i = 0; i < turnover; i++) {
+			store.Add(fired, 1e30f);
+		}
+	});
+}
+
+
+static void BenchWorld(void) {
+
+	// The whole world of the game, generated on the calling thread
+	int chunks = 0;
+	Run("world/generate", 1, [&]() {
+		ChunkStreamer streamer;
+		streamer.SetSeed(1);
+		streamer.SetWorld(glm::vec2(0.0f), glm::vec2(bench_world_size_g));
+		streamer.SetRadius(2.0f * bench_world_size_g);
+		streamer.SetLoaderCount(0);
+		std::vector<WorldChunk *> attached;
+		std::vector<WorldChunk *> detached;
+		streamer.Update(glm::vec3(bench_world_size_g / 2.0f, 0.0f, bench_world_size_g / 2.0f), attached, detached);
+		chunks = (int) attached.size();
+	});
+	sink_g = sink_g + (float) chunks;
+}
+
+
+int main(int argc, char *argv[]) {
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+			options_g.filter = argv[++i];
+		} else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+			options_g.min_time = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--repeats") == 0 && i + 1 < argc) {
+			options_g.repeats = std::max(atoi(argv[++i]), 1);
+		} else {
+			std::cerr << "Unknown option " << argv[i] << std::endl;
+			return 1;
+		}
+	}
+
+	try {
+		BenchSceneGraph();
+		BenchResources();
+		BenchCollisions();
+		BenchProjectiles();
+		BenchWorld();
+	}
+	catch (std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
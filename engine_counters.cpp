@@ -0,0 +1,280 @@
+#include <new>
+#include <cstdlib>
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+#include "engine_counters.h"
+
+// Every allocation of the process passes through here. The counter is
+// constant-initialized, so allocations made before main are counted too
+static std::atomic<unsigned long long> allocations_g(0);
+
+void *operator new(std::size_t size) {
+
+	allocations_g.fetch_add(1, std::memory_order_relaxed);
+	void *memory = malloc(size ? size : 1);
+	if (!memory) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void *operator new[](std::size_t size) {
+
+	return operator new(size);
+}
+
+void operator delete(void *memory) noexcept {
+
+	free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+
+	free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+
+	free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+
+	free(memory);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+
+	allocations_g.fetch_add(1, std::memory_order_relaxed);
+	return malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept {
+
+	return operator new(size, tag);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept {
+
+	free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {
+
+	free(memory);
+}
+
+#ifdef __cpp_aligned_new
+
+// Over-aligned types, such as ones declared alignas(32). The memory
+// comes from a different allocator, so it has deletes of its own
+static void *AllocateAligned(std::size_t size, std::align_val_t alignment) {
+
+	allocations_g.fetch_add(1, std::memory_order_relaxed);
+	std::size_t bytes = size ? size : 1;
+	std::size_t align = (std::size_t) alignment;
+#if defined(_MSC_VER)
+	return _aligned_malloc(bytes, align);
+#else
+	void *memory = NULL;
+	if (posix_memalign(&memory, align < sizeof(void *) ? sizeof(void *) : align, bytes) != 0) {
+		return NULL;
+	}
+	return memory;
+#endif
+}
+
+static void FreeAligned(void *memory) {
+
+#if defined(_MSC_VER)
+	_aligned_free(memory);
+#else
+	free(memory);
+#endif
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+
+	void *memory = AllocateAligned(size, alignment);
+	if (!memory) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+
+	return operator new(size, alignment);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+
+	return AllocateAligned(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+
+	return AllocateAligned(size, alignment);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+
+	FreeAligned(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept {
+
+	FreeAligned(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept {
+
+	FreeAligned(memory);
+}
+
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept {
+
+	FreeAligned(memory);
+}
+
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+
+	FreeAligned(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+
+	FreeAligned(memory);
+}
+
+#endif
+
+
+namespace game {
+
+	const char *counter_names_g[COUNTER_COUNT] = {
+		"nodes_traversed",
+		"nodes_drawn",
+		"draw_calls",
+		"program_binds",
+		"texture_binds",
+		"buffer_binds",
+		"uniform_uploads",
+		"collision_pairs",
+		"projectiles",
+		"allocations"
+	};
+
+	std::atomic<long long> EngineCounters::current_[COUNTER_COUNT];
+	long long EngineCounters::last_[COUNTER_COUNT];
+	unsigned long long EngineCounters::frame_allocations_ = 0;
+	long long EngineCounters::frames_ = 0;
+	std::ofstream EngineCounters::csv_;
+
+
+	void EngineCounters::Add(Counter counter, long long amount) {
+
+		current_[counter].fetch_add(amount, std::memory_order_relaxed);
+	}
+
+
+	void EngineCounters::Set(Counter counter, long long value) {
+
+		current_[counter].store(value, std::memory_order_relaxed);
+	}
+
+
+	long long EngineCounters::Get(Counter counter) {
+
+		if (counter == COUNTER_ALLOCATIONS) {
+			return (long long) (GetAllocationTotal() - frame_allocations_);
+		}
+		return current_[counter].load(std::memory_order_relaxed);
+	}
+
+
+	long long EngineCounters::GetLast(Counter counter) {
+
+		return last_[counter];
+	}
+
+
+	const char *EngineCounters::GetName(Counter counter) {
+
+		return counter_names_g[counter];
+	}
+
+
+	void EngineCounters::EndFrame(void) {
+
+		unsigned long long allocations = GetAllocationTotal();
+		for (int i = 0; i < COUNTER_COUNT; i++) {
+			Counter counter = (Counter) i;
+			if (counter == COUNTER_ALLOCATIONS) {
+				last_[i] = (long long) (allocations - frame_allocations_);
+			} else if (counter == COUNTER_PROJECTILES) {
+				last_[i] = current_[i].load(std::memory_order_relaxed);
+			} else {
+				last_[i] = current_[i].exchange(0, std::memory_order_relaxed);
+			}
+		}
+		frame_allocations_ = allocations;
+
+		if (csv_.is_open()) {
+			csv_ << frames_;
+			for (int i = 0; i < COUNTER_COUNT; i++) {
+				csv_ << ',' << last_[i];
+			}
+			csv_ << '\n';
+		}
+		frames_++;
+	}
+
+
+	void EngineCounters::Reset(void) {
+
+		for (int i = 0; i < COUNTER_COUNT; i++) {
+			current_[i].store(0, std::memory_order_relaxed);
+		}
+		frame_allocations_ = GetAllocationTotal();
+	}
+
+
+	long long EngineCounters::GetFrameCount(void) {
+
+		return frames_;
+	}
+
+
+	unsigned long long EngineCounters::GetAllocationTotal(void) {
+
+		return allocations_g.load(std::memory_order_relaxed);
+	}
+
+
+	bool EngineCounters::OpenCsv(const std::string &path) {
+
+		CloseCsv();
+		csv_.open(path.c_str(), std::ios::trunc);
+		if (!csv_) {
+			return false;
+		}
+		csv_ << "frame";
+		for (int i = 0; i < COUNTER_COUNT; i++) {
+			csv_ << ',' << counter_names_g[i];
+		}
+		csv_ << '\n';
+		return (bool) csv_;
+	}
+
+
+	void EngineCounters::CloseCsv(void) {
+
+		if (csv_.is_open()) {
+			csv_.close();
+		}
+	}
+
+} // namespace game
@@ -0,0 +1,70 @@
+#ifndef ENGINE_COUNTERS_H_
+#define ENGINE_COUNTERS_H_
+
+#include <string>
+#include <fstream>
+#include <atomic>
+
+namespace game {
+
+	// What the engine counts in every frame
+	enum Counter {
+		COUNTER_NODES_TRAVERSED = 0, // Visited by scene graph updates and draws
+		COUNTER_NODES_DRAWN,
+		COUNTER_DRAW_CALLS,
+		COUNTER_PROGRAM_BINDS,
+		COUNTER_TEXTURE_BINDS,
+		COUNTER_BUFFER_BINDS,
+		COUNTER_UNIFORM_UPLOADS,
+		COUNTER_COLLISION_PAIRS, // Candidates handed to a narrow test
+		COUNTER_PROJECTILES, // Alive; a level, kept from frame to frame
+		COUNTER_ALLOCATIONS, // Calls to operator new, on any thread
+		COUNTER_COUNT
+	};
+
+	// Counts of the work done in each frame
+	//
+	// Code doing counted work adds to these from any thread. Adds are
+	// relaxed atomics, so loops should add their total once rather than
+	// once per item. EndFrame keeps the values of the frame that ended for
+	// display, writes them to the CSV file if one is open, and starts the
+	// next frame from zero. Allocations are counted by the replacements of
+	// every form of operator new in engine_counters.cpp, nothrow and
+	// aligned ones included
+	class EngineCounters {
+
+	public:
+		static void Add(Counter counter, long long amount = 1);
+		static void Set(Counter counter, long long value);
+		// Value so far in the current frame
+		static long long Get(Counter counter);
+		// Value of the last frame that ended
+		static long long GetLast(Counter counter);
+		// Lower-case name with underscores, as in the CSV header
+		static const char *GetName(Counter counter);
+
+		static void EndFrame(void);
+		// Drop what was counted since the last frame, such as loading
+		static void Reset(void);
+		static long long GetFrameCount(void);
+
+		// Allocations since the process started
+		static unsigned long long GetAllocationTotal(void);
+
+		// Write a header, then one row per frame, to 'path'. Returns
+		// false if the file cannot be created
+		static bool OpenCsv(const std::string &path);
+		static void CloseCsv(void);
+
+	private:
+		static std::atomic<long long> current_[COUNTER_COUNT];
+		static long long last_[COUNTER_COUNT];
+		static unsigned long long frame_allocations_; // Total when the frame started
+		static long long frames_;
+		static std::ofstream csv_;
+
+	}; // class EngineCounters
+
+} // namespace game
+
+#endif // ENGINE_COUNTERS_H_
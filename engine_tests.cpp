@@ -0,0 +1,578 @@
+// Tests of the engine building blocks, run by CTest
+//
+// Each test checks one structure against a plain reference, usually a
+// brute force loop over random data with a fixed seed, and prints every
+// failed check. The exit code is the number of failed tests, so CTest
+// sees any failure. Nothing here needs an OpenGL context.
+//
+// Options:
+//   --filter TEXT    only run the tests whose name contains TEXT
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+#include "job_system.h"
+#include "proximity_grid.h"
+#include "aabb.h"
+#include "static_bvh.h"
+#include "occupancy_grid.h"
+#include "input_recording.h"
+#include "world_snapshot.h"
+#include "random.h"
+
+using namespace game;
+
+// Files written by the tests, in the directory CTest runs them from
+const char *recording_path_g = "engine_tests.rec";
+const char *snapshot_path_g = "engine_tests.snapshot";
+
+const float epsilon_g = 1e-4f;
+
+// Failed checks of the test running
+static int failures_g;
+
+#define CHECK(condition) Check((condition), #condition, __FILE__, __LINE__)
+
+
+static void Check(bool passed, const char *condition, const char *file, int line) {
+
+	if (!passed) {
+		std::cerr << file << ":" << line << ": failed " << condition << std::endl;
+		failures_g++;
+	}
+}
+
+
+static bool Near(glm::vec3 a, glm::vec3 b) {
+
+	glm::vec3 offset = glm::abs(a - b);
+	return offset.x <= epsilon_g && offset.y <= epsilon_g && offset.z <= epsilon_g;
+}
+
+
+// Box of random position and size within 'world'
+static AABB RandomBox(Random &random, float world, float size) {
+
+	glm::vec3 min(random.NextFloat(0.0f, world), random.NextFloat(0.0f, size), random.NextFloat(0.0f, world));
+	glm::vec3 extent(random.NextFloat(1.0f, size), random.NextFloat(1.0f, size), random.NextFloat(1.0f, size));
+	return AABB(min, min + extent);
+}
+
+
+static glm::vec3 RandomPoint(Random &random, float world, float height) {
+
+	return glm::vec3(random.NextFloat(0.0f, world), random.NextFloat(0.0f, height), random.NextFloat(0.0f, world));
+}
+
+
+static void TestTaskGraph(void) {
+
+	JobSystem jobs(3);
+
+	// Diamond, then a chain hanging from its end, run many times over so
+	// the workers interleave differently
+	for (int run = 0; run < 200; run++) {
+		std::atomic<int> clock(0);
+		std::vector<int> finished(8, -1);
+		TaskGraph graph;
+		std::vector<TaskGraph::TaskId> tasks;
+		for (int i = 0; i < 8; i++) {
+			tasks.push_back(graph.Add([&clock, &finished, i]() { finished[i] = clock++; }));
+		}
+		graph.Precede(tasks[0], tasks[1]);
+		graph.Precede(tasks[0], tasks[2]);
+		graph.Precede(tasks[1], tasks[3]);
+		graph.Precede(tasks[2], tasks[3]);
+		for (int i = 3; i < 7; i++) {
+			graph.Precede(tasks[i], tasks[i + 1]);
+		}
+		jobs.Run(graph);
+
+		CHECK(clock == 8);
+		CHECK(finished[0] < finished[1] && finished[0] < finished[2]);
+		CHECK(finished[1] < finished[3] && finished[2] < finished[3]);
+		for (int i = 3; i < 7; i++) {
+			CHECK(finished[i] < finished[i + 1]);
+		}
+	}
+
+	// Every index is visited once, in ranges no longer than the grain
+	std::vector<std::atomic<int> > visits(1000);
+	for (size_t i = 0; i < visits.size(); i++) {
+		visits[i] = 0;
+	}
+	std::atomic<bool> short_ranges(true);
+	jobs.ParallelFor((int) visits.size(), 7, [&](int begin, int end) {
+		if (end - begin > 7 || end <= begin) {
+			short_ranges = false;
+		}
+		for (int i = begin; i < end; i++) {
+			visits[i]++;
+		}
+	});
+	CHECK(short_ranges);
+	for (size_t i = 0; i < visits.size(); i++) {
+		CHECK(visits[i] == 1);
+	}
+}
+
+
+static void TestProximityGrid(void) {
+
+	const int entities = 300;
+	const float world = 200.0f;
+
+	Random random(7, 0);
+	ProximityGrid grid;
+	grid.Reset(10.0f);
+	std::vector<glm::vec3> positions(entities);
+	std::vector<bool> present(entities, false);
+	std::vector<uint32_t> generations(entities, 0);
+
+	// Random inserts, moves within and across cells, removals and index
+	// reuse, checked against a brute force query after each round
+	for (int round = 0; round < 50; round++) {
+		for (int step = 0; step < 200; step++) {
+			int i = random.NextInt(entities);
+			EntityId entity = MakeEntityId(i, generations[i]);
+			int op = random.NextInt(4);
+			if (op == 0) {
+				positions[i] = glm::vec3(random.NextFloat(-world, world), 0.0f, random.NextFloat(-world, world));
+				grid.Insert(entity, positions[i]);
+				present[i] = true;
+			} else if (op == 1 && present[i]) {
+				positions[i] += glm::vec3(random.NextFloat(-15.0f, 15.0f), 0.0f, random.NextFloat(-15.0f, 15.0f));
+				grid.Move(entity, positions[i]);
+			} else if (op == 2) {
+				grid.Remove(entity);
+				present[i] = false;
+			} else if (present[i]) {
+				// The entity dies without leaving the grid, and a new one
+				// takes its index
+				generations[i]++;
+				EntityId reused = MakeEntityId(i, generations[i]);
+				CHECK(!grid.Has(reused));
+				positions[i] = glm::vec3(random.NextFloat(-world, world), 0.0f, random.NextFloat(-world, world));
+				grid.Insert(reused, positions[i]);
+				CHECK(!grid.Has(entity));
+			}
+		}
+
+		int count = 0;
+		for (int i = 0; i < entities; i++) {
+			count += present[i] ? 1 : 0;
+			CHECK(grid.Has(MakeEntityId(i, generations[i])) == present[i]);
+		}
+		CHECK(grid.Size() == count);
+
+		glm::vec3 center(random.NextFloat(-world, world), 0.0f, random.NextFloat(-world, world));
+		float radius = random.NextFloat(0.0f, round % 10 == 0 ? 4.0f * world : 40.0f);
+		std::vector<EntityId> found;
+		grid.Query(center, radius, found);
+		std::vector<EntityId> expected;
+		for (int i = 0; i < entities; i++) {
+			glm::vec3 offset = positions[i] - center;
+			if (present[i] && glm::dot(offset, offset) <= radius * radius) {
+				expected.push_back(MakeEntityId(i, generations[i]));
+			}
+		}
+		std::sort(found.begin(), found.end());
+		std::sort(expected.begin(), expected.end());
+		CHECK(found == expected);
+	}
+
+	// Removing everything leaves nothing to find
+	for (int i = 0; i < entities; i++) {
+		grid.Remove(MakeEntityId(i, generations[i]));
+	}
+	std::vector<EntityId> found;
+	grid.Query(glm::vec3(0.0f), 4.0f * world, found);
+	CHECK(grid.Size() == 0);
+	CHECK(found.empty());
+}
+
+
+static void TestStaticBVH(void) {
+
+	const float world = 500.0f;
+
+	Random random(11, 0);
+	std::vector<AABB> boxes;
+	for (int i = 0; i < 400; i++) {
+		boxes.push_back(RandomBox(random, world, 30.0f));
+	}
+	StaticBVH bvh;
+	bvh.Build(boxes);
+	CHECK(bvh.GetItemCount() == (int) boxes.size());
+
+	for (int query = 0; query < 500; query++) {
+
+		// Points: the item found contains the point, and none is found
+		// only when no box does
+		glm::vec3 point = RandomPoint(random, world, 30.0f);
+		int item = bvh.FindPoint(point);
+		bool contained = false;
+		for (size_t i = 0; i < boxes.size(); i++) {
+			contained = contained || boxes[i].Contains(point);
+		}
+		CHECK(item < 0 ? !contained : boxes[item].Contains(point));
+
+		// Segments: the nearest crossing, by its parameter, since boxes
+		// may tie
+		glm::vec3 a = RandomPoint(random, world, 40.0f);
+		glm::vec3 b = a + glm::vec3(random.NextFloat(-80.0f, 80.0f), random.NextFloat(-20.0f, 20.0f), random.NextFloat(-80.0f, 80.0f));
+		glm::vec3 inv_dir = AABB::InverseDirection(b - a);
+		float nearest = 2.0f;
+		for (size_t i = 0; i < boxes.size(); i++) {
+			float t;
+			if (boxes[i].IntersectRay(a, inv_dir, 1.0f, t) && t < nearest) {
+				nearest = t;
+			}
+		}
+		RayHit hit;
+		bool crossed = bvh.IntersectSegment(a, b, hit);
+		CHECK(crossed == (nearest <= 1.0f));
+		if (crossed) {
+			CHECK(std::abs(hit.t - nearest) < epsilon_g);
+		}
+
+		// Spheres: exactly the overlapping boxes
+		float radius = random.NextFloat(0.0f, 50.0f);
+		std::vector<int> items;
+		bvh.QuerySphere(point, radius, items);
+		std::vector<int> expected;
+		for (size_t i = 0; i < boxes.size(); i++) {
+			if (boxes[i].OverlapsSphere(point, radius)) {
+				expected.push_back((int) i);
+			}
+		}
+		std::sort(items.begin(), items.end());
+		CHECK(items == expected);
+	}
+
+	// An empty tree finds nothing
+	StaticBVH empty;
+	empty.Build(std::vector<AABB>());
+	RayHit hit;
+	CHECK(empty.FindPoint(glm::vec3(0.0f)) < 0);
+	CHECK(!empty.IntersectSegment(glm::vec3(-1.0f), glm::vec3(1.0f), hit));
+}
+
+
+static void TestSweep(void) {
+
+	AABB box(glm::vec3(0.0f), glm::vec3(2.0f));
+	SweepHit hit;
+
+	// Entering through a face
+	CHECK(box.Sweep(glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(1.0f, 1.0f, 1.0f), hit));
+	CHECK(std::abs(hit.t - 0.5f) < epsilon_g);
+	CHECK(hit.normal == glm::vec3(-1.0f, 0.0f, 0.0f));
+	CHECK(Near(hit.point, glm::vec3(0.0f, 1.0f, 1.0f)));
+
+	CHECK(box.Sweep(glm::vec3(1.0f, 5.0f, 1.0f), glm::vec3(1.0f, 1.0f, 1.0f), hit));
+	CHECK(std::abs(hit.t - 0.75f) < epsilon_g);
+	CHECK(hit.normal == glm::vec3(0.0f, 1.0f, 0.0f));
+	CHECK(Near(hit.point, glm::vec3(1.0f, 2.0f, 1.0f)));
+
+	// Starting inside pushes out through the closest face, at t = 0,
+	// whether moving or not
+	CHECK(box.Sweep(glm::vec3(1.0f, 1.0f, 0.2f), glm::vec3(1.5f, 1.0f, 0.2f), hit));
+	CHECK(hit.t == 0.0f);
+	CHECK(hit.normal == glm::vec3(0.0f, 0.0f, -1.0f));
+	CHECK(Near(hit.point, glm::vec3(1.0f, 1.0f, 0.0f)));
+
+	CHECK(box.Sweep(glm::vec3(1.0f, 1.9f, 1.0f), glm::vec3(1.0f, 1.9f, 1.0f), hit));
+	CHECK(hit.t == 0.0f);
+	CHECK(hit.normal == glm::vec3(0.0f, 1.0f, 0.0f));
+	CHECK(Near(hit.point, glm::vec3(1.0f, 2.0f, 1.0f)));
+
+	// Crossing an edge reports one of the two faces at the same time
+	CHECK(box.Sweep(glm::vec3(-1.0f, -1.0f, 1.0f), glm::vec3(1.0f, 1.0f, 1.0f), hit));
+	CHECK(std::abs(hit.t - 0.5f) < epsilon_g);
+	CHECK(hit.normal == glm::vec3(-1.0f, 0.0f, 0.0f) || hit.normal == glm::vec3(0.0f, -1.0f, 0.0f));
+
+	// Ending exactly on a face still touches it
+	CHECK(box.Sweep(glm::vec3(-1.0f, 1.0f, 1.0f), glm::vec3(0.0f, 1.0f, 1.0f), hit));
+	CHECK(std::abs(hit.t - 1.0f) < epsilon_g);
+
+	// Misses: parallel outside, stopping short, moving away, and passing
+	// beside the box
+	CHECK(!box.Sweep(glm::vec3(-1.0f, 3.0f, 1.0f), glm::vec3(3.0f, 3.0f, 1.0f), hit));
+	CHECK(!box.Sweep(glm::vec3(-2.0f, 1.0f, 1.0f), glm::vec3(-1.0f, 1.0f, 1.0f), hit));
+	CHECK(!box.Sweep(glm::vec3(3.0f, 1.0f, 1.0f), glm::vec3(4.0f, 1.0f, 1.0f), hit));
+	CHECK(!box.Sweep(glm::vec3(-1.0f, 1.0f, 3.0f), glm::vec3(3.0f, 1.0f, 2.5f), hit));
+	CHECK(!box.Sweep(glm::vec3(5.0f), glm::vec3(5.0f), hit));
+}
+
+
+static void TestOccupancyGrid(void) {
+
+	// Wide enough for rows of several words, with a partial last word
+	const int width = 200;
+	const int height = 40;
+
+	OccupancyGrid grid;
+	grid.Reset(width, height);
+	CHECK(grid.GetWidth() == width && grid.GetHeight() == height);
+
+	// Rectangles ending on, starting on and spanning word boundaries
+	grid.Fill(0, 0, 64, 1);
+	CHECK(grid.Get(63, 0) && !grid.Get(64, 0));
+	grid.Fill(64, 1, 128, 2);
+	CHECK(!grid.Get(63, 1) && grid.Get(64, 1) && grid.Get(127, 1) && !grid.Get(128, 1));
+	grid.Fill(60, 2, 70, 3);
+	CHECK(!grid.Get(59, 2) && grid.Get(60, 2) && grid.Get(69, 2) && !grid.Get(70, 2));
+	CHECK(grid.Test(69, 2, 71, 3) && !grid.Test(70, 2, 80, 3) && !grid.Test(60, 3, 70, 4));
+	grid.Fill(190, 3, width, 4);
+	CHECK(grid.Get(width - 1, 3) && grid.Test(199, 3, 500, 4));
+
+	// Parts outside the grid are clipped away
+	grid.Fill(-5, -5, 2, 2);
+	CHECK(grid.Get(0, 0) && grid.Get(1, 1) && !grid.Get(2, 1));
+	CHECK(!grid.Test(-10, 0, 0, height) && !grid.Test(width, 0, width + 10, height));
+	CHECK(!grid.Test(5, 5, 5, 10));
+
+	// Random rectangles against a plain array of cells
+	Random random(13, 0);
+	grid.Reset(width, height);
+	std::vector<bool> cells(width * height, false);
+	for (int i = 0; i < 400; i++) {
+		int x0 = random.NextInt(width + 20) - 10;
+		int z0 = random.NextInt(height + 4) - 2;
+		int x1 = x0 + random.NextInt(90);
+		int z1 = z0 + random.NextInt(4);
+		bool expected = false;
+		for (int z = std::max(z0, 0); z < std::min(z1, height); z++) {
+			for (int x = std::max(x0, 0); x < std::min(x1, width); x++) {
+				expected = expected || cells[z * width + x];
+			}
+		}
+		CHECK(grid.Test(x0, z0, x1, z1) == expected);
+		if (random.NextInt(3) == 0) {
+			grid.Fill(x0, z0, x1, z1);
+			for (int z = std::max(z0, 0); z < std::min(z1, height); z++) {
+				for (int x = std::max(x0, 0); x < std::min(x1, width); x++) {
+					cells[z * width + x] = true;
+				}
+			}
+		}
+	}
+	for (int z = 0; z < height; z++) {
+		for (int x = 0; x < width; x++) {
+			CHECK(grid.Get(x, z) == cells[z * width + x]);
+		}
+	}
+}
+
+
+static void TestInputReplay(void) {
+
+	RecordingSettings settings = { 1234, 900, 25, 60.0 };
+
+	// Held inputs with changes at random ticks, including the first
+	Random random(17, 0);
+	std::vector<TickInput> inputs;
+	TickInput input = { 0, glm::vec2(0.0f) };
+	for (int tick = 0; tick < 1000; tick++) {
+		if (random.NextInt(20) == 0) {
+			input.buttons = random.Next() & ((1u << INPUT_BUTTON_COUNT) - 1);
+			input.mouse = glm::vec2(random.NextFloat(-300.0f, 300.0f), random.NextFloat(-200.0f, 200.0f));
+		}
+		inputs.push_back(input);
+	}
+
+	InputRecorder recorder;
+	CHECK(recorder.Open(recording_path_g, settings));
+	for (size_t i = 0; i < inputs.size(); i++) {
+		recorder.Record(inputs[i]);
+	}
+	CHECK(recorder.Close());
+
+	ReplayInput replay;
+	CHECK(replay.Load(recording_path_g));
+	const RecordingSettings &loaded = replay.GetSettings();
+	CHECK(loaded.seed == settings.seed && loaded.world_size == settings.world_size);
+	CHECK(loaded.extra_enemies == settings.extra_enemies && loaded.tick_rate == settings.tick_rate);
+	CHECK(replay.GetTickCount() == inputs.size());
+
+	// Played twice, the second time after a rewind
+	for (int pass = 0; pass < 2; pass++) {
+		size_t matched = 0;
+		TickInput played;
+		for (size_t i = 0; i < inputs.size() && replay.Next(played); i++) {
+			if (played.buttons == inputs[i].buttons && played.mouse == inputs[i].mouse) {
+				matched++;
+			}
+		}
+		CHECK(matched == inputs.size());
+		CHECK(!replay.Next(played));
+		replay.Rewind();
+	}
+
+	std::remove(recording_path_g);
+	CHECK(!replay.Load(recording_path_g));
+}
+
+
+// Chunk of a few random lots, filled like the city generator does
+static WorldChunk *MakeChunk(Random &random, int column, int row) {
+
+	WorldChunk *chunk = new WorldChunk();
+	chunk->column = column;
+	chunk->row = row;
+	int lots = 1 + random.NextInt(6);
+	for (int i = 0; i < lots; i++) {
+		BuildingLot lot = { glm::vec2(random.NextFloat(0.0f, 100.0f), random.NextFloat(0.0f, 100.0f)),
+			glm::vec3(random.NextFloat(2.0f, 10.0f), random.NextFloat(5.0f, 40.0f), random.NextFloat(2.0f, 10.0f)) };
+		chunk->lots.push_back(lot);
+		AABB box = RandomBox(random, 100.0f, 20.0f);
+		chunk->boxes.push_back(box);
+		for (int corner = 0; corner < 8; corner++) {
+			chunk->corners.push_back(RandomPoint(random, 100.0f, 40.0f));
+		}
+	}
+	chunk->boxes.push_back(RandomBox(random, 100.0f, 2.0f));
+	return chunk;
+}
+
+
+static void TestWorldSnapshot(void) {
+
+	WorldSnapshotKey key = { 99, 600, 150.0f, 12.0f };
+
+	Random random(19, 0);
+	std::vector<WorldChunk *> chunks;
+	chunks.push_back(MakeChunk(random, 2, 1));
+	chunks.push_back(MakeChunk(random, -1, 3));
+	chunks.push_back(MakeChunk(random, 2, -4));
+
+	std::vector<HostagePlacement> hostages(3);
+	for (size_t i = 0; i < hostages.size(); i++) {
+		hostages[i].location = (int) i * 5;
+		for (int j = 0; j < 4; j++) {
+			hostages[i].captors[j] = RandomPoint(random, 100.0f, 40.0f);
+		}
+		hostages[i].hostage = RandomPoint(random, 100.0f, 40.0f);
+	}
+	Random spawn_random(23, 1);
+	spawn_random.Next();
+
+	CHECK(WorldSnapshot::Write(snapshot_path_g, key, chunks, hostages, spawn_random));
+
+	WorldSnapshot snapshot;
+	CHECK(snapshot.Load(snapshot_path_g, key));
+	CHECK(snapshot.IsLoaded());
+
+	for (size_t i = 0; i < chunks.size(); i++) {
+		WorldChunk loaded;
+		loaded.column = chunks[i]->column;
+		loaded.row = chunks[i]->row;
+		CHECK(snapshot.GetChunk(loaded));
+		CHECK(loaded.lots.size() == chunks[i]->lots.size());
+		for (size_t j = 0; j < loaded.lots.size() && j < chunks[i]->lots.size(); j++) {
+			CHECK(loaded.lots[j].center == chunks[i]->lots[j].center && loaded.lots[j].size == chunks[i]->lots[j].size);
+		}
+		CHECK(loaded.boxes.size() == chunks[i]->boxes.size());
+		for (size_t j = 0; j < loaded.boxes.size() && j < chunks[i]->boxes.size(); j++) {
+			CHECK(loaded.boxes[j].min == chunks[i]->boxes[j].min && loaded.boxes[j].max == chunks[i]->boxes[j].max);
+		}
+		CHECK(loaded.corners == chunks[i]->corners);
+	}
+	WorldChunk missing;
+	missing.column = 2;
+	missing.row = 0;
+	CHECK(!snapshot.GetChunk(missing));
+
+	std::vector<HostagePlacement> loaded_hostages;
+	snapshot.GetHostages(loaded_hostages);
+	CHECK(loaded_hostages.size() == hostages.size());
+	for (size_t i = 0; i < loaded_hostages.size() && i < hostages.size(); i++) {
+		CHECK(loaded_hostages[i].location == hostages[i].location && loaded_hostages[i].hostage == hostages[i].hostage);
+		CHECK(std::equal(hostages[i].captors, hostages[i].captors + 4, loaded_hostages[i].captors));
+	}
+
+	// The spawn generator resumes where it was saved
+	Random resumed;
+	snapshot.GetSpawnState(resumed);
+	for (int i = 0; i < 10; i++) {
+		CHECK(resumed.Next() == spawn_random.Next());
+	}
+	snapshot.Close();
+	CHECK(!snapshot.IsLoaded());
+
+	// Any other key is refused
+	WorldSnapshotKey other = key;
+	other.seed++;
+	CHECK(!snapshot.Load(snapshot_path_g, other));
+	other = key;
+	other.spacing = 10.0f;
+	CHECK(!snapshot.Load(snapshot_path_g, other));
+	CHECK(!snapshot.IsLoaded());
+
+	std::remove(snapshot_path_g);
+	CHECK(!snapshot.Load(snapshot_path_g, key));
+	for (size_t i = 0; i < chunks.size(); i++) {
+		delete chunks[i];
+	}
+}
+
+
+struct EngineTest {
+	const char *name;
+	void (*run)(void);
+};
+
+const EngineTest tests_g[] = {
+	{ "task_graph", TestTaskGraph },
+	{ "proximity_grid", TestProximityGrid },
+	{ "static_bvh", TestStaticBVH },
+	{ "aabb_sweep", TestSweep },
+	{ "occupancy_grid", TestOccupancyGrid },
+	{ "input_replay", TestInputReplay },
+	{ "world_snapshot", TestWorldSnapshot }
+};
+
+
+int main(int argc, char *argv[]) {
+
+	std::string filter;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+			filter = argv[++i];
+		} else {
+			std::cerr << "Unknown option " << argv[i] << std::endl;
+			return 1;
+		}
+	}
+
+	int failed = 0;
+	int run = 0;
+	for (size_t i = 0; i < sizeof(tests_g) / sizeof(tests_g[0]); i++) {
+		if (std::string(tests_g[i].name).find(filter) == std::string::npos) {
+			continue;
+		}
+		failures_g = 0;
+		try {
+			tests_g[i].run();
+		}
+		catch (std::exception &e) {
+			std::cerr << tests_g[i].name << ": " << e.what() << std::endl;
+			failures_g++;
+		}
+		std::cout << (failures_g == 0 ? "PASS " : "FAIL ") << tests_g[i].name << std::endl;
+		failed += (failures_g == 0) ? 0 : 1;
+		run++;
+	}
+	if (run == 0) {
+		std::cerr << "No test matches " << filter << std::endl;
+		return 1;
+	}
+	return failed;
+}
@@ -0,0 +1,284 @@
+#include <stdexcept>
+
+#include "entity_registry.h"
+#include "scene_node.h"
+#include "helicopter.h"
+
+namespace game {
+
+	// Set on entities that were destroyed but not collected yet
+	const unsigned int destroyed_tag_g = 1u << 31;
+
+	EntityRegistry::EntityRegistry(void) {
+	}
+
+
+	EntityRegistry::~EntityRegistry() {
+	}
+
+
+	EntityId EntityRegistry::AddRenderable(SceneNode *node) {
+
+		EntityId entity = GetEntity(node);
+		Renderable renderable = { node };
+		renderables_.Add(entity, renderable);
+		SetTag(entity, RENDERABLE_TAG);
+		return entity;
+	}
+
+
+	void EntityRegistry::AddTransform(EntityId entity, const Transform &transform) {
+
+		transforms_.Add(entity, transform);
+		SetTag(entity, TRANSFORM_TAG);
+	}
+
+
+	void EntityRegistry::AddHealth(EntityId entity, const Health &health) {
+
+		healths_.Add(entity, health);
+		SetTag(entity, HEALTH_TAG);
+	}
+
+
+	void EntityRegistry::AddTurret(EntityId entity, const Turret &turret) {
+
+		turrets_.Add(entity, turret);
+		SetTag(entity, TURRET_TAG);
+	}
+
+
+	void EntityRegistry::AddFlyer(EntityId entity, const Flyer &flyer) {
+
+		flyers_.Add(entity, flyer);
+		SetTag(entity, FLYER_TAG);
+	}
+
+
+	void EntityRegistry::AddDamageable(EntityId entity, const Damageable &damageable) {
+
+		damageables_.Add(entity, damageable);
+		SetTag(entity, DAMAGEABLE_TAG);
+	}
+
+
+	void EntityRegistry::AddHostage(const Hostage &hostage) {
+
+		EntityId entity = GetEntity(hostage.node);
+		hostages_.Add(entity, hostage);
+		SetTag(entity, HOSTAGE_TAG);
+	}
+
+
+	void EntityRegistry::AddHostageFollow(EntityId entity, const HostageFollow &follow) {
+
+		follows_.Add(entity, follow);
+		SetTag(entity, HOSTAGE_FOLLOW_TAG);
+	}
+
+
+	void EntityRegistry::AddExplosion(const Explosion &explosion) {
+
+		EntityId entity = GetEntity(explosion.node);
+		explosions_.Add(entity, explosion);
+		SetTag(entity, EXPLOSION_TAG);
+	}
+
+
+	ComponentArray<Transform> &EntityRegistry::GetTransforms(void) {
+
+		return transforms_;
+	}
+
+
+	ComponentArray<Renderable> &EntityRegistry::GetRenderables(void) {
+
+		return renderables_;
+	}
+
+
+	ComponentArray<Health> &EntityRegistry::GetHealths(void) {
+
+		return healths_;
+	}
+
+
+	ComponentArray<Turret> &EntityRegistry::GetTurrets(void) {
+
+		return turrets_;
+	}
+
+
+	ComponentArray<Flyer> &EntityRegistry::GetFlyers(void) {
+
+		return flyers_;
+	}
+
+
+	ComponentArray<Damageable> &EntityRegistry::GetDamageables(void) {
+
+		return damageables_;
+	}
+
+
+	ComponentArray<Hostage> &EntityRegistry::GetHostages(void) {
+
+		return hostages_;
+	}
+
+
+	ComponentArray<HostageFollow> &EntityRegistry::GetHostageFollows(void) {
+
+		return follows_;
+	}
+
+
+	ComponentArray<Explosion> &EntityRegistry::GetExplosions(void) {
+
+		return explosions_;
+	}
+
+
+	SceneNode *EntityRegistry::GetNode(EntityId entity) {
+
+		Renderable *renderable = renderables_.Get(entity);
+		return renderable ? renderable->node : NULL;
+	}
+
+
+	EntityId EntityRegistry::GetEntity(const SceneNode *node) const {
+
+		uint32_t index = node->GetIndex();
+		if (index > entity_index_mask_g) {
+			throw(std::length_error("Too many scene nodes for entity identifiers"));
+		}
+		return MakeEntityId(index, GetGeneration(index));
+	}
+
+
+	bool EntityRegistry::IsAlive(EntityId entity) const {
+
+		return renderables_.Has(entity);
+	}
+
+
+	unsigned int EntityRegistry::GetTags(const SceneNode *node) const {
+
+		uint32_t index = node->GetIndex();
+		if (index >= tags_.size()) {
+			return 0;
+		}
+		return tags_[index] & ~destroyed_tag_g;
+	}
+
+
+	void EntityRegistry::Destroy(SceneNode *node, bool release) {
+
+		EntityId entity = GetEntity(node);
+		uint32_t index = GetEntityIndex(entity);
+		SetTag(entity, 0);
+		if (tags_[index] & destroyed_tag_g) {
+			return;
+		}
+
+		RemoveComponents(entity);
+		tags_[index] = destroyed_tag_g;
+
+		node->SetVisible(false);
+		if (release) {
+			released_.push_back(node);
+		}
+		else {
+			detached_.push_back(node);
+		}
+	}
+
+
+	void EntityRegistry::Destroy(EntityId entity, bool release) {
+
+		SceneNode *node = GetNode(entity);
+		if (node) {
+			Destroy(node, release);
+		}
+	}
+
+
+	void EntityRegistry::CollectGarbage(void) {
+
+		for (size_t i = 0; i < detached_.size(); i++) {
+			SceneNode *node = detached_[i];
+			if (node->GetParent()) {
+				node->GetParent()->RemoveChild(node);
+			}
+		}
+		detached_.clear();
+
+		for (size_t i = 0; i < released_.size(); i++) {
+			SceneNode *node = released_[i];
+			if (node->GetParent()) {
+				node->GetParent()->RemoveChild(node);
+			}
+			DeleteSubtree(node);
+		}
+		released_.clear();
+	}
+
+
+	void EntityRegistry::RemoveComponents(EntityId entity) {
+
+		transforms_.Remove(entity);
+		renderables_.Remove(entity);
+		healths_.Remove(entity);
+		turrets_.Remove(entity);
+		flyers_.Remove(entity);
+		damageables_.Remove(entity);
+		hostages_.Remove(entity);
+		follows_.Remove(entity);
+		explosions_.Remove(entity);
+	}
+
+
+	void EntityRegistry::SetTag(EntityId entity, unsigned int tag) {
+
+		uint32_t index = GetEntityIndex(entity);
+		if (index >= tags_.size()) {
+			tags_.resize(index + 1, 0);
+		}
+		tags_[index] |= tag;
+	}
+
+
+	uint32_t EntityRegistry::GetGeneration(uint32_t index) const {
+
+		return index < generations_.size() ? generations_[index] : 0;
+	}
+
+
+	void EntityRegistry::DeleteSubtree(SceneNode *node) {
+
+		std::vector<SceneNode *> stck;
+		stck.push_back(node);
+		while (stck.size() > 0) {
+			SceneNode *current = stck.back();
+			stck.pop_back();
+			for (std::vector<SceneNode *>::const_iterator it = current->children_begin();
+			it != current->children_end(); it++) {
+				stck.push_back(*it);
+			}
+			// The index goes to the next node created, which must start
+			// without components and under a new generation
+			EntityId entity = GetEntity(current);
+			uint32_t index = GetEntityIndex(entity);
+			RemoveComponents(entity);
+			if (index < tags_.size()) {
+				tags_[index] = 0;
+			}
+			if (index >= generations_.size()) {
+				generations_.resize(index + 1, 0);
+			}
+			generations_[index] = (generations_[index] + 1) % entity_generation_count_g;
+			delete current;
+		}
+	}
+
+} // namespace game
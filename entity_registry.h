@@ -0,0 +1,172 @@
+#ifndef ENTITY_REGISTRY_H_
+#define ENTITY_REGISTRY_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/quaternion.hpp>
+
+#include "component_array.h"
+
+namespace game {
+
+	class SceneNode;
+	class Helicopter;
+
+	// Tags telling which components a node carries
+	enum ComponentTag {
+		DAMAGEABLE_TAG = 1 << 1,
+		HOSTAGE_TAG = 1 << 3,
+		EXPLOSION_TAG = 1 << 4,
+		TRANSFORM_TAG = 1 << 5,
+		RENDERABLE_TAG = 1 << 6,
+		HEALTH_TAG = 1 << 7,
+		TURRET_TAG = 1 << 8,
+		FLYER_TAG = 1 << 9,
+		HOSTAGE_FOLLOW_TAG = 1 << 10
+	};
+
+	// World position and orientation of an entity. Systems work on this
+	// copy; it is pushed to the scene node once per frame
+	struct Transform {
+		glm::vec3 position;
+		glm::quat orientation;
+	};
+
+	// Scene node that draws an entity
+	struct Renderable {
+		SceneNode *node;
+	};
+
+	// Hit points
+	struct Health {
+		float health;
+		float armour; // Damage taken is divided by the armour
+		float hit_time; // Time of the last hit, or negative
+		bool blink; // Blink for a while after being hit
+	};
+
+	// Shoots bursts of missiles at the player when in range
+	struct Turret {
+		float range; // Distance under which the turret is aggressive
+		float period; // Time between bursts
+		float timer; // Time since the last burst
+		int burst; // Missiles per burst
+		int shots; // Missiles left in the current burst, one per update
+		bool agro;
+		EntityId mount; // Entity the turret sits on, or INVALID_ENTITY
+		glm::vec3 offset; // Position relative to the mount
+	};
+
+	// Flies level towards the player while its turret is aggressive
+	struct Flyer {
+		float speed; // Distance covered per update
+	};
+
+	// Enemy that the player's weapons can hit; hit points are in Health
+	struct Damageable {
+		int type; // Enemy::enemy_type
+	};
+
+	// A hostage that can be collected once its captors are dead
+	struct Hostage {
+		Helicopter *node;
+		SceneNode *trail; // Spline particles shown until collected
+		SceneNode *laser; // Beam, created when collected
+		bool collected;
+		EntityId captors[4]; // Enemies guarding it
+	};
+
+	// Collected hostage, following the player along its past positions
+	struct HostageFollow {
+		int slot; // Index in the trail of past positions
+	};
+
+	// Growing sphere that damages enemies inside it
+	struct Explosion {
+		SceneNode *node;
+	};
+
+	// Keeps the components of all game entities
+	//
+	// Entities are scene nodes, identified by SceneNode::GetIndex and the
+	// generation of that index. Systems query the dense component arrays
+	// directly; destroying an entity removes all of its components right
+	// away, so dead entities are never visited again. Removing swaps
+	// components around, so loops that may destroy entities iterate from
+	// the back. Identifiers held on to, in components or queues, may
+	// outlive their entity; lookups through them then find nothing
+	class EntityRegistry {
+
+	public:
+		EntityRegistry(void);
+		~EntityRegistry();
+
+		// Make a node an entity; returns its identifier
+		EntityId AddRenderable(SceneNode *node);
+		void AddTransform(EntityId entity, const Transform &transform);
+		void AddHealth(EntityId entity, const Health &health);
+		void AddTurret(EntityId entity, const Turret &turret);
+		void AddFlyer(EntityId entity, const Flyer &flyer);
+		void AddDamageable(EntityId entity, const Damageable &damageable);
+		void AddHostage(const Hostage &hostage);
+		void AddHostageFollow(EntityId entity, const HostageFollow &follow);
+		void AddExplosion(const Explosion &explosion);
+
+		ComponentArray<Transform> &GetTransforms(void);
+		ComponentArray<Renderable> &GetRenderables(void);
+		ComponentArray<Health> &GetHealths(void);
+		ComponentArray<Turret> &GetTurrets(void);
+		ComponentArray<Flyer> &GetFlyers(void);
+		ComponentArray<Damageable> &GetDamageables(void);
+		ComponentArray<Hostage> &GetHostages(void);
+		ComponentArray<HostageFollow> &GetHostageFollows(void);
+		ComponentArray<Explosion> &GetExplosions(void);
+
+		// Scene node of an entity, or NULL if it has no Renderable
+		SceneNode *GetNode(EntityId entity);
+
+		// Identifier of the entity a node is, or was last, made into
+		EntityId GetEntity(const SceneNode *node) const;
+		// False once the entity is destroyed
+		bool IsAlive(EntityId entity) const;
+
+		// Tags of the components currently attached to a node
+		unsigned int GetTags(const SceneNode *node) const;
+
+		// Remove all components of a node and hide it. If 'release' is
+		// true, the node and its subtree are deleted by the next call to
+		// CollectGarbage; otherwise they are only detached from the scene
+		void Destroy(SceneNode *node, bool release);
+		void Destroy(EntityId entity, bool release);
+
+		// Detach (and possibly delete) the nodes destroyed so far. Call
+		// once per frame, when no system holds on to node pointers
+		void CollectGarbage(void);
+
+	private:
+		ComponentArray<Transform> transforms_;
+		ComponentArray<Renderable> renderables_;
+		ComponentArray<Health> healths_;
+		ComponentArray<Turret> turrets_;
+		ComponentArray<Flyer> flyers_;
+		ComponentArray<Damageable> damageables_;
+		ComponentArray<Hostage> hostages_;
+		ComponentArray<HostageFollow> follows_;
+		ComponentArray<Explosion> explosions_;
+
+		std::vector<unsigned int> tags_; // Indexed by entity index
+		std::vector<uint32_t> generations_; // Indexed by entity index
+		std::vector<SceneNode *> detached_;
+		std::vector<SceneNode *> released_;
+
+		void RemoveComponents(EntityId entity);
+		void SetTag(EntityId entity, unsigned int tag);
+		uint32_t GetGeneration(uint32_t index) const;
+		void DeleteSubtree(SceneNode *node);
+
+	}; // class EntityRegistry
+
+} // namespace game
+
+#endif // ENTITY_REGISTRY_H_
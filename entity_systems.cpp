@@ -0,0 +1,178 @@
+#include <algorithm>
+
+#include "entity_systems.h"
+#include "scene_node.h"
+
+namespace game {
+
+	// Initial forward and up vectors of entities
+	const glm::vec3 entity_forward_g(0.0, 0.0, 1.0);
+	const glm::vec3 entity_up_g(0.0, 1.0, 0.0);
+
+	// Time during which an entity blinks after being hit
+	const float hit_blink_time_g = 3.0f;
+
+
+	// Orientation whose forward vector points along 'dir'. If 'level' is
+	// true, the up vector stays vertical
+	static glm::quat LookAlong(glm::quat orientation, glm::vec3 dir, bool level) {
+
+		glm::vec3 zax = glm::normalize(dir);
+		glm::vec3 xax = glm::normalize(glm::cross(orientation * entity_up_g, zax));
+		glm::vec3 yax = level ? entity_up_g : glm::cross(zax, xax);
+		return glm::quat(glm::mat3(xax, yax, zax));
+	}
+
+
+	void EntitySystems::UpdateTurrets(EntityRegistry &registry, const std::vector<EntityId> &candidates, glm::vec3 target, float delta_time, std::vector<EntityId> &fired) {
+
+		ComponentArray<Turret> &turrets = registry.GetTurrets();
+		ComponentArray<Transform> &transforms = registry.GetTransforms();
+		ComponentArray<Flyer> &flyers = registry.GetFlyers();
+
+		for (int i = 0; i < turrets.Size(); i++) {
+			Turret &turret = turrets[i];
+			Transform *transform = transforms.Get(turrets.GetEntity(i));
+			if (transform && turret.mount != INVALID_ENTITY) {
+				Transform *mount = transforms.Get(turret.mount);
+				if (mount) {
+					transform->position = mount->position + turret.offset;
+				}
+			}
+			turret.agro = false;
+		}
+
+		// Turrets away from the candidates are out of range
+		for (size_t i = 0; i < candidates.size(); i++) {
+			EntityId entity = candidates[i];
+			Turret *turret = turrets.Get(entity);
+			Transform *transform = transforms.Get(entity);
+			if (!turret || !transform) {
+				continue;
+			}
+
+			turret->agro = glm::length(target - transform->position) <= turret->range;
+			if (turret->agro) {
+				// Flyers aim themselves
+				if (!flyers.Has(entity)) {
+					transform->orientation = LookAlong(transform->orientation, target - transform->position, false);
+				}
+				turret->timer += delta_time;
+				if (turret->timer > turret->period) {
+					turret->timer = 0.0f;
+					turret->shots = turret->burst;
+				}
+			}
+		}
+
+		// A burst is finished even if the target goes out of range
+		for (int i = 0; i < turrets.Size(); i++) {
+			Turret &turret = turrets[i];
+			if (turret.shots > 0) {
+				turret.shots--;
+				fired.push_back(turrets.GetEntity(i));
+			}
+		}
+	}
+
+
+	void EntitySystems::UpdateFlyers(EntityRegistry &registry, glm::vec3 target) {
+
+		ComponentArray<Flyer> &flyers = registry.GetFlyers();
+		ComponentArray<Transform> &transforms = registry.GetTransforms();
+		ComponentArray<Turret> &turrets = registry.GetTurrets();
+
+		for (int i = 0; i < flyers.Size(); i++) {
+			EntityId entity = flyers.GetEntity(i);
+			Transform *transform = transforms.Get(entity);
+			Turret *turret = turrets.Get(entity);
+			if (!transform || (turret && !turret->agro)) {
+				continue;
+			}
+
+			transform->orientation = LookAlong(transform->orientation, target - transform->position, true);
+			transform->position += (transform->orientation * entity_forward_g) * flyers[i].speed;
+		}
+	}
+
+
+	void EntitySystems::UpdateHostageFollows(EntityRegistry &registry, const std::deque<glm::vec3> &trail, glm::quat orientation) {
+
+		ComponentArray<HostageFollow> &follows = registry.GetHostageFollows();
+		ComponentArray<Transform> &transforms = registry.GetTransforms();
+
+		for (int i = 0; i < follows.Size(); i++) {
+			Transform *transform = transforms.Get(follows.GetEntity(i));
+			if (!transform || follows[i].slot >= (int) trail.size()) {
+				continue;
+			}
+			transform->position = trail[follows[i].slot];
+			transform->orientation = orientation;
+		}
+	}
+
+
+	void EntitySystems::UpdateHitBlinks(EntityRegistry &registry, float time) {
+
+		ComponentArray<Health> &healths = registry.GetHealths();
+
+		for (int i = 0; i < healths.Size(); i++) {
+			Health &health = healths[i];
+			if (!health.blink || health.hit_time < 0.0f) {
+				continue;
+			}
+			SceneNode *node = registry.GetNode(healths.GetEntity(i));
+			if (!node) {
+				continue;
+			}
+			if (time - health.hit_time < hit_blink_time_g) {
+				node->SetVisible(!node->GetLocalVisible());
+			}
+			else {
+				health.hit_time = -1.0f;
+				node->SetVisible(true);
+			}
+		}
+	}
+
+
+	void EntitySystems::SyncTransforms(EntityRegistry &registry, JobSystem &jobs) {
+
+		ComponentArray<Transform> &transforms = registry.GetTransforms();
+		ComponentArray<Renderable> &renderables = registry.GetRenderables();
+
+		jobs.ParallelFor(transforms.Size(), 256, [&](int begin, int end) {
+			for (int i = begin; i < end; i++) {
+				Renderable *renderable = renderables.Get(transforms.GetEntity(i));
+				if (renderable) {
+					renderable->node->SetPosition(transforms[i].position);
+					renderable->node->SetOrientation(transforms[i].orientation);
+				}
+			}
+		});
+	}
+
+
+	float EntitySystems::ApplyDamage(EntityRegistry &registry, EntityId entity, float damage, float time) {
+
+		Health *health = registry.GetHealths().Get(entity);
+		if (!health) {
+			return 0.0f;
+		}
+		health->health -= std::max(0.1f, damage / health->armour);
+		health->hit_time = time;
+		return health->health;
+	}
+
+
+	bool EntitySystems::IsHostageFree(const EntityRegistry &registry, const Hostage &hostage) {
+
+		for (int i = 0; i < 4; i++) {
+			if (registry.IsAlive(hostage.captors[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+} // namespace game
@@ -0,0 +1,57 @@
+#ifndef ENTITY_SYSTEMS_H_
+#define ENTITY_SYSTEMS_H_
+
+#include <vector>
+#include <deque>
+#include <glm/glm.hpp>
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/quaternion.hpp>
+
+#include "entity_registry.h"
+#include "job_system.h"
+
+namespace game {
+
+	// Systems that update the game entities
+	//
+	// Each system walks one dense component array of the registry and
+	// looks up the other components it needs by entity, so updating an
+	// entity costs no virtual call and no scene graph traversal. Systems
+	// only write Transforms; SyncTransforms pushes them to the scene nodes
+	// and should run before anything reads node positions
+	//
+	// The Update functions never add or remove components, so systems that
+	// write different components can run as concurrent jobs. Entities to
+	// create or destroy are returned to the caller instead
+	class EntitySystems {
+
+	public:
+		// Aim turrets at the target and run their fire timers. Only the
+		// 'candidates', the entities found near the target, can be in
+		// range. Entities that fire a missile during this update are
+		// appended to 'fired'
+		static void UpdateTurrets(EntityRegistry &registry, const std::vector<EntityId> &candidates, glm::vec3 target, float delta_time, std::vector<EntityId> &fired);
+
+		// Move aggressive flyers towards the target
+		static void UpdateFlyers(EntityRegistry &registry, glm::vec3 target);
+
+		// Place collected hostages along the trail of past player positions
+		static void UpdateHostageFollows(EntityRegistry &registry, const std::deque<glm::vec3> &trail, glm::quat orientation);
+
+		// Blink entities that were hit recently
+		static void UpdateHitBlinks(EntityRegistry &registry, float time);
+
+		// Copy Transforms to the scene nodes
+		static void SyncTransforms(EntityRegistry &registry, JobSystem &jobs);
+
+		// Remove health from an entity and return what is left
+		static float ApplyDamage(EntityRegistry &registry, EntityId entity, float damage, float time);
+
+		// True once every captor of a hostage is dead
+		static bool IsHostageFree(const EntityRegistry &registry, const Hostage &hostage);
+
+	}; // class EntitySystems
+
+} // namespace game
+
+#endif // ENTITY_SYSTEMS_H_
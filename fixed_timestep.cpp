@@ -0,0 +1,80 @@
+#include "fixed_timestep.h"
+
+namespace game {
+
+	FixedTimestep::FixedTimestep(void) {
+
+		step_ = 1.0 / 60.0;
+		max_catch_up_ = 5;
+		accumulator_ = 0.0;
+		ticks_ = 0;
+	}
+
+
+	FixedTimestep::~FixedTimestep() {
+	}
+
+
+	void FixedTimestep::SetTickRate(double ticks_per_second) {
+
+		step_ = 1.0 / ticks_per_second;
+	}
+
+
+	void FixedTimestep::SetMaxCatchUp(int max_ticks) {
+
+		max_catch_up_ = max_ticks;
+	}
+
+
+	int FixedTimestep::Advance(double elapsed) {
+
+		accumulator_ += elapsed;
+		int ticks = (int) (accumulator_ / step_);
+		if (ticks > max_catch_up_) {
+			ticks = max_catch_up_;
+			accumulator_ = ticks * step_;
+		}
+		accumulator_ -= ticks * step_;
+		return ticks;
+	}
+
+
+	void FixedTimestep::Tick(void) {
+
+		ticks_++;
+	}
+
+
+	double FixedTimestep::GetStep(void) const {
+
+		return step_;
+	}
+
+
+	double FixedTimestep::GetTickRate(void) const {
+
+		return 1.0 / step_;
+	}
+
+
+	unsigned long long FixedTimestep::GetTickCount(void) const {
+
+		return ticks_;
+	}
+
+
+	double FixedTimestep::GetTime(void) const {
+
+		// Multiplying instead of summing steps keeps the time exact for a
+		// given tick whatever the history
+		return (double) ticks_ * step_;
+	}
+
+
+	float FixedTimestep::GetInterpolation(void) const {
+
+		return (float) (accumulator_ / step_);
+	}
+
+} // namespace game
@@ -0,0 +1,51 @@
+#ifndef FIXED_TIMESTEP_H_
+#define FIXED_TIMESTEP_H_
+
+namespace game {
+
+	// Simulation clock that advances in fixed ticks
+	//
+	// Real time is added to an accumulator, and whole ticks are taken out
+	// of it. The simulation only ever sees the fixed tick length, so it
+	// runs the same whatever the frame rate. What is left in the
+	// accumulator is the fraction of a tick the display is ahead of the
+	// simulation, used to interpolate between the last two ticks
+	class FixedTimestep {
+
+	public:
+		FixedTimestep(void);
+		~FixedTimestep();
+
+		// Ticks per second, and most ticks run by one Advance. Time beyond
+		// that is dropped, so the game slows down instead of spiralling
+		// when a frame takes too long
+		void SetTickRate(double ticks_per_second);
+		void SetMaxCatchUp(int max_ticks);
+
+		// Add elapsed real time and return the number of ticks to run
+		int Advance(double elapsed);
+
+		// Count the tick run, moving the simulation time forward
+		void Tick(void);
+
+		double GetStep(void) const;
+		double GetTickRate(void) const;
+
+		// Ticks run so far, and the simulation time they add up to
+		unsigned long long GetTickCount(void) const;
+		double GetTime(void) const;
+
+		// Fraction of a tick, in [0, 1), between the last tick and now
+		float GetInterpolation(void) const;
+
+	private:
+		double step_;
+		int max_catch_up_;
+		double accumulator_;
+		unsigned long long ticks_;
+
+	}; // class FixedTimestep
+
+} // namespace game
+
+#endif // FIXED_TIMESTEP_H_
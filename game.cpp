@@ -1,10 +1,12 @@
 #include <iostream>
-#include <time.h>
 #include <sstream>
+#include <algorithm>
+#include <chrono>
 
 #include "game.h"
+#include "entity_systems.h"
+#include "engine_counters.h"
 #include "bin/path_config.h"
-#include <stack>
 
 namespace game {
 
@@ -31,10 +33,88 @@ namespace game {
 	// Materials 
 	const std::string material_directory_g = MATERIAL_DIRECTORY;
 
+	// Name of the root of the scene graph, interned once
+	const NameId root_name_g = StringInterner::Intern("Root");
+
+	// Enemy settings
+	const float enemy_agro_range_g = 150.0f; // Distance under which turrets shoot
+	const float enemy_fire_period_g = 2.0f; // Time between bursts
+	const float enemy_flyer_speed_g = 1.5f;
+	const glm::vec3 tank_turret_offset_g(0.0, 3.0, 0.0);
+
+	// Least distance between the centers of two buildings, and the strip
+	// along the low edges of the world left free for the player to start
+	const float building_spacing_g = 36.0f;
+	const glm::vec2 city_margin_g(50.0f, 50.0f);
+
+	// Side of the world unless set from the command line
+	const int default_world_size_g = 600;
+
+	// The world is streamed in square chunks. Chunks within the radius of
+	// the player are attached; the radius covers most of the view distance
+	const float world_chunk_size_g = 200.0f;
+	const float world_stream_radius_g = 600.0f;
+
+	// Seed unless set from the command line, and the streams of the game's
+	// generators. Chunks of the world use their coordinates as stream,
+	// which never reach bit 62 (the top bit of a stream is dropped)
+	const uint64_t default_seed_g = 1;
+	const uint64_t particle_stream_g = (1ull << 62) | 1;
+	const uint64_t spawn_stream_g = (1ull << 62) | 2;
+	const uint64_t weapon_stream_g = (1ull << 62) | 3;
+
+	// Seconds a projectile lives if it stays in the world
+	const float projectile_lifetime_g = 10.0f;
+
+	// Distance under which a bullet hits an enemy, or the player picks up
+	// a hostage
+	const float bullet_hit_radius_g = 2.0f;
+	const float enemy_hit_radius_g = 2.0f; // Half the side of the box lasers aim at
+	const float hostage_pickup_radius_g = 2.0f;
+
+	// Bullets per detection job
+	const int bullet_contact_grain_g = 64;
+
+	// Collected hostages follow the player this many past positions apart.
+	// The trail starts long enough for 24 of them and grows up to the
+	// maximum; hostages rescued past it share the last position
+	const int hostage_follow_spacing_g = 5;
+	const int hostage_trail_length_g = 120;
+	const int max_hostage_trail_length_g = 1000;
+
+	// Side of the cells of the enemy and hostage proximity grids. Most
+	// queries are small, and the aggro query covers about 20x20 cells
+	const float proximity_cell_g = 16.0f;
+
+	// Lasers run along the local z axis of their shooter. The laser mesh is
+	// 2 units long, scaled by 40
+	const glm::vec3 laser_axis_g(0.0, 0.0, 1.0);
+	const float laser_range_g = 80.0f;
+
+	// Ticks between progress reports of a headless run
+	const int headless_report_period_g = 600;
+
+	// Timer queries in flight while benchmarking frames, and frames drawn
+	// first and left out of the times, while shaders and buffers settle
+	const int benchmark_query_count_g = 4;
+	const int benchmark_warmup_frames_g = 10;
+
+	// Benchmark enemies: one in this many is a flyer, the rest turrets
+	// on the ground. Flyers start at the given height
+	const int spawned_flyer_ratio_g = 4;
+	const float spawned_flyer_height_g = 60.0f;
+
 
 	Game::Game(void) {
 
 		// Don't do work in the constructor, leave it for the Init() function
+		window_ = NULL;
+		headless_ = false;
+		offscreen_ = false;
+		extra_enemies_ = 0;
+		world_size_ = default_world_size_g;
+		seed_ = default_seed_g;
+		snapshot_path_ = "";
 	}
 
 	GLFWcursor* Game::CreateBlankCursor()
@@ -52,20 +132,28 @@ namespace game {
 
 	void Game::Init(void) {
 
-		// Run all initialization steps
-		InitWindow();
+		// Run all initialization steps. Headless runs have no window,
+		// and register their resources without OpenGL
+		resman_.SetHeadless(headless_);
+		if (offscreen_) {
+			InitOffscreen();
+		} else if (!headless_) {
+			InitWindow();
+		}
 		InitView();
-		InitEventHandlers();
+		if (window_) {
+			InitEventHandlers();
+		}
 
-		time_t theLocalTime;
-		struct tm * timeinfo;
-		time(&theLocalTime);
-		timeinfo = localtime(&theLocalTime);
-		srand(timeinfo->tm_hour * 60 * 60 + timeinfo->tm_min * 60 + timeinfo->tm_sec);
+		// The same seed always gives the same world and spawns
+		particle_random_.Seed(seed_, particle_stream_g);
+		spawn_random_.Seed(seed_, spawn_stream_g);
+		weapon_random_.Seed(seed_, weapon_stream_g);
 
 		// Set variables
 		animating_ = true;
-		positions = std::deque<glm::vec3>(120, glm::vec3(0.0, 0.0, 0.0));
+		positions = std::deque<glm::vec3>(hostage_trail_length_g, glm::vec3(0.0, 0.0, 0.0));
+		rescued_hostages_ = 0;
 	}
 
 
@@ -101,16 +189,49 @@ namespace game {
 	}
 
 
-	void Game::InitView(void) {
+	void Game::InitOffscreen(void) {
 
-		// Set up z-buffer
-		glEnable(GL_DEPTH_TEST);
-		glDepthFunc(GL_LESS);
+		std::string error;
+		if (!offscreen_context_.Create(error)) {
+			throw(GameException(error));
+		}
 
-		// Set viewport
-		int width, height;
-		glfwGetFramebufferSize(window_, &width, &height);
-		glViewport(0, 0, width, height);
+		// GLEW looks for GLX as well, which an EGL context does not have;
+		// the OpenGL entry points are loaded by then
+		glewExperimental = GL_TRUE;
+		GLenum err = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+		if (err == GLEW_ERROR_NO_GLX_DISPLAY) {
+			err = GLEW_OK;
+		}
+#endif
+		if (err != GLEW_OK) {
+			throw(GameException(std::string("Could not initialize the GLEW library: ") + std::string((const char *)glewGetErrorString(err))));
+		}
+
+		// Frames are drawn at the size of the window
+		if (!offscreen_context_.CreateTarget(window_width_g, window_height_g, error)) {
+			throw(GameException(error));
+		}
+	}
+
+
+	void Game::InitView(void) {
+
+		// Runs without a window use the size of the window they would have
+		int width = window_width_g;
+		int height = window_height_g;
+		if (!headless_) {
+			// Set up z-buffer
+			glEnable(GL_DEPTH_TEST);
+			glDepthFunc(GL_LESS);
+
+			// Set viewport
+			if (window_) {
+				glfwGetFramebufferSize(window_, &width, &height);
+			}
+			glViewport(0, 0, width, height);
+		}
 
 
 		// Set up camera
@@ -142,10 +263,10 @@ namespace game {
 		resman_.CreateCylinder("CylinderMesh", 0.0f, 0.2f, 3, 10, -1);
 		resman_.CreateCylinder("LaserMesh", 0.0f, 0.2f, 3, 5, 0);
 		resman_.CreateCube("CubeMesh");
-		resman_.CreateMissileParticles("MissileParticles");
-		resman_.CreateMissileParticles("MissileParticle");
-		resman_.CreateTorusParticles("TorusParticles");
-		resman_.CreateControlPoints("ControlPoints", 64);
+		resman_.CreateMissileParticles("MissileParticles", particle_random_);
+		resman_.CreateMissileParticles("MissileParticle", particle_random_);
+		resman_.CreateTorusParticles("TorusParticles", particle_random_);
+		resman_.CreateControlPoints("ControlPoints", particle_random_, 64);
 
 		// Load material to be applied to asteroids
 		std::string filename = std::string(MATERIAL_DIRECTORY) + std::string("/material");
@@ -201,6 +322,21 @@ namespace game {
 		filename = std::string(MATERIAL_DIRECTORY) + std::string("/spline");
 		resman_.LoadResource(Material, "SplineMaterial", filename.c_str());
 
+		filename = std::string(MATERIAL_DIRECTORY) + std::string("/projectile");
+		resman_.LoadResource(Material, "ProjectileMaterial", filename.c_str());
+
+		filename = std::string(MATERIAL_DIRECTORY) + std::string("/projectile_fire");
+		resman_.LoadResource(Material, "ProjectileFireMaterial", filename.c_str());
+
+		filename = std::string(MATERIAL_DIRECTORY) + std::string("/hud");
+		resman_.LoadResource(Material, "HudMaterial", filename.c_str());
+
+		if (!headless_) {
+			projectile_renderer_.Init(resman_.GetResource("LaserMesh"), resman_.GetResource("ProjectileMaterial"),
+				resman_.GetResource("MissileParticles"), resman_.GetResource("ProjectileFireMaterial"), resman_.GetResource("Fire"));
+			hud_.Init(resman_.GetResource("HudMaterial"));
+		}
+
 
 
 	}
@@ -239,30 +375,65 @@ namespace game {
 		offsetx = 20.0f;
 		offsety = 2.0f;
 
-		worldXmax = 600;
+		worldXmax = world_size_;
 		worldXmin = 0;
-		worldZmax = 600;
+		worldZmax = world_size_;
 		worldZmin = 0;
 
 		missileFireRate = 2.0f;
 		missileTimer = missileFireRate;
 
 		// Set background color for the scene
-		glfwSetCursor(window_, CreateBlankCursor());
+		if (window_) {
+			glfwSetCursor(window_, CreateBlankCursor());
+		}
 		scene_.SetBackgroundColor(viewport_background_color_g);
 		cameraNode = CreateInstance("Camera", "", "");
 		SceneNode* root = CreateInstance("Root", "", "");
 		root->SetPosition(glm::vec3(0.0, 0.0, 0.0));
 		scene_.SetRoot(root);
 		root->AddChild(cameraNode);
+		// Enemies and hostages enter the proximity grids as they spawn
+		enemy_proximity_.Reset(proximity_cell_g);
+		hostage_proximity_.Reset(proximity_cell_g);
 		SetupHelicopter(0, NULL);		
+
+		// A snapshot from an earlier run with the same settings replaces
+		// generating the world and drawing the first spawns
+		std::chrono::steady_clock::time_point world_start = std::chrono::steady_clock::now();
+		bool from_snapshot = !snapshot_path_.empty() && snapshot_.Load(snapshot_path_, GetSnapshotKey());
+		world_streamer_.SetSnapshot(from_snapshot ? &snapshot_ : NULL);
 		SetupWorld();
-		positions = std::deque<glm::vec3>(120, heli->GetPosition());
+		std::vector<HostagePlacement> placements;
+		if (from_snapshot) {
+			snapshot_.GetHostages(placements);
+			snapshot_.GetSpawnState(spawn_random_);
+		} else {
+			for (int i = 0; i < 4; i++) {
+				HostagePlacement placement;
+				if (PickHostagePlacement(placement)) {
+					placements.push_back(placement);
+				}
+			}
+		}
+		double world_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - world_start).count();
+		std::cout << (from_snapshot ? "World loaded from snapshot in " : "World generated in ") << world_time << " ms" << std::endl;
+
+		if (!from_snapshot && !snapshot_path_.empty()) {
+			std::vector<WorldChunk *> chunks;
+			world_streamer_.GetAttached(chunks);
+			if (!WorldSnapshot::Write(snapshot_path_, GetSnapshotKey(), chunks, placements, spawn_random_)) {
+				std::cerr << "Could not write world snapshot " << snapshot_path_ << std::endl;
+			}
+		}
+
+		positions = std::deque<glm::vec3>(hostage_trail_length_g, heli->GetPosition());
+		rescued_hostages_ = 0;
 		// Create asteroid field
 		CreateLaserInstance("laser", "LaserMesh", "ObjectMaterial");
 
-		for (int i = 0; i < 4; i++) {
-			SpawnRandomHostage();
+		for (size_t i = 0; i < placements.size(); i++) {
+			SpawnHostage(placements[i]);
 		}
 
 
@@ -276,19 +447,22 @@ namespace game {
 		SceneNode* exSphere = CreateTexturedInstance("ExplosionSphere", "SimpleSphereMesh", "textureMaterial", "Explosion");
 		exSphere->SetPosition(pos);
 		exSphere->SetScale(glm::vec3(1.0, 1.0, 1.0));
-		scene_.GetNode("Root")->AddChild(exSphere);
-		explosionSpheres.push_back(exSphere);
+		scene_.GetNode(root_name_g)->AddChild(exSphere);
+		Explosion explosion = { exSphere };
+		registry_.AddExplosion(explosion);
 		return exSphere;
 	}
 	void Game::UpdateExplosions(float dTime) {
-		for (int i = 0; i < explosionSpheres.size(); i++) {
-			if (glm::length(explosionSpheres[i]->GetScale()) > 20.0) {
-				explosionSpheres[i]->SetVisible(false);
-				explosionSpheres.erase(explosionSpheres.begin() + i);
+		ComponentArray<Explosion> &explosions = registry_.GetExplosions();
+		for (int i = explosions.Size() - 1; i >= 0; i--) {
+			SceneNode *sphere = explosions[i].node;
+			if (glm::length(sphere->GetScale()) > 20.0) {
+				registry_.Destroy(sphere, true);
 			}
 			else
-				explosionSpheres[i]->SetScale(explosionSpheres[i]->GetScale() + (1.0f + 6.5f * dTime));
+				sphere->SetScale(sphere->GetScale() + (1.0f + 6.5f * dTime));
 		}
+		registry_.CollectGarbage();
 	}
 
 
@@ -296,53 +470,112 @@ namespace game {
 		return glm::vec2(windowCenter.x - cursorPos.x, windowCenter.y - cursorPos.y);
 	}
 
+	void Game::SetTickRate(double ticks_per_second) {
+
+		clock_.SetTickRate(ticks_per_second);
+	}
+
+
+	void Game::SetWorldSize(int size) {
+
+		world_size_ = size;
+	}
+
+
+	void Game::SetSeed(uint64_t seed) {
+
+		seed_ = seed;
+	}
+
+
+	uint64_t Game::GetSeed(void) const {
+
+		return seed_;
+	}
+
+
+	void Game::SetHeadless(bool headless) {
+
+		headless_ = headless;
+	}
+
+
+	void Game::SetOffscreen(bool offscreen) {
+
+		offscreen_ = offscreen;
+	}
+
+
+	void Game::StartRecording(const std::string &path) {
+
+		RecordingSettings settings = { seed_, world_size_, extra_enemies_, clock_.GetTickRate() };
+		if (!recorder_.Open(path, settings)) {
+			throw(GameException(std::string("Could not write input recording ") + path));
+		}
+	}
+
+
+	void Game::UseSettings(const RecordingSettings &settings) {
+
+		seed_ = settings.seed;
+		world_size_ = settings.world_size;
+		clock_.SetTickRate(settings.tick_rate);
+	}
+
+
+	void Game::SetSnapshotPath(const std::string &path) {
+
+		snapshot_path_ = path;
+	}
+
+
+	WorldSnapshotKey Game::GetSnapshotKey(void) const {
+
+		WorldSnapshotKey key = { seed_, world_size_, world_chunk_size_g, building_spacing_g };
+		return key;
+	}
+
+
 	void Game::MainLoop(void) {
 		double cursorGetX, cursorGetY;
-
+		double last_time = glfwGetTime();
+		EngineCounters::Reset();
 
 		// Loop while the user did not close the window
 		while (!glfwWindowShouldClose(window_)) {
-			// Animate the scene
+			double current_time = glfwGetTime();
+			double elapsed = current_time - last_time;
+			last_time = current_time;
+
+			// Animate the scene in fixed ticks, however long the frame took
+			float interpolation = 1.0f;
 			if (animating_) {
-				static double last_time = 0;
-				double current_time = glfwGetTime();
-				double deltaTime = current_time - last_time;
-				if (deltaTime > 1.0 / 60.0) {
+				int ticks = clock_.Advance(elapsed);
+				for (int i = 0; i < ticks; i++) {
 
-					if (missileTimer > -1.0f)
-						missileTimer -= deltaTime;
 					glfwGetCursorPos(window_, &cursorGetX, &cursorGetY);
 					cursorPos = glm::vec2((float)cursorGetX, (float)cursorGetY);
-					playerMouse = CursorMovement();
+					TickInput input;
+					CaptureInput(input);
 
 					glfwSetCursorPos(window_, 1920.0 / 2.0, 1080.0 / 2.0);
 
-
-					scene_.Update();
-					Update(window_);
-					UpdateExplosions(deltaTime);
-					last_time = current_time;
+					Step(input);
 				}
+				interpolation = clock_.GetInterpolation();
 			}
-			if (glm::length(positions.front() - heli->GetPosition()) > 0.3) {
-				positions.push_front(heli->GetPosition());
 
-				positions.pop_back();
-				for (int i = 0; i < hostages.size(); i++) {
-					if (hostcollected[i]) {
-						hostages[i]->SetPosition(positions[((i + 1) * 5) - 1]);
-						hostages[i]->SetOrientation(heli->GetOrientation());
-						scene_.GetNode(hostages[i]->GetName() + +"SplineParticles")->SetVisible(false);
-					}
-				}
-			}
 
-
-			// Draw the scene
-			scene_.Draw(&camera_);
+			// Draw the scene between the last two ticks
+			scene_.Draw(&camera_, interpolation, clock_.GetTime());
+			projectile_renderer_.Draw(&camera_, projectiles_, interpolation, clock_.GetTime());
+			if (hud_.IsVisible()) {
+				DrawHud(elapsed);
+			}
 
 			// Push buffer drawn in the background onto the display
 			glfwSwapBuffers(window_);
+			EngineCounters::EndFrame();
 
 			// Update other events like input handling
 			glfwPollEvents();
@@ -351,19 +584,203 @@ namespace game {
 	}
 
 
+	void Game::RunHeadless(int ticks, InputSource &input, RunStats &stats) {
+
+		// The clock only counts ticks here; nothing waits for real time
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::chrono::steady_clock::time_point last_report = start;
+		stats.tick_times.clear();
+		stats.tick_times.reserve(ticks);
+		EngineCounters::Reset();
+		int run = 0;
+		TickInput tick_input;
+		while (run < ticks && input.Next(tick_input)) {
+			std::chrono::steady_clock::time_point tick_start = std::chrono::steady_clock::now();
+			Step(tick_input);
+			std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			stats.tick_times.push_back(std::chrono::duration<double, std::milli>(now - tick_start).count());
+			EngineCounters::EndFrame();
+			run++;
+
+			if (run % headless_report_period_g == 0) {
+				double seconds = std::chrono::duration<double>(now - last_report).count();
+				last_report = now;
+				std::cout << "Tick " << clock_.GetTickCount() << ": " << headless_report_period_g / seconds << " ticks/s, "
+					<< registry_.GetRenderables().Size() << " entities, " << projectiles_.Size() << " projectiles" << std::endl;
+			}
+		}
+
+		stats.ticks = run;
+		stats.warmup_ticks = 0;
+		stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		stats.simulated_seconds = clock_.GetTime();
+		stats.entities = registry_.GetRenderables().Size();
+		stats.projectiles = projectiles_.Size();
+	}
+
+
+	void Game::RunBenchmark(int frames, InputSource &input, RunStats &stats) {
+
+		// GPU time is measured with timer queries, read back a few frames
+		// later so the CPU never waits on them
+		bool gpu_timing = GLEW_ARB_timer_query != 0;
+		GLuint queries[benchmark_query_count_g];
+		if (gpu_timing) {
+			glGenQueries(benchmark_query_count_g, queries);
+		}
+
+		stats.tick_times.clear();
+		stats.cpu_frame_times.clear();
+		stats.gpu_frame_times.clear();
+		stats.frame_draw_calls.clear();
+		stats.tick_times.reserve(frames);
+		stats.cpu_frame_times.reserve(frames);
+		stats.gpu_frame_times.reserve(frames);
+		stats.frame_draw_calls.reserve(frames);
+		std::chrono::steady_clock::time_point run_start = std::chrono::steady_clock::now();
+		EngineCounters::Reset();
+		int warmup = benchmark_warmup_frames_g;
+		int run = 0; // Frames timed so far
+		TickInput tick_input;
+		while (run < frames && input.Next(tick_input)) {
+			bool timed = warmup == 0;
+			std::chrono::steady_clock::time_point tick_start = std::chrono::steady_clock::now();
+			Step(tick_input);
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			GLuint query = queries[run % benchmark_query_count_g];
+			if (timed && gpu_timing && run >= benchmark_query_count_g) {
+				GLuint64 elapsed;
+				glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+				stats.gpu_frame_times.push_back(elapsed / 1.0e6);
+			}
+
+			long long draw_calls = EngineCounters::Get(COUNTER_DRAW_CALLS);
+			if (timed && gpu_timing) {
+				glBeginQuery(GL_TIME_ELAPSED, query);
+			}
+			scene_.Draw(&camera_, 1.0f, clock_.GetTime());
+			projectile_renderer_.Draw(&camera_, projectiles_, 1.0f, clock_.GetTime());
+			if (timed && gpu_timing) {
+				glEndQuery(GL_TIME_ELAPSED);
+			}
+			glFlush();
+			if (timed) {
+				std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+				stats.tick_times.push_back(std::chrono::duration<double, std::milli>(start - tick_start).count());
+				stats.cpu_frame_times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+				stats.frame_draw_calls.push_back((int) (EngineCounters::Get(COUNTER_DRAW_CALLS) - draw_calls));
+				run++;
+			} else {
+				warmup--;
+			}
+			EngineCounters::EndFrame();
+		}
+
+		// The queries of the last frames
+		if (gpu_timing) {
+			for (int i = std::max(run - benchmark_query_count_g, 0); i < run; i++) {
+				GLuint64 elapsed;
+				glGetQueryObjectui64v(queries[i % benchmark_query_count_g], GL_QUERY_RESULT, &elapsed);
+				stats.gpu_frame_times.push_back(elapsed / 1.0e6);
+			}
+			glDeleteQueries(benchmark_query_count_g, queries);
+		}
+
+		stats.ticks = run;
+		stats.warmup_ticks = benchmark_warmup_frames_g - warmup;
+		stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count();
+		stats.simulated_seconds = clock_.GetTime();
+		stats.entities = registry_.GetRenderables().Size();
+		stats.projectiles = projectiles_.Size();
+		std::cout << "Timed " << run << " frames of " << window_width_g << "x" << window_height_g
+			<< " on " << (const char *) glGetString(GL_RENDERER) << std::endl;
+	}
+
+
+	void Game::DrawHud(double frame_time) {
+
+		// The counters are those of the frame before, which is complete
+		std::ostringstream line;
+		line.setf(std::ios::fixed);
+		line.precision(2);
+		line << "FRAME " << frame_time * 1000.0 << " MS";
+		hud_lines_.clear();
+		hud_lines_.push_back(line.str());
+		for (int i = 0; i < COUNTER_COUNT; i++) {
+			line.str("");
+			line << EngineCounters::GetName((Counter) i) << " " << EngineCounters::GetLast((Counter) i);
+			hud_lines_.push_back(line.str());
+		}
+
+		int width, height;
+		glfwGetFramebufferSize(window_, &width, &height);
+		hud_.Draw(hud_lines_, width, height);
+	}
+
+
+	// Game flag of each button, in InputButton order
+	bool Game::* const Game::input_flags_[INPUT_BUTTON_COUNT] = {
+		&Game::input_up, &Game::input_down, &Game::input_left, &Game::input_right, &Game::input_s, &Game::input_x,
+		&Game::input_a, &Game::input_z, &Game::input_e, &Game::input_q, &Game::input_j, &Game::input_l, &Game::input_i,
+		&Game::input_k, &Game::input_c, &Game::input_m, &Game::input_t, &Game::input_w, &Game::input_d, &Game::input_b,
+		&Game::input_space, &Game::input_shift, &Game::input_m1, &Game::input_m2, &Game::input_m3
+	};
+
+
+	void Game::CaptureInput(TickInput &input) {
+
+		input.buttons = 0;
+		for (int i = 0; i < INPUT_BUTTON_COUNT; i++) {
+			if (this->*input_flags_[i]) {
+				input.buttons |= 1u << i;
+			}
+		}
+		input.mouse = CursorMovement();
+	}
+
+
+	void Game::ApplyInput(const TickInput &input) {
+
+		for (int i = 0; i < INPUT_BUTTON_COUNT; i++) {
+			this->*input_flags_[i] = ((input.buttons >> i) & 1) != 0;
+		}
+		playerMouse = input.mouse;
+	}
+
+
+	void Game::Step(const TickInput &input) {
+
+		ApplyInput(input);
+		if (recorder_.IsOpen()) {
+			recorder_.Record(input);
+		}
+
+		float step = (float) clock_.GetStep();
+		if (missileTimer > -1.0f)
+			missileTimer -= step;
+		camera_.SaveState();
+		scene_.Update(jobs_);
+		Update(step);
+		UpdateExplosions(step);
+		clock_.Tick();
+		EngineCounters::Set(COUNTER_PROJECTILES, projectiles_.Size());
+	}
+
+
 	void Game::PrintVec3(glm::vec3 vec) {
 
 		std::cout << "x = " << vec.x << " y = " << vec.y << " z = " << vec.z << std::endl;
 
 	}
 
-	void Game::Update(GLFWwindow* window) {
+	void Game::Update(float delta_time) {
 
-		void* ptr = glfwGetWindowUserPointer(window);
-		Game *game = (Game *)ptr;
+		Game *game = this;
 		float rot_factor(glm::pi<float>() / 180);
 		float trans_factor = 1.0;
 		ticker = (ticker + 1) % 30;
+		StreamWorld();
 		//game->test->Scale(glm::vec3(1.01, 1.01, 1.01));
 		//PrintVec3(game->test->GetScale());
 		glm::vec3 prevpos = heli->GetPosition();
@@ -522,30 +939,42 @@ namespace game {
 		//, game->camera_.GetForward().y * ship_velocity[2] + game->camera_.GetSide().y * ship_velocity[0] + game->camera_.GetUp().y *ship_velocity[1]
 		//, game->camera_.GetForward().z * ship_velocity[2] + game->camera_.GetSide().z * ship_velocity[0] + game->camera_.GetUp().z *ship_velocity[1]);
 
-		glm::vec3* pos = &game->heli->GetPosition();
-		if (pos->z < 0) {
-			game->heli->SetPosition(glm::vec3(pos->x, pos->y, 0));
+		// Keep the player inside the world. GetPosition returns a copy, so
+		// the position is clamped here and set once
+		glm::vec3 pos = game->heli->GetPosition();
+		bool clamped = false;
+		if (pos.z < 0) {
+			pos.z = 0;
 			ship_velocity[2] = 0;
+			clamped = true;
 		}
-		if (pos->z > worldZmax) {
-			game->heli->SetPosition(glm::vec3(pos->x, pos->y, worldZmax));
+		if (pos.z > worldZmax) {
+			pos.z = (float) worldZmax;
 			ship_velocity[2] = 0;
+			clamped = true;
 		}
-		if (pos->x > worldXmax) {
-			game->heli->SetPosition(glm::vec3(worldXmax, pos->y, pos->z));
+		if (pos.x > worldXmax) {
+			pos.x = (float) worldXmax;
 			ship_velocity[0] = 0;
+			clamped = true;
 		}
-		if (pos->x < 0) {
-			game->heli->SetPosition(glm::vec3(0, pos->y, pos->z));
+		if (pos.x < 0) {
+			pos.x = 0;
 			ship_velocity[0] = 0;
+			clamped = true;
 		}
-		if (pos->y < 0) {
-			game->heli->SetPosition(glm::vec3(pos->x, -0, pos->z));
+		if (pos.y < 0) {
+			pos.y = 0;
 			ship_velocity[1] = 0;
+			clamped = true;
 		}
-		if (pos->y > 350) {
-			game->heli->SetPosition(glm::vec3(pos->x, 350, pos->z));
+		if (pos.y > 350) {
+			pos.y = 350;
 			ship_velocity[1] = 0;
+			clamped = true;
+		}
+		if (clamped) {
+			game->heli->SetPosition(pos);
 		}
 		/*
 		glm::vec3* pos = &game->heli->GetPosition();
@@ -601,39 +1030,49 @@ namespace game {
 		game->heli->Translate(-game->heli->GetSide()*trans_factor*ship_velocity[0] * -1.0f);
 		game->heli->Translate(glm::vec3(0.0, 1.0, 0.0)*trans_factor*ship_velocity[1]);
 
-		std::vector<glm::vec3> explodingMissilePrevPosVector;
-
-		for (int ii = 0; ii < explodingMissiles.size(); ii++) {
-			explodingMissilePrevPosVector.push_back(explodingMissiles[ii]->GetPosition());
-			if (explodingMissiles[ii]->GetVisible()) {
-				if (explodingMissiles[ii]->GetPosition().x < worldXmin || explodingMissiles[ii]->GetPosition().z < worldZmin || explodingMissiles[ii]->GetPosition().x > worldXmax ||
-					explodingMissiles[ii]->GetPosition().z > worldZmax || explodingMissiles[ii]->GetPosition().y > 350 || explodingMissiles[ii]->GetPosition().y < -20) {
-					explodingMissiles[ii]->SetVisible(false);
-				}
-				else {
-					explodingMissiles[ii]->SetPosition(explodingMissiles[ii]->GetPosition() + glm::normalize(explodingMissiles[ii]->direction) * 5.0f);
-				}
-			}
-		}
-
-
-		SceneNode* collidedBuilding = NULL;
-		glm::vec3 heliPos = heli->GetPosition();
-		bool heliCollided = false;
-		for (int i = 0; i < buildings.size(); i++) {
-			if (PointBoxCollision(heliPos, buildings[i]->boundingBox) && heliCollided == false) {
-				collidedBuilding = buildings[i];
-				HeliBuildingCollision(collidedBuilding, prevpos);
-				heliCollided = true;
-			}
-			for (int j = 0; j < explodingMissiles.size(); j++)
-				if (explodingMissiles[j]->GetVisible() && i < buildings.size()) {
-					if (PointBoxCollision(explodingMissiles[j]->GetPosition(), buildings[i]->boundingBox)) {
-						collidedBuilding = buildings[i];
-						MissileBuidlingCollision(collidedBuilding, explodingMissiles[j], explodingMissilePrevPosVector[j]);
-					}
-				}
-		}
+		// Run the entity systems. They write disjoint components, except
+		// flyers which need the aggro state computed by the turrets
+		bool trail_moved = glm::length(positions.front() - heli->GetPosition()) > 0.3;
+		if (trail_moved) {
+			positions.push_front(heli->GetPosition());
+			positions.pop_back();
+		}
+		glm::vec3 target = heli->GetPosition();
+		glm::quat target_orientation = heli->GetOrientation();
+		float now = (float) clock_.GetTime();
+		std::vector<EntityId> fired;
+
+		// Only the enemies around the target can be in range of it
+		turret_candidates_.clear();
+		enemy_proximity_.Query(target, enemy_agro_range_g, turret_candidates_);
+
+		TaskGraph systems;
+		TaskGraph::TaskId turrets = systems.Add([&]() { EntitySystems::UpdateTurrets(registry_, turret_candidates_, target, delta_time, fired); });
+		TaskGraph::TaskId flyers = systems.Add([&]() { EntitySystems::UpdateFlyers(registry_, target); });
+		systems.Precede(turrets, flyers);
+		systems.Add([&]() { projectiles_.Integrate(glm::vec3(worldXmin, 0.0, worldZmin), glm::vec3(worldXmax, 350.0, worldZmax), delta_time); });
+		systems.Add([&]() { EntitySystems::UpdateHitBlinks(registry_, now); });
+		if (trail_moved) {
+			systems.Add([&]() { EntitySystems::UpdateHostageFollows(registry_, positions, target_orientation); });
+		}
+		jobs_.Run(systems);
+
+		// Back on the main thread: structural changes and node updates
+		EntitySystems::SyncTransforms(registry_, jobs_);
+		// Flyers are the only enemies that move
+		ComponentArray<Flyer> &moving = registry_.GetFlyers();
+		for (int i = 0; i < moving.Size(); i++) {
+			EntityId flyer = moving.GetEntity(i);
+			enemy_proximity_.Move(flyer, registry_.GetTransforms().Get(flyer)->position);
+		}
+		for (size_t i = 0; i < fired.size(); i++) {
+			CreateEnemyMissile(fired[i]);
+		}
+
+		// Building contacts are handled before the camera follows the
+		// player
+		DetectBuildingContacts(prevpos);
+		RespondToContacts();
 
 		/*
 		box : 0 min x max y max z
@@ -650,66 +1089,40 @@ namespace game {
 		game->camera_.Translate(-game->heli->GetSide()*trans_factor*ship_velocity[0] * -1.0f);
 		game->camera_.Translate(glm::vec3(0.0, 1.0, 0.0)*trans_factor*ship_velocity[1]);
 
-		std::cout << glm::normalize(glm::dot(glm::vec3(1.0, 4.0, 8.0), glm::vec3(-1.0, -4.0, -8.0))) << std::endl;
-
 		game->camera_.SetPosition(heli->GetPosition() - camera_.GetForward() * offsetx + camera_.GetUp() * offsety);
 
 		if (game->input_c == true || game->input_m2 == true) {
 			lazerref->SetVisible(true);
 			lazerref->SetPosition(this->heli->GetPosition()/* + this->heli->GetForward() /* -45.0f/* + game->camera_.GetUp()*((float)-0.1)*/);
 			lazerref->SetOrientation(-this->heli->GetOrientation());
-			for (int i = 0; i < childlasers.size(); ++i) {
-				if (hostcollected[i]) {
-					childlasers[i]->SetVisible(true);
-					childlasers[i]->SetPosition(hostages[i]->GetPosition()/* + hostages[i]->GetForward() * 45.0f/* + game->camera_.GetUp()*((float)-0.1)*/);
-					childlasers[i]->SetOrientation(hostages[i]->GetOrientation());
+			ComponentArray<Hostage> &hostages = registry_.GetHostages();
+			for (int i = 0; i < hostages.Size(); ++i) {
+				if (hostages[i].laser) {
+					hostages[i].laser->SetVisible(true);
+					hostages[i].laser->SetPosition(hostages[i].node->GetPosition());
+					hostages[i].laser->SetOrientation(hostages[i].node->GetOrientation());
 				}
 			}
-			checkForCollisions(window, true);
+			checkForCollisions(true);
 		}
 		else {
 			lazerref->SetVisible(false);
-			for (int i = 0; i < childlasers.size(); ++i) {
-				childlasers[i]->SetVisible(false);
+			ComponentArray<Hostage> &hostages = registry_.GetHostages();
+			for (int i = 0; i < hostages.Size(); ++i) {
+				if (hostages[i].laser) {
+					hostages[i].laser->SetVisible(false);
+				}
 			}
 		}
 		if (game->input_m == true || game->input_m3 == true) {
 			if (missileTimer < 0.0f) {
-				CreateMissileInstance("missile", "LaserMesh", "ObjectMaterial");
+				CreateMissileInstance();
 				missileTimer = missileFireRate;
 			}
 		}
 		if (game->input_m == true || game->input_m1 == true) {
 			if (ticker % 5 == 0)
-				CreateBulletInstance("bullet", "MissileParticle", "MissileMaterial");
-		}
-		for (int i = 0; i < missiles.size(); i++) {
-			if (missiles[i]->GetPosition().x < worldXmin || missiles[i]->GetPosition().z < worldZmin || missiles[i]->GetPosition().x > worldXmax || missiles[i]->GetPosition().z > worldZmax || missiles[i]->GetPosition().y > 350 || missiles[i]->GetPosition().y < 0)
-				missiles[i]->SetVisible(false);
-			else
-				missiles[i]->SetPosition(missiles[i]->GetPosition() + glm::normalize(missiles[i]->direction) * 5.0f);
-		}
-		for (int i = 0; i < enemymissiles.size(); i++) {
-			if (enemymissiles[i]->GetPosition().x < worldXmin || enemymissiles[i]->GetPosition().z < worldZmin || enemymissiles[i]->GetPosition().x > worldXmax || enemymissiles[i]->GetPosition().z > worldZmax || enemymissiles[i]->GetPosition().y > 350 || enemymissiles[i]->GetPosition().y < 0)
-				enemymissiles[i]->SetVisible(false);
-			else
-				enemymissiles[i]->SetPosition(enemymissiles[i]->GetPosition() + glm::normalize(enemymissiles[i]->direction)*3.0f);
-		}
-		for (int i = 0; i < childmissiles.size(); i++) {
-			if (hostcollected[i]) {
-				for (int j = 0; j < childmissiles[i].size(); j++) {
-					if (childmissiles[i][j]->GetPosition().x < worldXmin || childmissiles[i][j]->GetPosition().z < worldZmin || childmissiles[i][j]->GetPosition().x > worldXmax || childmissiles[i][j]->GetPosition().z > worldZmax || childmissiles[i][j]->GetPosition().y > 350 || childmissiles[i][j]->GetPosition().y < 0)
-						childmissiles[i][j]->SetVisible(false);
-					else
-						childmissiles[i][j]->SetPosition(childmissiles[i][j]->GetPosition() + glm::normalize(childmissiles[i][j]->direction) * 5.0f);
-				}
-			}
-		}
-
-		for (int i = 0; i < enemies.size(); ++i) {
-			if (enemies[i]->Shoot()) {
-				CreateEnemyMissile("enemymissile", "LaserMesh", "ObjectMaterial", enemies[i]);
-			}
+				CreateBulletInstance();
 		}
 
 
@@ -717,157 +1130,217 @@ namespace game {
 		cameraNode->SetPosition(game->camera_.GetPosition());
 
 		int uncollectedHostages = 0;
-		for (int i = 0; i < hostages.size(); i++) {
-			if (hostcollected[i] == false)
+		ComponentArray<Hostage> &hostages = registry_.GetHostages();
+		for (int i = 0; i < hostages.Size(); i++) {
+			if (hostages[i].collected == false)
 				uncollectedHostages++;
 		}
 		if (uncollectedHostages < 4) {
 			SpawnRandomHostage();
 		}
 
-		PrintVec3(heli->GetPosition());
-		checkForCollisions(window, false);
+		checkForCollisions(false);
+		RespondToContacts();
+		registry_.CollectGarbage();
+		projectiles_.Compact();
 	}
 
-	void Game::HeliBuildingCollision(SceneNode* collidedBuilding, glm::vec3 prevpos) {
+	void Game::DetectBuildingContacts(glm::vec3 prevpos) {
 
-		for (int sideCounter = 0; sideCounter < 6; sideCounter++)
-			if (collidedBuilding != NULL) {
-				glm::vec3* box = collidedBuilding->boundingBox;
-				glm::vec3* possibleIntersection;
-				for (int once = 0; once < 1; once++) {
-					possibleIntersection = LinePlaneCollision(glm::vec3(1.0, 0.0, 0.0), box[1], heli->GetPosition(), prevpos);
-					if (possibleIntersection != NULL) {
-						if (possibleIntersection->x >= heli->GetPosition().x && possibleIntersection->x <= prevpos.x &&
-							possibleIntersection->y <= box[1].y && possibleIntersection->z <= box[1].z &&
-							possibleIntersection->y >= box[6].y && possibleIntersection->z >= box[6].z) {
-							ship_velocity[0] = 0.0;
-							heli->SetPosition(glm::vec3(box[1].x, heli->GetPosition().y, heli->GetPosition().z));
-							continue;
-						}
-					}
-					possibleIntersection = LinePlaneCollision(glm::vec3(-1.0, 0.0, 0.0), box[6], heli->GetPosition(), prevpos);
-					if (possibleIntersection != NULL) {
-						if (possibleIntersection->x <= heli->GetPosition().x && possibleIntersection->x >= prevpos.x &&
-							possibleIntersection->y <= box[1].y && possibleIntersection->z <= box[1].z &&
-							possibleIntersection->y >= box[6].y && possibleIntersection->z >= box[6].z) {
-							ship_velocity[0] = 0.0;
-							heli->SetPosition(glm::vec3(box[6].x, heli->GetPosition().y, heli->GetPosition().z));
-							continue;
-						}
-					}
-					possibleIntersection = LinePlaneCollision(glm::vec3(0.0, 1.0, 0.0), box[1], heli->GetPosition(), prevpos);
-					if (possibleIntersection != NULL) {
-						if (possibleIntersection->y >= heli->GetPosition().y && possibleIntersection->y <= prevpos.y &&
-							possibleIntersection->x <= box[1].x && possibleIntersection->z <= box[1].z &&
-							possibleIntersection->x >= box[6].x && possibleIntersection->z >= box[6].z) {
-							ship_velocity[1] = 0.0;
-							heli->SetPosition(glm::vec3(heli->GetPosition().x, box[1].y, heli->GetPosition().z));
-							continue;
-						}
-					}
-					possibleIntersection = LinePlaneCollision(glm::vec3(0.0, -1.0, 0.0), box[6], heli->GetPosition(), prevpos);
-					if (possibleIntersection != NULL) {
-						if (possibleIntersection->y <= heli->GetPosition().y && possibleIntersection->y >= prevpos.x &&
-							possibleIntersection->x <= box[1].x && possibleIntersection->z <= box[1].z &&
-							possibleIntersection->x >= box[6].x && possibleIntersection->z >= box[6].z) {
-							ship_velocity[1] = 0.0;
-							heli->SetPosition(glm::vec3(heli->GetPosition().x, box[6].y, heli->GetPosition().z));
-							continue;
-						}
+		// Only the buildings in the cell of a point, in the chunk under
+		// it, can contain it
+		glm::vec3 heliPos = heli->GetPosition();
+		int heli_chunk = FindChunk(heliPos);
+		if (heli_chunk >= 0) {
+			const WorldChunk *chunk = attached_chunks_[heli_chunk];
+			int count;
+			const int *candidates = chunk->grid.Query(heliPos, count);
+			EngineCounters::Add(COUNTER_COLLISION_PAIRS, count);
+			for (int i = 0; i < count; i++) {
+				const AABB &box = chunk->boxes[candidates[i]];
+				if (box.Contains(heliPos)) {
+					SweepHit hit;
+					if (box.Sweep(prevpos, heliPos, hit)) {
+						Contact contact = { HELI_BUILDING, INVALID_ENTITY, -1, 0.0f, hit.point, hit.normal };
+						contacts_.Push(contact);
 					}
-					possibleIntersection = LinePlaneCollision(glm::vec3(0.0, 0.0, 1.0), box[1], heli->GetPosition(), prevpos);
-					if (possibleIntersection != NULL) {
-						if (possibleIntersection->z >= heli->GetPosition().z && possibleIntersection->z <= prevpos.z &&
-							possibleIntersection->y <= box[1].y && possibleIntersection->x < box[1].x &&
-							possibleIntersection->y >= box[6].y && possibleIntersection->x > box[6].x) {
-							ship_velocity[2] = 0.0;
-							heli->SetPosition(glm::vec3(heli->GetPosition().x, heli->GetPosition().y, box[1].z));
-							continue;
-						}
+					break;
+				}
+			}
+		}
+
+		// Missiles test the whole step they moved this frame, so fast ones
+		// cannot pass through a wall between two frames. A step is much
+		// shorter than a chunk, so it crosses at most a few of them
+		int missiles = 0;
+		for (int j = 0; j < projectiles_.Size(); j++) {
+			if (projectiles_.GetType(j) != PLAYER_MISSILE || !projectiles_.IsAlive(j)) {
+				continue;
+			}
+			missiles++;
+			glm::vec3 a = projectiles_.GetPreviousPosition(j);
+			glm::vec3 b = projectiles_.GetPosition(j);
+			int first_column, first_row, last_column, last_row;
+			GetChunkCoordinates(glm::min(a, b), first_column, first_row);
+			GetChunkCoordinates(glm::max(a, b), last_column, last_row);
+			const WorldChunk *hit_chunk = NULL;
+			RayHit nearest;
+			for (int row = first_row; row <= last_row; row++) {
+				for (int column = first_column; column <= last_column; column++) {
+					int c = FindChunk(column, row);
+					RayHit ray_hit;
+					if (c >= 0 && attached_chunks_[c]->bvh.IntersectSegment(a, b, ray_hit) && (!hit_chunk || ray_hit.t < nearest.t)) {
+						hit_chunk = attached_chunks_[c];
+						nearest = ray_hit;
 					}
-					possibleIntersection = LinePlaneCollision(glm::vec3(0.0, 0.0, -1.0), box[6], heli->GetPosition(), prevpos);
-					if (possibleIntersection != NULL) {
-						if (possibleIntersection->z <= heli->GetPosition().z && possibleIntersection->z >= prevpos.z &&
-							possibleIntersection->y <= box[1].y && possibleIntersection->x <= box[1].x &&
-							possibleIntersection->y >= box[6].y && possibleIntersection->x >= box[6].x) {
-							ship_velocity[2] = 0.0;
-							heli->SetPosition(glm::vec3(heli->GetPosition().x, heli->GetPosition().y, box[6].z));
-							continue;
-						}
+				}
+			}
+			SweepHit hit;
+			if (hit_chunk && hit_chunk->boxes[nearest.item].Sweep(a, b, hit)) {
+				Contact contact = { MISSILE_BUILDING, INVALID_ENTITY, j, 0.0f, hit.point, hit.normal };
+				contacts_.Push(contact);
+			}
+		}
+
+		EngineCounters::Add(COUNTER_COLLISION_PAIRS, missiles);
+
+		// Bullets and enemy missiles are slower than a building is wide, so
+		// only their positions are tested. They are grouped by chunk and
+		// grid cell, and each group is tested as one batch against the
+		// boxes the chunk packed for its cell
+		projectile_cells_.clear();
+		for (int j = 0; j < projectiles_.Size(); j++) {
+			if (projectiles_.GetType(j) == PLAYER_MISSILE || !projectiles_.IsAlive(j)) {
+				continue;
+			}
+			glm::vec3 position = projectiles_.GetPosition(j);
+			int chunk = FindChunk(position);
+			int cell = chunk >= 0 ? attached_chunks_[chunk]->grid.GetCell(position) : -1;
+			if (cell >= 0) {
+				projectile_cells_.push_back(std::make_pair(((long long) chunk << 32) | cell, j));
+			}
+		}
+		std::sort(projectile_cells_.begin(), projectile_cells_.end());
+
+		blocked_hits_.assign(projectiles_.Size(), -1);
+		long long tested = 0;
+		size_t first = 0;
+		while (first < projectile_cells_.size()) {
+			long long key = projectile_cells_[first].first;
+			const WorldChunk *chunk = attached_chunks_[(int) (key >> 32)];
+			int cell = (int) (key & 0xFFFFFFFF);
+			size_t last = first;
+			cell_points_.Clear();
+			while (last < projectile_cells_.size() && projectile_cells_[last].first == key) {
+				cell_points_.Add(projectiles_.GetPosition(projectile_cells_[last].second));
+				last++;
+			}
+			int count;
+			const int *candidates = chunk->grid.GetItems(cell, count);
+			if (count > 0) {
+				cell_hits_.resize(cell_points_.Size());
+				PointBoxBatch::FindContainingBoxes(cell_points_, chunk->cell_boxes[cell], cell_hits_.data());
+				for (size_t k = first; k < last; k++) {
+					if (cell_hits_[k - first] >= 0) {
+						blocked_hits_[projectile_cells_[k].second] = candidates[cell_hits_[k - first]];
 					}
 				}
+				tested += (long long) cell_points_.Size() * count;
 			}
-	}
+			first = last;
+		}
+		EngineCounters::Add(COUNTER_COLLISION_PAIRS, tested);
 
+		// Contacts in projectile order, as the responses expect
+		for (int j = 0; j < projectiles_.Size(); j++) {
+			if (blocked_hits_[j] >= 0) {
+				Contact contact = { PROJECTILE_BLOCKED, INVALID_ENTITY, j, 0.0f, projectiles_.GetPosition(j), glm::vec3(0.0) };
+				contacts_.Push(contact);
+			}
+		}
+	}
 
 
-	void Game::MissileBuidlingCollision(SceneNode* collidedBuilding, SceneNode* miss, glm::vec3 prevpos) {
+	void Game::RespondToContacts(void) {
 
-		for (int sideCounter = 0; sideCounter < 6; sideCounter++)
-			if (collidedBuilding != NULL) {
-				glm::vec3* box = collidedBuilding->boundingBox;
-				glm::vec3* possibleIntersection = NULL;
-				for (int once = 0; once < 1; once++) {
-					possibleIntersection = LinePlaneCollision(glm::vec3(1.0, 0.0, 0.0), box[1], miss->GetPosition(), prevpos);
-					if (possibleIntersection != NULL) {
-						if (possibleIntersection->x >= miss->GetPosition().x && possibleIntersection->x <= prevpos.x &&
-							possibleIntersection->y <= box[1].y && possibleIntersection->z <= box[1].z &&
-							possibleIntersection->y >= box[6].y && possibleIntersection->z >= box[6].z) {
-							continue;
-						}
-					}
-					possibleIntersection = LinePlaneCollision(glm::vec3(-1.0, 0.0, 0.0), box[6], miss->GetPosition(), prevpos);
-					if (possibleIntersection != NULL) {
-						if (possibleIntersection->x <= miss->GetPosition().x && possibleIntersection->x >= prevpos.x &&
-							possibleIntersection->y <= box[1].y && possibleIntersection->z <= box[1].z &&
-							possibleIntersection->y >= box[6].y && possibleIntersection->z >= box[6].z) {
-							miss->SetPosition(glm::vec3(box[6].x, miss->GetPosition().y, miss->GetPosition().z));
-							continue;
-						}
-					}
-					possibleIntersection = LinePlaneCollision(glm::vec3(0.0, 1.0, 0.0), box[1], miss->GetPosition(), prevpos);
-					if (possibleIntersection != NULL) {
-						if (possibleIntersection->y >= miss->GetPosition().y && possibleIntersection->y <= prevpos.y &&
-							possibleIntersection->x <= box[1].x && possibleIntersection->z <= box[1].z &&
-							possibleIntersection->x >= box[6].x && possibleIntersection->z >= box[6].z) {
-							continue;
-						}
-					}
-					possibleIntersection = LinePlaneCollision(glm::vec3(0.0, -1.0, 0.0), box[6], miss->GetPosition(), prevpos);
-					if (possibleIntersection != NULL) {
-						if (possibleIntersection->y <= miss->GetPosition().y && possibleIntersection->y >= prevpos.x &&
-							possibleIntersection->x <= box[1].x && possibleIntersection->z <= box[1].z &&
-							possibleIntersection->x >= box[6].x && possibleIntersection->z >= box[6].z) {
-							continue;
-						}
-					}
-					possibleIntersection = LinePlaneCollision(glm::vec3(0.0, 0.0, 1.0), box[1], miss->GetPosition(), prevpos);
-					if (possibleIntersection != NULL) {
-						if (possibleIntersection->z >= miss->GetPosition().z && possibleIntersection->z <= prevpos.z &&
-							possibleIntersection->y <= box[1].y && possibleIntersection->x < box[1].x &&
-							possibleIntersection->y >= box[6].y && possibleIntersection->x > box[6].x) {
-							continue;
-						}
-					}
-					possibleIntersection = LinePlaneCollision(glm::vec3(0.0, 0.0, -1.0), box[6], miss->GetPosition(), prevpos);
-					if (possibleIntersection != NULL) {
-						if (possibleIntersection->z <= miss->GetPosition().z && possibleIntersection->z >= prevpos.z &&
-							possibleIntersection->y <= box[1].y && possibleIntersection->x <= box[1].x &&
-							possibleIntersection->y >= box[6].y && possibleIntersection->x >= box[6].x) {
-							continue;
-						}
-					}
-					possibleIntersection = NULL;
-				}
-				if (possibleIntersection != NULL) {
-					CreateExplosionSphere(*possibleIntersection);
-					miss->SetVisible(false);
-					return;
-				}
+		float now = (float) clock_.GetTime();
+		for (int i = 0; i < contacts_.Size(); i++) {
+			const Contact &contact = contacts_[i];
+			switch (contact.type) {
+				case HELI_BUILDING: HeliBuildingCollision(contact); break;
+				case MISSILE_BUILDING: MissileBuidlingCollision(contact); break;
+				case PROJECTILE_BLOCKED: projectiles_.Kill(contact.projectile); break;
+				case ENEMY_HIT: EnemyHitResponse(contact, now); break;
+				case HOSTAGE_REACHED: HostageReachedResponse(contact); break;
 			}
+		}
+		contacts_.Clear();
 	}
 
+
+	void Game::HeliBuildingCollision(const Contact &contact) {
+
+		// Slide: cancel the part of the motion that went into the face and
+		// keep the part along it
+		glm::vec3 position = heli->GetPosition();
+		position -= contact.normal * glm::dot(position - contact.point, contact.normal);
+		heli->SetPosition(position);
+	}
+
+
+	void Game::MissileBuidlingCollision(const Contact &contact) {
+
+		projectiles_.SetPosition(contact.projectile, contact.point);
+		projectiles_.Kill(contact.projectile);
+		CreateExplosionSphere(contact.point);
+	}
+
+
+	void Game::EnemyHitResponse(const Contact &contact, float now) {
+
+		// Hits landing on an enemy that is already dead are dropped
+		if (!registry_.GetHealths().Has(contact.entity)) {
+			return;
+		}
+		if (EntitySystems::ApplyDamage(registry_, contact.entity, contact.damage, now) <= 0.0f) {
+			KillEnemy(contact.entity);
+		}
+	}
+
+
+	void Game::KillEnemy(EntityId enemy) {
+
+		// The node is deleted at the end of the tick and its index reused
+		// under a new generation, so captors and mounts that still name
+		// the enemy find it dead
+		registry_.Destroy(enemy, true);
+		enemy_proximity_.Remove(enemy);
+	}
+
+
+	void Game::HostageReachedResponse(const Contact &contact) {
+
+		// Collected hostages follow the player and leave the grid
+		ComponentArray<Hostage> &hostages = registry_.GetHostages();
+		int j = hostages.GetIndex(contact.entity);
+		if (j < 0 || hostages[j].collected || !EntitySystems::IsHostageFree(registry_, hostages[j])) {
+			return;
+		}
+		hostages[j].collected = true;
+		hostages[j].trail->SetVisible(false);
+		hostages[j].laser = CreateHostageLaser();
+		// Slots go by the order of rescue, so they never move
+		rescued_hostages_++;
+		int slot = std::min(rescued_hostages_ * hostage_follow_spacing_g, max_hostage_trail_length_g) - 1;
+		if (slot >= (int) positions.size()) {
+			positions.resize(slot + 1, positions.back());
+		}
+		HostageFollow follow = { slot };
+		registry_.AddHostageFollow(contact.entity, follow);
+		hostage_proximity_.Remove(contact.entity);
+	}
+
+
 	void Game::ScrollWheelCallback(GLFWwindow* window, double xoffset, double yoffset) {
 		void* ptr = glfwGetWindowUserPointer(window);
 		Game *game = (Game *)ptr;
@@ -933,6 +1406,11 @@ namespace game {
 			glfwSetWindowShouldClose(window, true);
 		}
 
+		// Show or hide the performance counters
+		if (key == GLFW_KEY_F3 && action == GLFW_PRESS) {
+			game->hud_.Toggle();
+		}
+
 		// Ship control
 		float rot_factor(glm::pi<float>() / 180);
 		float trans_factor = 1.0;
@@ -1084,7 +1562,9 @@ namespace game {
 
 	Game::~Game() {
 
-		glfwTerminate();
+		if (window_) {
+			glfwTerminate();
+		}
 	}
 
 
@@ -1092,6 +1572,9 @@ namespace game {
 		if (enemyNumber == 0) {
 			heli = (Helicopter *)CreateTexturedHeliInstance("heli", "CubeMesh", "textureMaterial", "Root", "Camo");
 			heli->Scale(glm::vec3(0.1, 0.1, 0.1));
+			// The player moves its node directly, so it has no Transform
+			Health health = { 20.0f, 1.0f, -1.0f, true };
+			registry_.AddHealth(registry_.AddRenderable(heli), health);
 			body = (Helicopter *)CreateTexturedInstance("body", "HeliBodyMesh", "textureMaterial", "heli", "Camo");
 			body->Rotate(glm::angleAxis(3.14159f, glm::vec3(0.0, 1.0, 0.0)));
 
@@ -1173,7 +1656,7 @@ namespace game {
 
 	}
 
-	void Game::SetupHostage(std::string name, SceneNode** captors, glm::vec3 p) {
+	EntityId Game::SetupHostage(std::string name, const EntityId captors[4], glm::vec3 p) {
 
 		Helicopter* host = CreateHeliInstance(name, "SimpleSphereMesh", "ToonHeliMaterial", "Root");
 		host->SetBlending(false);
@@ -1206,159 +1689,177 @@ namespace game {
 		rot3->SetAngM(glm::quat(glm::angleAxis((float) 1.0, glm::vec3(1.0, 0.0, 0.0))));
 
 		host->SetHostage(true);
-		host->SetCaptors(captors);
 		host->SetFreedom(false);
 
 		//SPLINE
 		// Create particles
-		SceneNode *splineparticle = CreateInstance(name + "SplineParticles", "TorusParticles", "SplineMaterial", "Root");
+		// The trail hangs from the hostage only, so it goes with it
+		SceneNode *splineparticle = CreateInstance(name + "SplineParticles", "TorusParticles", "SplineMaterial", name);
 		// Set blending of particles
 		splineparticle->SetBlending(true);
 		splineparticle->SetParticle(true);
-		host->AddChild(splineparticle);
 
 		// Assign control points
 		Resource *cp = resman_.GetResource("ControlPoints");
 		splineparticle->AddShaderAttribute("control_point", Vec3Type, cp->GetSize(), cp->GetData());
 
 
-		hostages.push_back(host);
-		hostcollected.push_back(false);
-		childmissiles.push_back(std::deque<SceneNode*>());
+		EntityId entity = AddEntity(host);
+		Hostage hostage = { host, splineparticle, NULL, false, { captors[0], captors[1], captors[2], captors[3] } };
+		registry_.AddHostage(hostage);
+		hostage_proximity_.Insert(entity, p);
+		return entity;
 
 	}
 
 	void Game::SetupWorld() {
-		int sizeOfBuildingArea = sqrt((worldXmax - worldXmin) * (worldZmax - worldZmin));
-		bool** table = (bool**)calloc(sizeof(bool*), worldXmax);
-		for (int i = 0; i < worldXmax; i++) {
-			table[i] = (bool*)calloc(sizeof(bool), worldZmax);
-		}
-		//test = CreateInstance("test", "CubeMesh", "ToonRingMaterial", "Root");
-
-		//test->SetPosition(glm::vec3(0.0, 0.0, 0.0));
-
-		SceneNode* ground = CreateTexturedInstance("cubeg", "CubeMesh", "textureMaterial", "Root","Ground");
-		ground->SetPosition(glm::vec3(worldXmax / 2, -5, worldZmax / 2));
-		ground->Scale(glm::vec3(worldXmax, 10, worldZmax));
-
-		SceneNode* b;
-		std::stack<bool *> occupiedArea;
-		glm::vec3* vertices;
-		glm::vec3 scaleFactor;
-		for (int i = 0; i < sizeOfBuildingArea / 5; i++) {
-			b = CreateTexturedInstance("EnvironmentCube" + std::to_string(i), "CubeMesh", "textureMaterial", "Root", "Building");
-			scaleFactor = glm::vec3((float)(4.0 + ((float)(rand() % 20))), (float)(4.0 + ((float)(rand() % 20))), (float)(4.0 + ((float)(rand() % 20))));
-			float factor = (float)(1.0 + ((float)(rand() % 20)));
-			b->SetPosition(glm::vec3((float)(rand() % (worldXmax - 50)) + 50.0f, scaleFactor.y / 2.0f, (float)(rand() % (worldZmax - 50)) + 50.0f));
-			bool check = false;
-			int patience = 0;
-			bool yes = true;
-			while (yes) {
-				for (int k = 0 - (int)(scaleFactor.x / 2.0f); k < (int)scaleFactor.x; k++) {
-					for (int j = 0 - (int)(scaleFactor.z / 2.0f); j < (int)scaleFactor.z; j++) {
-						int x = (int)b->GetPosition().x + k;
-						int z = (int)b->GetPosition().z + j;
-						if (x < worldXmax && z < worldZmax && x >= worldXmin && z >= worldZmin)
-							if (table[x][z] == true)
-								check = true;
-							else
-								occupiedArea.push(&table[x][z]);
-					}
-					if (check)
-						break;
-				}
-				if (check) {
-					while (occupiedArea.size() > 0) {
-						occupiedArea.pop();
-					}
-					if ((patience % 30) == 29) {
-						scaleFactor = glm::vec3((float)(1.0 + ((float)(rand() % 20))), (float)(1.0 + ((float)(rand() % 20))), (float)(1.0 + ((float)(rand() % 20))));
-					}
-					else
-						patience++;
-					b->SetPosition(glm::vec3((float)(rand() % 300), scaleFactor.y / 2.0f, (float)(rand() % 300)));
-					check = false;
-				}
-				else
-					yes = false;
-			}
-			while (occupiedArea.size() > 0) {
-				*occupiedArea.top() = true;
-				occupiedArea.pop();
-			}
-			b->Scale(scaleFactor);
-
-			vertices = new glm::vec3[8];
-			glm::vec3 top = glm::vec3(0.0, 1.0, 0.0) * (scaleFactor.y / 2.0f);
-			glm::vec3 bot = glm::vec3(0.0, 1.0, 0.0) * (scaleFactor.y / 2.0f) * -1.0f;
-			glm::vec3 left = glm::vec3(1.0, 0.0, 0.0) * (scaleFactor.x / 2.0f);
-			glm::vec3 right = glm::vec3(1.0, 0.0, 0.0) * (scaleFactor.x / 2.0f) * -1.0f;
-			glm::vec3 front = glm::vec3(0.0, 0.0, 1.0) * (scaleFactor.z / 2.0f);
-			glm::vec3 back = glm::vec3(0.0, 0.0, 1.0) * (scaleFactor.z / 2.0f) * -1.0f;
-
-			vertices[0] = b->GetPosition() + top + front + right;
-			vertices[1] = b->GetPosition() + top + front + left;
-			vertices[2] = b->GetPosition() + top + back + right;
-			vertices[3] = b->GetPosition() + top + back + left;
-			vertices[4] = b->GetPosition() + bot + front + right;
-			vertices[5] = b->GetPosition() + bot + front + left;
-			vertices[6] = b->GetPosition() + bot + back + right;
-			vertices[7] = b->GetPosition() + bot + back + left;
-
-			for (int roofCorners = 0; roofCorners < 4; roofCorners++)
-				spawnPoints.push_back(vertices);
-
-			b->SetBoundingBox(vertices);
-			if (i < 0)
-				for (int a = 0; a < 8; a++) {
-					std::stringstream ss;
-					ss << i;
-					std::string index = ss.str();
-					std::string name = "CornerInstance" + index;
-					SceneNode* sphere = CreateAsteroidInstance(name, "SimpleSphereMesh", "ObjectMaterial");
-					sphere->SetPosition(vertices[a]);
-					sphere->SetScale(glm::vec3(1.0, 1.0, 1.0) * 1.5f);
-					/*
-					if (a % 2 == 1) {
-					sphere->SetOrientation(glm::normalize(glm::angleAxis(glm::pi<float>()*((float)rand() / RAND_MAX), glm::vec3(((float)rand() / RAND_MAX), ((float)rand() / RAND_MAX), ((float)rand() / RAND_MAX)))));
-					sphere->SetAngM(glm::normalize(glm::angleAxis(0.05f*glm::pi<float>()*((float)rand() / RAND_MAX), glm::vec3(((float)rand() / RAND_MAX), ((float)rand() / RAND_MAX), ((float)rand() / RAND_MAX)))));
-					}
-					*/
-					scene_.GetNode("Root")->AddChild(sphere);
+
+		// Buildings come from the chunk streamer, which lays them out from
+		// the seed and keeps a margin free along the low edges where the
+		// player starts
+		world_streamer_.SetSeed(seed_);
+		world_streamer_.SetWorld(glm::vec2(worldXmin, worldZmin), glm::vec2(worldXmax, worldZmax));
+		world_streamer_.SetChunkSize(world_chunk_size_g);
+		world_streamer_.SetRadius(world_stream_radius_g);
+		world_streamer_.SetSpacing(building_spacing_g);
+		world_streamer_.SetCityArea(glm::vec2(worldXmin, worldZmin) + city_margin_g, glm::vec2(worldXmax, worldZmax));
+		StreamWorld();
+	}
+
+
+	void Game::StreamWorld(void) {
+
+		std::vector<WorldChunk *> attached;
+		std::vector<WorldChunk *> detached;
+		world_streamer_.Update(heli->GetPosition(), attached, detached);
+		for (size_t i = 0; i < detached.size(); i++) {
+			DetachChunk(detached[i]);
+		}
+		for (size_t i = 0; i < attached.size(); i++) {
+			AttachChunk(attached[i]);
+		}
+		if (!attached.empty() || !detached.empty()) {
+			RefreshAttachedChunks();
+		}
+	}
+
+
+	void Game::AttachChunk(WorldChunk *chunk) {
+
+		std::stringstream ss;
+		ss << "Chunk" << chunk->column << "_" << chunk->row;
+		std::string name = ss.str();
+		SceneNode *root = scene_.GetNode(root_name_g);
+
+		// The floor slab under the chunk, with its top at y = 0
+		glm::vec2 center = (chunk->min + chunk->max) * 0.5f;
+		glm::vec2 extent = chunk->max - chunk->min;
+		chunk->ground = CreateTexturedInstance(name + "Ground", "CubeMesh", "textureMaterial", "Ground");
+		chunk->ground->SetPosition(glm::vec3(center.x, -5.0, center.y));
+		chunk->ground->Scale(glm::vec3(extent.x, 10.0, extent.y));
+		root->AddChild(chunk->ground);
+
+		// All the buildings of the chunk are one draw call
+		if (!chunk->lots.empty()) {
+			GLuint vbo = resman_.CreateBuffer(GL_ARRAY_BUFFER, chunk->vertices.size() * sizeof(GLfloat), chunk->vertices.data());
+			chunk->geometry = new Resource(PointSet, name, vbo, (GLsizei) (chunk->vertices.size() / 11));
+			chunk->buildings = new SceneNode(name, chunk->geometry, resman_.GetResource("textureMaterial"), resman_.GetResource("Building"));
+			root->AddChild(chunk->buildings);
+		}
+
+		// The GPU has the vertices now
+		std::vector<float>().swap(chunk->vertices);
+	}
+
+
+	void Game::DetachChunk(WorldChunk *chunk) {
+
+		EvictChunkEntities(chunk);
+
+		// The nodes leave the scene before their buffer is deleted, so
+		// nothing draws them; they are deleted with the garbage
+		SceneNode *root = scene_.GetNode(root_name_g);
+		root->RemoveChild(chunk->ground);
+		registry_.Destroy(chunk->ground, true);
+		if (chunk->buildings) {
+			root->RemoveChild(chunk->buildings);
+			registry_.Destroy(chunk->buildings, true);
+			resman_.DeleteBuffer(chunk->geometry->GetArrayBuffer());
+			delete chunk->geometry;
+		}
+		world_streamer_.Release(chunk);
+	}
+
+
+	void Game::EvictChunkEntities(WorldChunk *chunk) {
+
+		// Hostages already following the player stay
+		ComponentArray<Hostage> &hostages = registry_.GetHostages();
+		for (size_t i = 0; i < chunk->entities.size(); i++) {
+			EntityId entity = chunk->entities[i];
+			Hostage *hostage = hostages.Get(entity);
+			if (hostage && hostage->collected) {
+				continue;
+			}
+			if (registry_.GetDamageables().Has(entity)) {
+				KillEnemy(entity);
+			}
+			else if (registry_.IsAlive(entity)) {
+				hostage_proximity_.Remove(entity);
+				registry_.Destroy(entity, true);
+			}
+		}
+		chunk->entities.clear();
+	}
+
+
+	void Game::RefreshAttachedChunks(void) {
+
+		// Each chunk keeps its own collision structures, so only the
+		// lists routing queries to them are redone
+		attached_chunks_.clear();
+		world_streamer_.GetAttached(attached_chunks_);
+		chunk_lookup_.clear();
+		chunk_occluders_.clear();
+		spawnPoints.clear();
+		for (size_t c = 0; c < attached_chunks_.size(); c++) {
+			WorldChunk *chunk = attached_chunks_[c];
+			chunk_lookup_[ChunkStreamer::GetKey(chunk->column, chunk->row)] = (int) c;
+			chunk_occluders_.push_back(&chunk->bvh);
+			for (size_t i = 0; i < chunk->lots.size(); i++) {
+				for (int roofCorners = 0; roofCorners < 4; roofCorners++) {
+					spawnPoints.push_back(&chunk->corners[8 * i]);
 				}
-			buildings.push_back(b);
+			}
 		}
+		laser_caster_.SetOccluders(chunk_occluders_);
+	}
+
+
+	void Game::GetChunkCoordinates(glm::vec3 point, int &column, int &row) const {
+
+		column = (int) std::floor((point.x - worldXmin) / world_chunk_size_g);
+		row = (int) std::floor((point.z - worldZmin) / world_chunk_size_g);
+	}
 
-		vertices = new glm::vec3[8];
-		glm::vec3 top = glm::vec3(0.0, 1.0, 0.0) * (0.0f / 2.0f);
-		glm::vec3 bot = glm::vec3(0.0, 1.0, 0.0) * (-10.0f / 2.0f) * -1.0f;
-		glm::vec3 left = glm::vec3(1.0, 0.0, 0.0) * ((float)worldXmax);
-		glm::vec3 right = glm::vec3(1.0, 0.0, 0.0) * ((float)worldXmin) * -1.0f;
-		glm::vec3 front = glm::vec3(0.0, 0.0, 1.0) * ((float)worldZmax);
-		glm::vec3 back = glm::vec3(0.0, 0.0, 1.0) * ((float)worldZmax) * -1.0f;
 
-		vertices[0] = ground->GetPosition() + top + front + right;
-		vertices[1] = ground->GetPosition() + top + front + left;
-		vertices[2] = ground->GetPosition() + top + back + right;
-		vertices[3] = ground->GetPosition() + top + back + left;
-		vertices[4] = ground->GetPosition() + bot + front + right;
-		vertices[5] = ground->GetPosition() + bot + front + left;
-		vertices[6] = ground->GetPosition() + bot + back + right;
-		vertices[7] = ground->GetPosition() + bot + back + left;
-		ground->SetBoundingBox(vertices);
-		buildings.push_back(ground);
+	int Game::FindChunk(int column, int row) const {
+
+		std::unordered_map<uint64_t, int>::const_iterator it = chunk_lookup_.find(ChunkStreamer::GetKey(column, row));
+		return it == chunk_lookup_.end() ? -1 : it->second;
+	}
 
-		for (int i = 0; i < 300; i++)
-			delete(table[i]);
-		delete(table);
 
+	int Game::FindChunk(glm::vec3 point) const {
 
+		int column, row;
+		GetChunkCoordinates(point, column, row);
+		return FindChunk(column, row);
 	}
 
 	void Game::SetupEnemies() {
 
-		int location = rand() % spawnPoints.size();
+		int location = spawn_random_.NextInt((int) spawnPoints.size());
 
 		for (int i = 0; i < 4; i++) {
 
@@ -1378,8 +1879,8 @@ namespace game {
 			(*bad_child)->SetScale(glm::vec3(1.0, 1.0, 1.0));
 
 			spawnPoints.erase(spawnPoints.begin() + location);
-			scene_.GetNode("Root")->AddChild(bad_dude);
-			enemies.push_back(bad_dude);
+			scene_.GetNode(root_name_g)->AddChild(bad_dude);
+			AddEnemyEntity(bad_dude);
 		}
 		SpawnTank(glm::vec3(30.0, 0.0, 30.0));
 
@@ -1389,13 +1890,39 @@ namespace game {
 
 	void Game::SpawnRandomHostage() {
 
+		HostagePlacement placement;
+		if (PickHostagePlacement(placement)) {
+			SpawnHostage(placement);
+		}
+	}
+
+
+	bool Game::PickHostagePlacement(HostagePlacement &placement) {
+
+		// No building is near enough to hold a hostage
+		if (spawnPoints.empty()) {
+			return false;
+		}
+		int location = spawn_random_.NextInt((int) spawnPoints.size());
+		const glm::vec3 *roof = spawnPoints[location];
+		placement.location = location;
+		for (int i = 0; i < 4; i++) {
+			placement.captors[i] = roof[i];
+		}
+		placement.hostage = glm::vec3((roof[0].x + roof[3].x) / 2.0f, roof[0].y + 1.0, (roof[0].z + roof[3].z) / 2.0);
+		return true;
+	}
+
+
+	void Game::SpawnHostage(const HostagePlacement &placement) {
 
-		int location = rand() % spawnPoints.size();
-		std::string unique;
 		std::stringstream sss;
-		sss << location;
+		sss << placement.location;
 
-		SceneNode** captors = (SceneNode**)calloc(sizeof(SceneNode*), 4);
+		// The hostage and its captors stand on a roof, and go when the
+		// chunk of the roof is detached
+		int chunk = FindChunk(placement.hostage);
+		EntityId captors[4];
 
 		for (int i = 0; i < 4; i++) {
 
@@ -1406,21 +1933,22 @@ namespace game {
 
 			Enemy* bad_dude = CreateEnemyInstance(name, "LaserMesh", "ObjectMaterial", 0);
 
-			bad_dude->SetPosition(spawnPoints[location][i]);
+			bad_dude->SetPosition(placement.captors[i]);
 			bad_dude->SetScale(glm::vec3(3.0, 3.0, 3.0));
 			std::vector<SceneNode *>::const_iterator bad_child = bad_dude->children_begin();
 			(*bad_child)->SetPosition(glm::vec3(0.0, 0.0, 0.0));
 			(*bad_child)->SetScale(glm::vec3(1.0, 1.0, 1.0));
 
-			//spawnPoints.erase(spawnPoints.begin() + location);
-			scene_.GetNode("Root")->AddChild(bad_dude);
-			captors[i] = bad_dude;
-			enemies.push_back(bad_dude);
+			scene_.GetNode(root_name_g)->AddChild(bad_dude);
+			captors[i] = AddEnemyEntity(bad_dude);
 		}
 
-		glm::vec3 hostageSpawn = glm::vec3((spawnPoints[location][0].x + spawnPoints[location][3].x) / 2.0f, spawnPoints[location][0].y + 1.0, (spawnPoints[location][0].z + spawnPoints[location][3].z) / 2.0);
-
-		SetupHostage("Hostage" + sss.str(), captors, hostageSpawn);
+		EntityId hostage = SetupHostage("Hostage" + sss.str(), captors, placement.hostage);
+		if (chunk >= 0) {
+			std::vector<EntityId> &entities = attached_chunks_[chunk]->entities;
+			entities.insert(entities.end(), captors, captors + 4);
+			entities.push_back(hostage);
+		}
 	}
 
 
@@ -1434,10 +1962,12 @@ namespace game {
 			Enemy* bad_dude;
 			SetupHelicopter(i, &bad_dude);
 
-			bad_dude->SetPosition(glm::vec3(500.0 + ((float)(rand() % 200)), 60.0, 500.0 + ((float)(rand() % 200))));
+			float x = (float) spawn_random_.NextInt(200);
+			float z = (float) spawn_random_.NextInt(200);
+			bad_dude->SetPosition(glm::vec3(500.0 + x, 60.0, 500.0 + z));
 			bad_dude->SetScale(glm::vec3(0.1, 0.1, 0.1));
 
-			enemies.push_back(bad_dude);
+			AddEnemyEntity(bad_dude);
 		}
 	}
 
@@ -1455,7 +1985,7 @@ namespace game {
 			bad_tank->SetScale(glm::vec3(0.1, 0.1, 0.1));
 
 
-			enemies.push_back(bad_tank);
+			EntityId tank = AddEnemyEntity(bad_tank);
 
 			Enemy* bad_dude = CreateEnemyInstance(name, "LaserMesh", "ObjectMaterial", 0);
 
@@ -1465,12 +1995,100 @@ namespace game {
 			(*bad_child)->SetPosition(glm::vec3(0.0, 0.0, 0.0));
 			(*bad_child)->SetScale(glm::vec3(1.0, 1.0, 1.0));
 
-			bad_dude->SetParentEnemy(bad_tank);
-			enemies.push_back(bad_dude);
+			scene_.GetNode(root_name_g)->AddChild(bad_dude);
+			AddEnemyEntity(bad_dude, tank);
+
+
+		}
+
+	}
+
+	void Game::SpawnEnemies(int count) {
+
+		extra_enemies_ += count;
+		SceneNode *root = scene_.GetNode(root_name_g);
+		for (int i = 0; i < count; i++) {
+
+			std::stringstream ss;
+			ss << "SpawnedEnemy" << i;
+			float x = spawn_random_.NextFloat((float) worldXmin, (float) worldXmax);
+			float z = spawn_random_.NextFloat((float) worldZmin, (float) worldZmax);
+
+			Enemy* bad_dude;
+			if (i % spawned_flyer_ratio_g == 0) {
+				bad_dude = CreateEnemyInstance(ss.str(), "CylinderMesh", "ObjectMaterial", Enemy::FLYING);
+				bad_dude->SetPosition(glm::vec3(x, spawned_flyer_height_g, z));
+			} else {
+				bad_dude = CreateEnemyInstance(ss.str(), "LaserMesh", "ObjectMaterial", Enemy::STATIONARY);
+				bad_dude->SetPosition(glm::vec3(x, 0.0, z));
+				bad_dude->SetScale(glm::vec3(3.0, 3.0, 3.0));
+			}
+			root->AddChild(bad_dude);
+			AddEnemyEntity(bad_dude);
+		}
+	}
+
+	void Game::RescueHostages(void) {
+
+		// The captors go the way of ones shot down, then each hostage is
+		// reached as if the player had flown to it
+		ComponentArray<Hostage> &hostages = registry_.GetHostages();
+		for (int i = 0; i < hostages.Size(); i++) {
+			if (hostages[i].collected) {
+				continue;
+			}
+			for (int c = 0; c < 4; c++) {
+				if (registry_.IsAlive(hostages[i].captors[c])) {
+					KillEnemy(hostages[i].captors[c]);
+				}
+			}
+			Contact contact = { HOSTAGE_REACHED, hostages.GetEntity(i), -1, 0.0f, heli->GetPosition(), glm::vec3(0.0) };
+			contacts_.Push(contact);
+		}
+		RespondToContacts();
+	}
+
+	EntityId Game::AddEntity(SceneNode *node) {
+
+		EntityId entity = registry_.AddRenderable(node);
+		Transform transform = { node->GetPosition(), node->GetOrientation() };
+		registry_.AddTransform(entity, transform);
+		return entity;
+	}
+
+	EntityId Game::AddEnemyEntity(Enemy *enemy, EntityId mount) {
 
+		EntityId entity = AddEntity(enemy);
+		Damageable damageable = { enemy->GetType() };
+		registry_.AddDamageable(entity, damageable);
 
+		Health health = { 5.0f, 1.0f, -1.0f, false };
+		switch (enemy->GetType()) {
+			case Enemy::STATIONARY: health.health = 10.0f; break;
+			case Enemy::MOVING: health.health = 5.0f; break;
+			case Enemy::FLYING: health.health = 3.0f; break;
 		}
+		registry_.AddHealth(entity, health);
 
+		// Tanks do not shoot; their turret is a separate entity mounted on them
+		if (enemy->GetType() != Enemy::MOVING) {
+			Turret turret = { enemy_agro_range_g, enemy_fire_period_g, 0.0f, 1, 0, false, mount, tank_turret_offset_g };
+			if (enemy->GetType() == Enemy::FLYING) {
+				turret.burst = 5;
+				Flyer flyer = { enemy_flyer_speed_g };
+				registry_.AddFlyer(entity, flyer);
+			}
+			registry_.AddTurret(entity, turret);
+		}
+
+		// Mounted turrets sit at a fixed offset from their mount, which
+		// does not move
+		glm::vec3 position = enemy->GetPosition();
+		if (mount != INVALID_ENTITY) {
+			position = registry_.GetTransforms().Get(mount)->position + tank_turret_offset_g;
+		}
+		enemy_proximity_.Insert(entity, position);
+		return entity;
 	}
 
 	Enemy* Game::CreateEnemyInstance(std::string entity_name, std::string object_name, std::string material_name, int enemyType) {
@@ -1496,7 +2114,7 @@ namespace game {
 				throw(GameException(std::string("Could not find resource \"") + material_name + std::string("\"")));
 			}
 
-			Enemy* enemy_temp = new Enemy(enemyType, entity_name, geom, resman_.GetResource("textureMaterial"), resman_.GetResource("Metal"), (SceneNode*)heli, &resman_);
+			Enemy* enemy_temp = new Enemy(enemyType, entity_name, geom, resman_.GetResource("textureMaterial"), resman_.GetResource("Metal"));
 			enemy_temp->AddChild(new SceneNode(entity_name + "(Base)", geom2, mat2, 0));
 			return enemy_temp;
 		}
@@ -1519,7 +2137,7 @@ namespace game {
 				throw(GameException(std::string("Could not find resource \"") + material_name + std::string("\"")));
 			}
 
-			Enemy* enemy_temp = new Enemy(enemyType, entity_name, geom, mat, 0, (SceneNode*)heli, &resman_);
+			Enemy* enemy_temp = new Enemy(enemyType, entity_name, geom, mat, 0);
 			enemy_temp->AddChild(new SceneNode(entity_name + "(Base)", geom2, mat2, 0));
 			return enemy_temp;
 		}
@@ -1542,7 +2160,7 @@ namespace game {
 				throw(GameException(std::string("Could not find resource \"") + material_name + std::string("\"")));
 			}
 
-			Enemy* enemy_temp = new Enemy(enemyType, entity_name, geom, mat, 0, (SceneNode*)heli, &resman_);
+			Enemy* enemy_temp = new Enemy(enemyType, entity_name, geom, mat, 0);
 			enemy_temp->AddChild(new SceneNode(entity_name + "(Base)", geom2, mat2, 0));
 			return enemy_temp;
 		}
@@ -1566,117 +2184,105 @@ namespace game {
 
 		// Create asteroid instance
 		Asteroid *ast = new Asteroid(entity_name, geom, mat);
-		collidables.push_back(ast);
 		return ast;
 	}
 
-	void Game::checkForCollisions(GLFWwindow* window, bool laser) {
-
-		void* ptr = glfwGetWindowUserPointer(window);
-		Game *game = (Game *)ptr;
-
-		glm::vec3 a, c, f, l, ma, mp, d, s, hp, ha;
-		float t;
-
-		s = heli->GetPosition();//(lazerref->GetPosition() - (this->camera_.GetForward() * 45.0f));
-								//PrintVec3(heli->GetPosition());
-								//PrintVec3(camera_.GetPosition());
-		d = glm::normalize(heli->GetForward());
-		for (int j = 0; j < enemies.size(); j++) {
-			a = enemies[j]->GetPosition();
-
-			if (laser) {
-
-				//s = starting point
-				//a = center of asteroids
-				//l = unit vector in direction of asteroid
-				//d = unit vector in cam direction
-
-				l = glm::normalize(s - a);
-				float theta = acos(glm::dot(l, d));
-
-				float test = tan(theta) * glm::length(s - a);
-
-				//child lasers
-				for (int i = 0; i < childlasers.size(); ++i) {
-					if (hostcollected[i]) {
-						l = glm::normalize(hostages[i]->GetPosition() - a);
-						float theta = acos(glm::dot(l, d));
-
-						test = tan(theta) * glm::length(hostages[i]->GetPosition() - a);
-					}
-				}
-
-				if (test < 0.0 && test > -1.0) {
-					if (enemies[j]->LoseHealth(2.0f) <= 0.0f)
-						enemies[j]->SetVisible(false);
+	void Game::checkForCollisions(bool laser) {
+
+		ComponentArray<Damageable> &enemies = registry_.GetDamageables();
+		ComponentArray<Explosion> &explosions = registry_.GetExplosions();
+		ComponentArray<Hostage> &hostages = registry_.GetHostages();
+		ComponentArray<Transform> &transforms = registry_.GetTransforms();
+
+		if (laser) {
+			// Every laser is a ray from its shooter along the drawn beam.
+			// It damages the first enemy it meets, unless a building is
+			// in the way
+			laser_targets_.resize(enemies.Size());
+			for (int j = 0; j < enemies.Size(); j++) {
+				glm::vec3 a = transforms.Get(enemies.GetEntity(j))->position;
+				laser_targets_[j] = AABB(a - glm::vec3(enemy_hit_radius_g), a + glm::vec3(enemy_hit_radius_g));
+			}
+			laser_caster_.SetTargets(laser_targets_);
+			laser_caster_.AddRay(heli->GetPosition(), heli->GetOrientation() * laser_axis_g, laser_range_g);
+			for (int i = 0; i < hostages.Size(); ++i) {
+				if (hostages[i].collected) {
+					laser_caster_.AddRay(hostages[i].node->GetPosition(), hostages[i].node->GetOrientation() * laser_axis_g, laser_range_g);
 				}
-
 			}
-			else {
-				for (int z = 0; z < missiles.size(); z++) {
-
-					if (glm::length(missiles[z]->GetPosition() - enemies[j]->GetPosition()) <= 2.0) {
-						if (enemies[j]->LoseHealth(1.0f) <= 0.0f)
-							enemies[j]->SetVisible(false);
-					}
-
-
-					if (missiles.size() > 100) {
-						missiles[z]->SetVisible(false);
-						missiles.pop_front();
-					}
+			laser_caster_.Cast(jobs_);
+			EngineCounters::Add(COUNTER_COLLISION_PAIRS, (long long) laser_caster_.GetRayCount() * enemies.Size());
+
+			for (int r = 0; r < laser_caster_.GetRayCount(); r++) {
+				const RayHit &hit = laser_caster_.GetHit(r);
+				if (hit.item >= 0) {
+					Contact contact = { ENEMY_HIT, enemies.GetEntity(hit.item), -1, 2.0f, hit.point, glm::vec3(0.0) };
+					contacts_.Push(contact);
 				}
-				for (int n = 0; n < childmissiles.size(); n++) {
-					if (hostcollected[n]) {
-						for (int k = 0; k < childmissiles[n].size(); k++) {
-
-
-							if (glm::length(childmissiles[n][k]->GetPosition() - enemies[j]->GetPosition()) <= 2.0) {
-								if (enemies[j]->LoseHealth(1.0f) <= 0.0f)
-									enemies[j]->SetVisible(false);
-							}
-							if (childmissiles[n].size() > 5) {
-								childmissiles[n][k]->SetVisible(false);
-								childmissiles[n].pop_front();
-							}
+			}
+		}
+		else {
+			// Each bullet only looks at the enemies the proximity grid
+			// finds near it. Bullets are split into fixed ranges with a
+			// queue each, so contacts come out in the same order every run
+			int batches = (projectiles_.Size() + bullet_contact_grain_g - 1) / bullet_contact_grain_g;
+			if ((int) bullet_contacts_.size() < batches) {
+				bullet_contacts_.resize(batches);
+			}
+			jobs_.ParallelFor(batches, 1, [&](int begin, int end) {
+				std::vector<EntityId> nearby;
+				int tested = 0;
+				for (int b = begin; b < end; b++) {
+					bullet_contacts_[b].Clear();
+					int last = std::min(projectiles_.Size(), (b + 1) * bullet_contact_grain_g);
+					for (int z = b * bullet_contact_grain_g; z < last; z++) {
+						ProjectileType type = projectiles_.GetType(z);
+						if ((type != PLAYER_BULLET && type != CHILD_BULLET) || !projectiles_.IsAlive(z)) {
+							continue;
 						}
+						tested += QueueEnemyHits(bullet_contacts_[b], projectiles_.GetPosition(z), bullet_hit_radius_g, z, 1.0f, nearby);
 					}
 				}
-
-				for (int h = 0; h < explosionSpheres.size(); h++) {
-					if (glm::length(explosionSpheres[h]->GetPosition() - enemies[j]->GetPosition()) < (1.0f + glm::length(explosionSpheres[h]->GetScale().y))) {
-						if (enemies[j]->LoseHealth(5.0f) <= 0.0f)
-							enemies[j]->SetVisible(false);
-					}
-				}
-
+				EngineCounters::Add(COUNTER_COLLISION_PAIRS, tested);
+			});
+			for (int b = 0; b < batches; b++) {
+				contacts_.Append(bullet_contacts_[b]);
 			}
 
-		}
-		for (int j = 0; j < hostages.size(); j++) {
-
-			if (!hostcollected[j]) {
-
-				if (glm::length(hostages[j]->GetPosition() - heli->GetPosition()) < 2.0f && hostages[j]->GetFreedom())
-					hostcollected[j] = true;
+			int tested = 0;
+			for (int h = 0; h < explosions.Size(); h++) {
+				SceneNode *sphere = explosions[h].node;
+				tested += QueueEnemyHits(contacts_, sphere->GetPosition(), 1.0f + std::abs(sphere->GetScale().y), -1, 5.0f, explosion_targets_);
 			}
+			EngineCounters::Add(COUNTER_COLLISION_PAIRS, tested);
 		}
-		for (int j = 0; j < enemies.size(); j++) {
-			if (glm::length(enemies[j]->GetPosition() - heli->GetPosition()) <= 150.0f) {
-				enemies[j]->SetAgro(true);
-			}
-			else {
-				enemies[j]->SetAgro(false);
-			}
 
+		// Only hostages waiting near the player can be picked up
+		nearby_hostages_.clear();
+		EngineCounters::Add(COUNTER_COLLISION_PAIRS, hostage_proximity_.Query(heli->GetPosition(), hostage_pickup_radius_g, nearby_hostages_));
+		for (size_t i = 0; i < nearby_hostages_.size(); i++) {
+			Contact contact = { HOSTAGE_REACHED, nearby_hostages_[i], -1, 0.0f, heli->GetPosition(), glm::vec3(0.0) };
+			contacts_.Push(contact);
 		}
-
 	}
 
 
 
 
+	int Game::QueueEnemyHits(ContactQueue &queue, glm::vec3 center, float radius, int projectile, float damage, std::vector<EntityId> &nearby) const {
+
+		// Damage is applied later from the queue, in order, so a hit on an
+		// enemy that an earlier hit killed is dropped there
+		nearby.clear();
+		int tested = enemy_proximity_.Query(center, radius, nearby);
+		for (size_t i = 0; i < nearby.size(); i++) {
+			Contact contact = { ENEMY_HIT, nearby[i], projectile, damage, center, glm::vec3(0.0) };
+			queue.Push(contact);
+		}
+		return tested;
+	}
+
+
 	void Game::CreateLaserInstance(std::string entity_name, std::string object_name, std::string material_name) {
 
 		// Get resources
@@ -1693,151 +2299,46 @@ namespace game {
 		// Create Laser instance
 		SceneNode *laser = new SceneNode(entity_name, geom, mat, 0);
 		laser->Scale(glm::vec3(1.0, 1.0, 40));
-		scene_.GetNode("Root")->AddChild(laser);
+		scene_.GetNode(root_name_g)->AddChild(laser);
 		float off = 0.0;
 		lazerref = laser;
 
-		for (int i = 0; i < hostages.size(); ++i) {
-			SceneNode *laser = new SceneNode(entity_name, geom, mat, 0);
-			laser->Scale(glm::vec3(1.0, 1.0, 40));
-			scene_.GetNode("Root")->AddChild(laser);
-			float off = 0.0;
-			childlasers.push_back(laser);
-		}
-
 	}
 
-	void Game::CreateMissileInstance(std::string entity_name, std::string object_name, std::string material_name) {
-
-		// Get resources
-		Resource *geom = resman_.GetResource(object_name);
-		if (!geom) {
-			throw(GameException(std::string("Could not find resource \"") + object_name + std::string("\"")));
-		}
-
-		Resource *mat = resman_.GetResource(material_name);
-		if (!mat) {
-			throw(GameException(std::string("Could not find resource \"") + material_name + std::string("\"")));
-		}
-
 
-		// Create Missile instance
-		SceneNode *missile = new SceneNode(entity_name, geom, mat, 0);
-		SceneNode *particles = new SceneNode(entity_name + " particles", resman_.GetResource("MissileParticles"), resman_.GetResource("MissileMaterial"), resman_.GetResource("Fire"));
+	SceneNode *Game::CreateHostageLaser(void) {
 
-		missile->SetVisible(true);
-		//particles->Scale(glm::vec3(10.0));
-		particles->SetParticle(true);
-		particles->SetBlending(true);
-		particles->SetVisible(true);
-		missile->AddChild(particles);
-
-		missile->SetPosition(this->heli->GetPosition());
-		missile->SetOrientation(this->camera_.GetOrientation());
-		missile->SetScale(glm::vec3(2.0));
-		scene_.GetNode("Root")->AddChild(missile, true);
-		float off = 0.0;
-		missile->direction = camera_.GetForward();
-		explodingMissiles.push_back(missile);
-
-		// Create Missiles for children
-		/*
-		for (int i = 0; i < childmissiles.size(); i++) {
-			if (hostcollected[i]) {
-				SceneNode *childmis = new SceneNode(entity_name, geom, mat, resman_.GetResource(""));
-				SceneNode *childpart = new SceneNode(entity_name + " particles", resman_.GetResource("MissileParticles"), resman_.GetResource("MissileMaterial"), resman_.GetResource("Fire"));
-
-				childmis->SetVisible(true);
-				//childpart->Scale(glm::vec3(10.0));
-				childpart->SetParticle(true);
-				childpart->SetBlending(true);
-				childpart->SetVisible(true);
-				childmis->AddChild(childpart);
-				childmis->SetScale(glm::vec3(2.0));
-
-				childmis->SetPosition(hostages[i]->GetPosition());
-				childmis->SetOrientation(this->camera_.GetOrientation());
-
-				scene_.GetNode("Root")->AddChild(childmis, true);
-				float off = 0.0;
-				childmis->direction = camera_.GetForward();
-				childmissiles[i].push_back(childmis);
-				if (childmissiles[i].size() > 30) {
-					SceneNode *cmis = childmissiles[i].front();
-					childmissiles[i].pop_front();
-					cmis->SetVisible(false);
-					cmis->~SceneNode();
-				}
-			}
-		}*/
+		// Same look as the player's beam
+		SceneNode *laser = new SceneNode("laser", resman_.GetResource("LaserMesh"), resman_.GetResource("ObjectMaterial"), 0);
+		laser->Scale(glm::vec3(1.0, 1.0, 40));
+		laser->SetVisible(false);
+		scene_.GetNode(root_name_g)->AddChild(laser);
+		return laser;
 	}
 
-	void Game::CreateBulletInstance(std::string entity_name, std::string object_name, std::string material_name) {
-
-		// Get resources
-		Resource *geom = resman_.GetResource(object_name);
-		if (!geom) {
-			throw(GameException(std::string("Could not find resource \"") + object_name + std::string("\"")));
-		}
-
-		Resource *mat = resman_.GetResource(material_name);
-		if (!mat) {
-			throw(GameException(std::string("Could not find resource \"") + material_name + std::string("\"")));
-		}
-
+	void Game::CreateMissileInstance(void) {
 
-		// Create Missile instance
-		SceneNode *bullet = new SceneNode(entity_name, geom, mat, 0);
-		SceneNode *particles = new SceneNode(entity_name + " particles", resman_.GetResource("MissileParticles"), resman_.GetResource("BulletMaterial"), resman_.GetResource("Fire"));
+		Projectile projectile = { PLAYER_MISSILE, 5.0f, -20.0f, camera_.GetForward(), heli->GetPosition(), camera_.GetOrientation(), 2.0f };
+		projectiles_.Add(projectile, projectile_lifetime_g);
+	}
 
-		bullet->SetVisible(true);
-		//particles->Scale(glm::vec3(10.0));
-		particles->SetParticle(true);
-		particles->SetBlending(true);
-		particles->SetVisible(true);
-		bullet->AddChild(particles);
-		
-		bullet->SetPosition(this->heli->GetPosition());
-		bullet->SetOrientation(this->camera_.GetOrientation());
-		bullet->SetScale(glm::vec3(2.0));
-		scene_.GetNode("Root")->AddChild(bullet, true);
-		float off = 0.0;
+	void Game::CreateBulletInstance(void) {
 
-		float sprayX = (float)((rand() % 1000) - 500) / 20000.0f;
-		float sprayY = (float)((rand() % 1000) - 500) / 20000.0f;
+		float sprayX = (float)(weapon_random_.NextInt(1000) - 500) / 20000.0f;
+		float sprayY = (float)(weapon_random_.NextInt(1000) - 500) / 20000.0f;
 
 
-		bullet->direction = glm::normalize(camera_.GetForward() + sprayY * camera_.GetUp() + sprayX * camera_.GetSide());
-		missiles.push_back(bullet);
-		if (missiles.size() > 200) {
-			SceneNode *mis = missiles.front();
-			missiles.pop_front();
-			mis->SetVisible(false);
-			mis->~SceneNode();
-		}
+		glm::vec3 direction = glm::normalize(camera_.GetForward() + sprayY * camera_.GetUp() + sprayX * camera_.GetSide());
+		Projectile projectile = { PLAYER_BULLET, 5.0f, 0.0f, direction, heli->GetPosition(), camera_.GetOrientation(), 2.0f };
+		projectiles_.Add(projectile, projectile_lifetime_g);
 
-		// Create Missiles for children
-		for (int i = 0; i < childmissiles.size(); i++) {
+		// Collected hostages fire along
+		ComponentArray<Hostage> &hostages = registry_.GetHostages();
+		for (int i = 0; i < hostages.Size(); i++) {
 			if (ticker % 10 == 0) {
-				if (hostcollected[i]) {
-					SceneNode *childbullet = new SceneNode(entity_name + "Child", geom, mat, 0);
-					SceneNode *childpart = new SceneNode(entity_name + " particlesChild", resman_.GetResource("MissileParticles"), resman_.GetResource("BulletMaterial"), resman_.GetResource("Fire"));
-					childbullet->SetVisible(true);
-					//childpart->Scale(glm::vec3(10.0));
-					childpart->SetParticle(true);
-					childpart->SetBlending(true);
-					childpart->SetVisible(true);
-					childbullet->AddChild(childpart);
-
-					childbullet->SetPosition(hostages[i]->GetPosition());
-					childbullet->SetOrientation(this->camera_.GetOrientation());
-					childbullet->SetScale(glm::vec3(2.0));
-					scene_.GetNode("Root")->AddChild(childbullet, true);
-					float off = 0.0;
-					childbullet->direction = glm::normalize(camera_.GetForward() + sprayY * camera_.GetUp() + sprayX * camera_.GetSide());
-					childmissiles[i].push_back(childbullet);
-					for (int aaa = 0; aaa < childmissiles[i].size(); aaa++)
-						std::cout << childmissiles[i][aaa]->GetVisible() << std::endl;
+				if (hostages[i].collected) {
+					Projectile childprojectile = { CHILD_BULLET, 5.0f, 0.0f, direction, hostages[i].node->GetPosition(), camera_.GetOrientation(), 2.0f };
+					projectiles_.Add(childprojectile, projectile_lifetime_g);
 				}
 			}
 		}
@@ -1847,42 +2348,23 @@ namespace game {
 
 
 
-	void Game::CreateEnemyMissile(std::string entity_name, std::string object_name, std::string material_name, Enemy* enemy) {
-		std::cout << "\nFIRE!";
-		// Get resources
-		Resource *geom = resman_.GetResource(object_name);
-		if (!geom) {
-			throw(GameException(std::string("Could not find resource \"") + object_name + std::string("\"")));
-		}
-
-		Resource *mat = resman_.GetResource(material_name);
-		if (!mat) {
-			throw(GameException(std::string("Could not find resource \"") + material_name + std::string("\"")));
-		}
-
-
-		// Create Missile instance
-		SceneNode *missile = new SceneNode(entity_name, geom, mat, 0);
-		SceneNode *particles = new SceneNode(entity_name + " particles", resman_.GetResource("MissileParticles"), resman_.GetResource("MissileMaterial"), resman_.GetResource("Fire"));
-
-		missile->SetVisible(true);
-		particles->SetParticle(true);
-		particles->SetBlending(true);
-		particles->SetVisible(true);
-		missile->AddChild(particles);
+	void Game::CreateEnemyMissile(EntityId enemy) {
+		const Transform *transform = registry_.GetTransforms().Get(enemy);
+		Projectile projectile = { ENEMY_MISSILE, 3.0f, 0.0f, transform->orientation * glm::vec3(0.0, 0.0, 1.0), transform->position, transform->orientation, 1.0f };
+		projectiles_.Add(projectile, projectile_lifetime_g);
 
-		missile->SetVisible(true);
-		//missile->Scale(glm::vec3(10.0));
-		missile->SetPosition(enemy->GetPosition());
-		missile->SetOrientation(enemy->GetOrientation());
+	}
 
-		scene_.GetNode("Root")->AddChild(missile);
-		float off = 0.0;
-		missile->direction = enemy->GetForward();
-		enemymissiles.push_back(missile);
+	// Vector with components uniform in [0, 1), drawn in the order x, y, z
+	static glm::vec3 RandomVector(Random &random) {
 
+		float x = random.NextFloat();
+		float y = random.NextFloat();
+		float z = random.NextFloat();
+		return glm::vec3(x, y, z);
 	}
 
+
 	void Game::CreateAsteroidField(int num_asteroids) {
 
 		// Create a number of asteroid instances
@@ -1899,10 +2381,12 @@ namespace game {
 			// Set attributes of asteroid: random position, orientation, and
 			// angular momentum
 			//ast->SetPosition(glm::vec3(0, 0, 700));
-			ast->SetPosition(glm::vec3(-300.0 + 600.0*((float)rand() / RAND_MAX), 0 + 600.0*((float)rand() / RAND_MAX), 600.0*((float)rand() / RAND_MAX)));
-			ast->SetOrientation(glm::normalize(glm::angleAxis(glm::pi<float>()*((float)rand() / RAND_MAX), glm::vec3(((float)rand() / RAND_MAX), ((float)rand() / RAND_MAX), ((float)rand() / RAND_MAX)))));
-			ast->SetAngM(glm::normalize(glm::angleAxis(0.05f*glm::pi<float>()*((float)rand() / RAND_MAX), glm::vec3(((float)rand() / RAND_MAX), ((float)rand() / RAND_MAX), ((float)rand() / RAND_MAX)))));
-			scene_.GetNode("Root")->AddChild(ast);
+			ast->SetPosition(RandomVector(spawn_random_) * 600.0f + glm::vec3(-300.0, 0.0, 0.0));
+			float angle = spawn_random_.NextFloat();
+			ast->SetOrientation(glm::normalize(glm::angleAxis(glm::pi<float>()*angle, RandomVector(spawn_random_))));
+			angle = spawn_random_.NextFloat();
+			ast->SetAngM(glm::normalize(glm::angleAxis(0.05f*glm::pi<float>()*angle, RandomVector(spawn_random_))));
+			scene_.GetNode(root_name_g)->AddChild(ast);
 		}
 	}
 
@@ -2145,7 +2629,7 @@ namespace game {
 		}
 
 		// Create instance
-		Enemy* node = new Enemy(1, entity_name, geom, mat, tex, heli, &resman_);
+		Enemy* node = new Enemy(1, entity_name, geom, mat, tex);
 		scene_.GetNode(parent_name)->AddChild(node);
 		return node;
 	}
@@ -2200,61 +2684,10 @@ namespace game {
 		}
 
 		// Create instance
-		Enemy* node = new Enemy(2, entity_name, geom, mat, tex, heli, &resman_);
+		Enemy* node = new Enemy(2, entity_name, geom, mat, tex);
 		scene_.GetNode(parent_name)->AddChild(node);
 		return node;
 	}
-	bool Game::PointBoxCollision(glm::vec3 point, glm::vec3* box) {
-		/*
-		box : 0 min x max y max z
-		box : 1 max x max y max z *allmaxes*
-		box : 2 min x max y min z
-		box : 3 max x max y min z
-		box : 4 min x min y max z
-		box : 5 max x min y max z
-		box : 6 min x min y min z *all mins*
-		box : 7 max x min y min z
-		*/
-
-		if (point.x > box[6].x && point.x < box[1].x && point.y < box[1].y && point.z > box[6].z && point.z < box[1].z)
-			return true;
-		else
-			return false;
-
-	}
-
-	glm::vec3* Game::LinePlaneCollision(glm::vec3 planeVector, glm::vec3 planePoint, glm::vec3 lineVector, glm::vec3 linePoint)
-	{
-		glm::vec3 returnResult;
-		returnResult = glm::vec3();
-		float vp1, vp2, vp3, n1, n2, n3, v1, v2, v3, m1, m2, m3, t, vpt;
-		vp1 = planeVector[0];
-		vp2 = planeVector[1];
-		vp3 = planeVector[2];
-		n1 = planePoint[0];
-		n2 = planePoint[1];
-		n3 = planePoint[2];
-		v1 = lineVector[0];
-		v2 = lineVector[1];
-		v3 = lineVector[2];
-		m1 = linePoint[0];
-		m2 = linePoint[1];
-		m3 = linePoint[2];
-		vpt = v1 * vp1 + v2 * vp2 + v3 * vp3;
-
-		if (vpt == 0)
-		{
-			return NULL;
-		}
-		else
-		{
-			t = ((n1 - m1) * vp1 + (n2 - m2) * vp2 + (n3 - m3) * vp3) / vpt;
-			returnResult[0] = m1 + v1 * t;
-			returnResult[1] = m2 + v2 * t;
-			returnResult[2] = m3 + v3 * t;
-			return &returnResult;
-		}
-	}
 
 } // namespace game
 
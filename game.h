@@ -12,8 +12,27 @@
 #include "camera.h"
 #include "asteroid.h"
 #include "Enemy.h"
+#include "entity_registry.h"
+#include "job_system.h"
+#include "uniform_grid.h"
+#include "static_bvh.h"
+#include "point_box_batch.h"
+#include "projectile_store.h"
+#include "projectile_renderer.h"
+#include "proximity_grid.h"
+#include "fixed_timestep.h"
+#include "contact_queue.h"
+#include "chunk_streamer.h"
+#include "world_snapshot.h"
+#include "ray_caster.h"
+#include "input_source.h"
+#include "input_recording.h"
+#include "offscreen_context.h"
+#include "run_stats.h"
+#include "performance_hud.h"
 
 #include <deque>
+#include <unordered_map>
 
 namespace game {
 
@@ -44,16 +63,48 @@ namespace game {
             void SetupScene(void);
             // Run the game: keep the application active
             void MainLoop(void); 
-
-			void Update(GLFWwindow*);
+			// Run 'ticks' ticks as fast as possible, reading the controls
+			// from 'input', and measure them into 'stats'. Needs SetHeadless
+			void RunHeadless(int ticks, InputSource &input, RunStats &stats);
+			// Run without a window or OpenGL: nothing is drawn and the
+			// clock only moves with the ticks run; call before Init
+			void SetHeadless(bool headless);
+			// Draw into a framebuffer of an offscreen context instead of a
+			// window; call before Init
+			void SetOffscreen(bool offscreen);
+			// Simulate and draw 'frames' frames, one tick each, and measure
+			// the ticks, the CPU and GPU time spent drawing and the draw
+			// calls into 'stats'
+			void RunBenchmark(int frames, InputSource &input, RunStats &stats);
+			// Write the input of every tick from now on to 'path', with the
+			// settings to replay it; call after SetupScene and SpawnEnemies
+			void StartRecording(const std::string &path);
+			// Run with the settings of a recording; call before Init, then
+			// spawn settings.extra_enemies
+			void UseSettings(const RecordingSettings &settings);
+			// Ticks of the simulation per second; call before MainLoop
+			void SetTickRate(double ticks_per_second);
+			// Side of the square world; call before SetupScene
+			void SetWorldSize(int size);
+			// Seed of the world, particles and spawns; call before Init
+			void SetSeed(uint64_t seed);
+			uint64_t GetSeed(void) const;
+			// File the generated world is saved to and loaded from; call
+			// before SetupScene. Empty, the default, turns snapshots off.
+			// A snapshot made with other settings is written again
+			void SetSnapshotPath(const std::string &path);
+
+			void Update(float delta_time);
 
 			glm::vec2 CursorMovement();
 
-			void CreateMissileInstance(std::string, std::string, std::string);
-			void CreateBulletInstance(std::string, std::string, std::string);
-			void CreateEnemyMissile(std::string entity_name, std::string object_name, std::string material_name, Enemy* enemy);
+			void CreateMissileInstance(void);
+			void CreateBulletInstance(void);
+			void CreateEnemyMissile(EntityId enemy);
 
-			void checkForCollisions(GLFWwindow* window, bool laser);
+			// Push the contacts of the lasers, or else of the bullets and
+			// explosions, with the enemies, and of the player with hostages
+			void checkForCollisions(bool laser);
 
 			void PrintVec3(glm::vec3);
 
@@ -64,17 +115,29 @@ namespace game {
 			void SetupWorld();
 			void SetupEnemies();
 			void SpawnRandomHostage();
-			void SetupHostage(std::string name, SceneNode** captors, glm::vec3);
-			bool PointBoxCollision(glm::vec3 point, glm::vec3* box);
+			bool PickHostagePlacement(HostagePlacement &placement);
+			void SpawnHostage(const HostagePlacement &placement);
+			EntityId SetupHostage(std::string name, const EntityId captors[4], glm::vec3);
 			GLFWcursor* CreateBlankCursor();
-			glm::vec3* LinePlaneCollision(glm::vec3 planeVector, glm::vec3 planePoint, glm::vec3 lineVector, glm::vec3 linePoint);
 
 			void SpawnTank(glm::vec3);
 			void SpawnEnemyHeli(glm::vec3);
+			// Scatter 'count' extra turrets and flyers over the world, to
+			// load the simulation; call after SetupScene
+			void SpawnEnemies(int count);
+			// Free and collect every waiting hostage, so they follow the
+			// player and fire along; call after SetupScene
+			void RescueHostages(void);
 
         protected:
-            // GLFW window
+            // GLFW window, or NULL when headless or offscreen
             GLFWwindow* window_;
+			bool headless_;
+
+			// Context of offscreen runs. Declared early so it is destroyed
+			// after everything holding OpenGL objects
+			bool offscreen_;
+			OffscreenContext offscreen_context_;
 
             // Scene graph containing all nodes to render
             SceneGraph scene_;
@@ -90,36 +153,126 @@ namespace game {
 			int worldXmax;
 			int worldZmin;
 			int worldZmax;
+			int world_size_;
 			int ticker;
+
+			// Every generator draws from its own stream of the seed, so
+			// more draws in one subsystem leave the others unchanged
+			uint64_t seed_;
+			Random particle_random_; // Particle and spline resources
+			Random spawn_random_; // Enemy and hostage placement
+			Random weapon_random_; // Bullet spread
             // Flag to turn animation on/off
             bool animating_;
 
+			// Simulation clock. Gameplay constants are amounts per tick,
+			// tuned for the default of 60 ticks per second
+			FixedTimestep clock_;
+
 			glm::vec3 ship_velocity = glm::vec3(0.0, 0.0, 0.0);
 			glm::vec3 ship_rotation = glm::vec3(0.0, 0.0, 0.0);
 
 			glm::vec2 playerMouse = glm::vec2(0.0, 0.0);
 			
-			void HeliBuildingCollision(SceneNode*, glm::vec3);
-
-			void MissileBuidlingCollision(SceneNode*, SceneNode*, glm::vec3);
+			// Collision detection pushes contacts to contacts_, and
+			// RespondToContacts handles them in order then clears the
+			// queue. Only the responses change the world
+			ContactQueue contacts_;
+			std::vector<ContactQueue> bullet_contacts_; // One per detection job
+			void DetectBuildingContacts(glm::vec3 prevpos);
+			// Push a hit on every enemy within 'radius' of 'center' to
+			// 'queue'; 'nearby' is scratch. Returns the enemies tested
+			int QueueEnemyHits(ContactQueue &queue, glm::vec3 center, float radius, int projectile, float damage, std::vector<EntityId> &nearby) const;
+			void RespondToContacts(void);
+			void HeliBuildingCollision(const Contact &contact);
+			void MissileBuidlingCollision(const Contact &contact);
+			void EnemyHitResponse(const Contact &contact, float now);
+			// Remove a dead enemy; its node is deleted with the garbage
+			void KillEnemy(EntityId enemy);
+			void HostageReachedResponse(const Contact &contact);
 
 			SceneNode* lazerref;
-			std::deque<SceneNode*> missiles;
-			std::deque<std::deque<SceneNode*>> childmissiles;
-			std::vector<Helicopter*> hostages;
-			std::deque<SceneNode*> childlasers;
-			std::vector<bool> hostcollected;
-			std::vector<SceneNode *> collidables;
-			std::vector<Enemy*> enemies;
-			std::vector<SceneNode*> enemymissiles;
 			std::vector<glm::vec3*> spawnPoints;
-			std::vector<SceneNode *> buildings;
+
+			// Components of enemies, buildings, hostages and explosions
+			EntityRegistry registry_;
+
+			// Workers for the scene update, the entity systems and collisions
+			JobSystem jobs_;
+
+			// Generated world from an earlier run with the same settings. It
+			// is read by the streamer, so it is declared first and outlives it
+			WorldSnapshot snapshot_;
+			std::string snapshot_path_;
+			WorldSnapshotKey GetSnapshotKey(void) const;
+
+			// Chunks of buildings and floor around the player. Each chunk
+			// carries its own collision structures, built with it on the
+			// loader thread; queries go to the chunks they overlap
+			ChunkStreamer world_streamer_;
+			void StreamWorld(void);
+			void AttachChunk(WorldChunk *chunk);
+			void DetachChunk(WorldChunk *chunk);
+			void EvictChunkEntities(WorldChunk *chunk);
+			void RefreshAttachedChunks(void);
+
+			// Attached chunks, their index by chunk key, and their
+			// hierarchies as occluders of the laser
+			std::vector<WorldChunk *> attached_chunks_;
+			std::unordered_map<uint64_t, int> chunk_lookup_;
+			std::vector<const StaticBVH *> chunk_occluders_;
+			void GetChunkCoordinates(glm::vec3 point, int &column, int &row) const;
+			int FindChunk(int column, int row) const;
+			int FindChunk(glm::vec3 point) const;
+
+			// Projectiles tested against buildings, as (chunk and grid
+			// cell, projectile) pairs, and the points of one cell for a
+			// batch test. blocked_hits_ holds the box each projectile is
+			// inside, or -1
+			std::vector<std::pair<long long, int> > projectile_cells_;
+			PointSoA cell_points_;
+			std::vector<int> cell_hits_;
+			std::vector<int> blocked_hits_;
+
+			// Bullets and missiles in flight
+			ProjectileStore projectiles_;
+			ProjectileRenderer projectile_renderer_;
+
+			// Counters of the last frame, shown over the scene; F3 toggles
+			PerformanceHud hud_;
+			std::vector<std::string> hud_lines_;
+			void DrawHud(double frame_time);
+
+			// Enemies and waiting hostages by position, updated as they
+			// spawn, move and die, with scratch lists for their queries
+			ProximityGrid enemy_proximity_;
+			ProximityGrid hostage_proximity_;
+			std::vector<EntityId> turret_candidates_;
+			std::vector<EntityId> explosion_targets_;
+			std::vector<EntityId> nearby_hostages_;
+
+			// Lasers, cast against boxes around the enemies and stopped by
+			// buildings
+			RayCaster laser_caster_;
+			std::vector<AABB> laser_targets_;
 
 			bool input_up, input_down, input_left, input_right, input_s, input_x, input_a, input_z, input_e, input_q,
 				 input_j, input_l, input_i, input_k, input_c, input_m, input_t, input_w, input_d, input_b, input_space, input_shift,
 				 input_m1, input_m2, input_m3;
 			float offsetx, offsety;
 
+			// Input flag of each InputButton. Every tick's input goes
+			// through a TickInput, from the window or a source, so it can be
+			// recorded and replayed
+			static bool Game::* const input_flags_[INPUT_BUTTON_COUNT];
+			void CaptureInput(TickInput &input);
+			void ApplyInput(const TickInput &input);
+			InputRecorder recorder_;
+			int extra_enemies_;
+
+			// Run one tick of the simulation with 'input'
+			void Step(const TickInput &input);
+
 			// Scene graph containing all nodes to render
 
 			Helicopter* heli;
@@ -131,22 +284,21 @@ namespace game {
 			SceneNode* rotor2;
 			SceneNode* rotor3;
 
-			std::vector<SceneNode*> explosionSpheres;
 			void UpdateExplosions(float);
 
 			float missileFireRate;
 			float missileTimer;
 
-			std::vector<SceneNode*> explodingMissiles;
-
 
 			SceneNode* test;
 
 			//Queue containing past 5 positions of helicopter
 			std::deque<glm::vec3> positions;
+			int rescued_hostages_; // Hostages collected, which sets their place in the trail
 
             // Methods to initialize the game
             void InitWindow(void);
+            void InitOffscreen(void);
             void InitView(void);
             void InitEventHandlers(void);
  
@@ -163,9 +315,15 @@ namespace game {
 				type == 0 : Stationary				
 			*/
 			Enemy* CreateEnemyInstance(std::string entity_name, std::string object_namee, std::string material_name, int enemyType);
+			// Register a node as an entity with a Transform
+			EntityId AddEntity(SceneNode *node);
+			// Register an enemy with the components matching its type
+			EntityId AddEnemyEntity(Enemy *enemy, EntityId mount = INVALID_ENTITY);
             // Create entire random asteroid field
             void CreateAsteroidField(int num_asteroids = 200);
 			void CreateLaserInstance(std::string entity_name, std::string object_name, std::string material_name);
+			// Beam of the laser of a collected hostage, hidden until fired
+			SceneNode *CreateHostageLaser(void);
 			SceneNode *CreateInstance(std::string entity_name, std::string object_name, std::string material_name);
 			SceneNode *CreateInstance(std::string entity_name, std::string object_name, std::string material_name, std::string parent_name);
 			SceneNode *CreateTexturedInstance(std::string entity_name, std::string object_name, std::string material_name, std::string texture_name);
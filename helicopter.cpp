@@ -15,13 +15,10 @@ namespace game {
 		forward_ = glm::vec3(0.0, 0.0, 1.0);
 		side_ = glm::vec3(1.0, 0.0, 0.0);
 		
-		health = 20.0;
-		armour = 1.0;
-		visible_ = true;
-		time = glfwGetTime();
 		this->blending_ = true;
 		isHostage = false;
 		free = false;
+		captors = NULL;
 
 
 	}
@@ -36,12 +33,6 @@ namespace game {
 		isHostage = host;
 	}
 
-	void Helicopter::Hit(float dmg) {
-		this->health -= glm::max(0.1f, dmg * 1 / armour);
-		this->wasHit = glfwGetTime();
-	}
-
-
 	glm::vec3 Helicopter::GetForward(void) const {
 		glm::vec3 current_forward = orientation_ * forward_;
 		if (texture_ == 0) {
@@ -121,26 +112,6 @@ namespace game {
 		orientation_ = rotation * orientation_;
 	}
 
-	void Helicopter::Update() {
-		float dtime = glfwGetTime() - time;
-		time = glfwGetTime();
-		if (this->hit && wasHit == 0.0) {
-			Hit(hitDmg);
-		}
-		if ((time - wasHit) < 3.0) {
-			if (visible_)
-				this->SetVisible(false);
-			else
-				this->SetVisible(true);
-		}
-		else if (wasHit > 0.0) {
-			wasHit = 0.0;
-			this->hit = false;
-			this->SetVisible(true);
-		}
-
-		Rotate(angm_);
-	}
 
 
 
@@ -39,20 +39,8 @@ namespace game {
 		void Yaw(float angle);
 		void Roll(float angle);
 
-		void Update();
-
-		void Hit(float dmg);
-
-		// Update geometry configuration
-
 	private:
 
-		float time;
-
-		float health;
-		float armour;
-		float wasHit;
-
 		SceneNode** captors;
 		bool isHostage;
 		bool free;
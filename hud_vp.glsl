@@ -0,0 +1,20 @@
+#version 130
+
+// Vertex buffer
+in vec2 vertex; // In pixels from the top left corner
+in vec4 color;
+
+// Uniform (global) buffer
+uniform vec2 screen_size;
+
+// Attributes forwarded to the fragment shader
+out vec4 color_interp;
+
+
+void main()
+{
+    vec2 position = vertex / screen_size * 2.0 - 1.0;
+    gl_Position = vec4(position.x, -position.y, 0.0, 1.0);
+
+    color_interp = color;
+}
@@ -0,0 +1,193 @@
+#include <cstring>
+
+#include "input_recording.h"
+
+namespace game {
+
+	const char recording_magic_g[8] = { 'E', 'V', 'A', 'C', 'I', 'N', 'P', 'T' };
+	const uint32_t recording_version_g = 1;
+
+
+	// Start of the file; the frames follow
+	struct RecordingHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t frame_record; // Size of InputFrame
+		uint64_t seed;
+		int32_t world_size;
+		int32_t extra_enemies;
+		double tick_rate;
+		uint64_t tick_count; // Zero until the recording is closed
+		uint64_t frame_count;
+	};
+
+
+	InputRecorder::InputRecorder(void) {
+
+		ticks_ = 0;
+		frames_ = 0;
+	}
+
+
+	InputRecorder::~InputRecorder() {
+
+		Close();
+	}
+
+
+	bool InputRecorder::Open(const std::string &path, const RecordingSettings &settings) {
+
+		Close();
+		file_.open(path.c_str(), std::ios::binary | std::ios::trunc);
+		if (!file_) {
+			return false;
+		}
+		settings_ = settings;
+		ticks_ = 0;
+		frames_ = 0;
+		WriteHeader();
+		return (bool) file_;
+	}
+
+
+	bool InputRecorder::IsOpen(void) const {
+
+		return file_.is_open();
+	}
+
+
+	void InputRecorder::Record(const TickInput &input) {
+
+		if (ticks_ == 0 || input.buttons != last_.buttons || input.mouse != last_.mouse) {
+			InputFrame frame = { (uint32_t) ticks_, input.buttons, { input.mouse.x, input.mouse.y } };
+			file_.write((const char *) &frame, sizeof(frame));
+			frames_++;
+			last_ = input;
+		}
+		ticks_++;
+	}
+
+
+	bool InputRecorder::Close(void) {
+
+		if (!file_.is_open()) {
+			return true;
+		}
+		file_.seekp(0);
+		WriteHeader();
+		bool good = (bool) file_;
+		file_.close();
+		return good;
+	}
+
+
+	void InputRecorder::WriteHeader(void) {
+
+		RecordingHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, recording_magic_g, sizeof(header.magic));
+		header.version = recording_version_g;
+		header.frame_record = sizeof(InputFrame);
+		header.seed = settings_.seed;
+		header.world_size = settings_.world_size;
+		header.extra_enemies = settings_.extra_enemies;
+		header.tick_rate = settings_.tick_rate;
+		header.tick_count = ticks_;
+		header.frame_count = frames_;
+		file_.write((const char *) &header, sizeof(header));
+	}
+
+
+	ReplayInput::ReplayInput(void) {
+
+		memset(&settings_, 0, sizeof(settings_));
+		tick_count_ = 0;
+		Rewind();
+	}
+
+
+	bool ReplayInput::Load(const std::string &path) {
+
+		frames_.clear();
+		tick_count_ = 0;
+		Rewind();
+
+		std::ifstream file(path.c_str(), std::ios::binary);
+		RecordingHeader header;
+		if (!file.read((char *) &header, sizeof(header))) {
+			return false;
+		}
+		if (memcmp(header.magic, recording_magic_g, sizeof(header.magic)) != 0 || header.version != recording_version_g ||
+			header.frame_record != sizeof(InputFrame)) {
+			return false;
+		}
+
+		// An unfinished file has no counts; it holds whole frames up to
+		// where it was cut off
+		uint64_t frame_count = header.frame_count;
+		if (header.tick_count == 0) {
+			file.seekg(0, std::ios::end);
+			frame_count = ((uint64_t) file.tellg() - sizeof(header)) / sizeof(InputFrame);
+			file.seekg(sizeof(header));
+		}
+		frames_.resize((size_t) frame_count);
+		if (frame_count > 0 && !file.read((char *) frames_.data(), frame_count * sizeof(InputFrame))) {
+			frames_.clear();
+			return false;
+		}
+		for (size_t i = 1; i < frames_.size(); i++) {
+			if (frames_[i].tick <= frames_[i - 1].tick) {
+				frames_.clear();
+				return false;
+			}
+		}
+
+		settings_.seed = header.seed;
+		settings_.world_size = header.world_size;
+		settings_.extra_enemies = header.extra_enemies;
+		settings_.tick_rate = header.tick_rate;
+		tick_count_ = header.tick_count;
+		if (tick_count_ == 0 && !frames_.empty()) {
+			tick_count_ = (uint64_t) frames_.back().tick + 1;
+		}
+		return true;
+	}
+
+
+	const RecordingSettings &ReplayInput::GetSettings(void) const {
+
+		return settings_;
+	}
+
+
+	uint64_t ReplayInput::GetTickCount(void) const {
+
+		return tick_count_;
+	}
+
+
+	void ReplayInput::Rewind(void) {
+
+		tick_ = 0;
+		next_frame_ = 0;
+		current_.buttons = 0;
+		current_.mouse = glm::vec2(0.0f);
+	}
+
+
+	bool ReplayInput::Next(TickInput &input) {
+
+		if (tick_ >= tick_count_) {
+			return false;
+		}
+		if (next_frame_ < frames_.size() && frames_[next_frame_].tick == tick_) {
+			const InputFrame &frame = frames_[next_frame_++];
+			current_.buttons = frame.buttons;
+			current_.mouse = glm::vec2(frame.mouse[0], frame.mouse[1]);
+		}
+		tick_++;
+		input = current_;
+		return true;
+	}
+
+} // namespace game
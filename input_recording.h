@@ -0,0 +1,95 @@
+#ifndef INPUT_RECORDING_H_
+#define INPUT_RECORDING_H_
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+
+#include "input_source.h"
+
+namespace game {
+
+	// Settings the simulation of a recording depends on besides its input
+	struct RecordingSettings {
+		uint64_t seed;
+		int32_t world_size;
+		int32_t extra_enemies; // Spawned by Game::SpawnEnemies
+		double tick_rate;
+	};
+
+	// Input from one tick on, until the next frame of the recording
+	struct InputFrame {
+		uint32_t tick;
+		uint32_t buttons;
+		float mouse[2];
+	};
+
+	// Writes the input of every tick to a file
+	//
+	// The file starts with the settings, followed by one frame per change
+	// of input: the tick it starts at, the buttons and the mouse. Ticks
+	// that repeat the input before them take no space. The header is
+	// finished on Close; a file that was never closed, say after a crash,
+	// still replays up to its last frame
+	class InputRecorder {
+
+	public:
+		InputRecorder(void);
+		~InputRecorder();
+
+		bool Open(const std::string &path, const RecordingSettings &settings);
+		bool IsOpen(void) const;
+
+		// Call once per tick, in order
+		void Record(const TickInput &input);
+
+		// Finish the file. Returns false if any write failed
+		bool Close(void);
+
+	private:
+		std::ofstream file_;
+		RecordingSettings settings_;
+		TickInput last_;
+		uint64_t ticks_;
+		uint64_t frames_;
+
+		void WriteHeader(void);
+
+		InputRecorder(const InputRecorder &);
+		InputRecorder &operator=(const InputRecorder &);
+
+	}; // class InputRecorder
+
+	// Plays a recording back, one tick of input per call to Next
+	class ReplayInput : public InputSource {
+
+	public:
+		ReplayInput(void);
+
+		// Read the whole recording at 'path'. Returns false if it is
+		// missing or damaged
+		bool Load(const std::string &path);
+
+		// Settings to run the replay with; apply them before Game::Init
+		const RecordingSettings &GetSettings(void) const;
+		uint64_t GetTickCount(void) const;
+
+		// Start again from the first tick
+		void Rewind(void);
+
+		virtual bool Next(TickInput &input);
+
+	private:
+		RecordingSettings settings_;
+		std::vector<InputFrame> frames_;
+		uint64_t tick_count_;
+		uint64_t tick_; // Next tick to play
+		size_t next_frame_;
+		TickInput current_;
+
+	}; // class ReplayInput
+
+} // namespace game
+
+#endif // INPUT_RECORDING_H_
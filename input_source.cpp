@@ -0,0 +1,44 @@
+#include "input_source.h"
+
+namespace game {
+
+	// Stream of the scripted player, apart from the streams of the game
+	const uint64_t scripted_input_stream_g = (1ull << 62) | 16;
+
+	// Buttons a manoeuvre moves with, and the weapons it may fire
+	const InputButton scripted_moves_g[] = { INPUT_W, INPUT_W, INPUT_S, INPUT_A, INPUT_D, INPUT_UP, INPUT_DOWN };
+	const InputButton scripted_weapons_g[] = { INPUT_M1, INPUT_M2, INPUT_M3 };
+
+	// Ticks a manoeuvre is held, and the largest turn in pixels per tick
+	const int scripted_min_ticks_g = 60;
+	const int scripted_max_ticks_g = 180;
+	const float scripted_turn_g = 20.0f;
+
+
+	ScriptedInput::ScriptedInput(uint64_t seed) {
+
+		random_.Seed(seed, scripted_input_stream_g);
+		current_.buttons = 0;
+		current_.mouse = glm::vec2(0.0f);
+		remaining_ = 0;
+	}
+
+
+	bool ScriptedInput::Next(TickInput &input) {
+
+		if (remaining_ == 0) {
+			int moves = sizeof(scripted_moves_g) / sizeof(scripted_moves_g[0]);
+			int weapons = sizeof(scripted_weapons_g) / sizeof(scripted_weapons_g[0]);
+			current_.buttons = 1u << scripted_moves_g[random_.NextInt(moves)];
+			if (random_.NextInt(2) == 0) {
+				current_.buttons |= 1u << scripted_weapons_g[random_.NextInt(weapons)];
+			}
+			current_.mouse = glm::vec2(random_.NextFloat(-scripted_turn_g, scripted_turn_g), 0.0f);
+			remaining_ = scripted_min_ticks_g + random_.NextInt(scripted_max_ticks_g - scripted_min_ticks_g + 1);
+		}
+		remaining_--;
+		input = current_;
+		return true;
+	}
+
+} // namespace game
@@ -0,0 +1,58 @@
+#ifndef INPUT_SOURCE_H_
+#define INPUT_SOURCE_H_
+
+#include <stdint.h>
+#include <glm/glm.hpp>
+
+#include "random.h"
+
+namespace game {
+
+	// Buttons the simulation reads, one per input flag of the game
+	enum InputButton {
+		INPUT_UP, INPUT_DOWN, INPUT_LEFT, INPUT_RIGHT, INPUT_S, INPUT_X, INPUT_A, INPUT_Z, INPUT_E, INPUT_Q,
+		INPUT_J, INPUT_L, INPUT_I, INPUT_K, INPUT_C, INPUT_M, INPUT_T, INPUT_W, INPUT_D, INPUT_B, INPUT_SPACE, INPUT_SHIFT,
+		INPUT_M1, INPUT_M2, INPUT_M3,
+		INPUT_BUTTON_COUNT
+	};
+
+	// Controls seen by one tick of the simulation
+	struct TickInput {
+		uint32_t buttons; // Bit (1 << InputButton) set while the button is held
+		glm::vec2 mouse; // Cursor offset from the center of the window, in pixels
+	};
+
+	// Supplies the controls of each tick in place of the window
+	class InputSource {
+
+	public:
+		virtual ~InputSource() {}
+
+		// Fill 'input' for the next tick. Returns false once the source
+		// has run out, which ends the run
+		virtual bool Next(TickInput &input) = 0;
+
+	}; // class InputSource
+
+	// Stand-in player for runs without a window
+	//
+	// Holds a random manoeuvre for one to three seconds, then picks
+	// another: flying in some direction while turning, and firing one of
+	// the weapons half of the time. The same seed gives the same inputs
+	class ScriptedInput : public InputSource {
+
+	public:
+		ScriptedInput(uint64_t seed);
+
+		virtual bool Next(TickInput &input);
+
+	private:
+		Random random_;
+		TickInput current_;
+		int remaining_; // Ticks left of the current manoeuvre
+
+	}; // class ScriptedInput
+
+} // namespace game
+
+#endif // INPUT_SOURCE_H_
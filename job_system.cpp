@@ -0,0 +1,231 @@
+#include "job_system.h"
+
+namespace game {
+
+	// Job system and deque of the calling thread, if it is a worker
+	static thread_local const JobSystem *current_system_g = NULL;
+	static thread_local unsigned int current_queue_g = 0;
+
+
+	TaskGraph::TaskGraph(void) : remaining_(0) {
+	}
+
+
+	TaskGraph::~TaskGraph() {
+	}
+
+
+	TaskGraph::TaskId TaskGraph::Add(const std::function<void()> &job) {
+
+		Task task;
+		task.job = job;
+		task.predecessors = 0;
+		tasks_.push_back(task);
+		return (TaskId) tasks_.size() - 1;
+	}
+
+
+	void TaskGraph::Precede(TaskId before, TaskId after) {
+
+		tasks_[before].successors.push_back(after);
+		tasks_[after].predecessors++;
+	}
+
+
+	int TaskGraph::GetSize(void) const {
+
+		return (int) tasks_.size();
+	}
+
+
+	void TaskGraph::Clear(void) {
+
+		tasks_.clear();
+		pending_.reset();
+	}
+
+
+	JobSystem::JobSystem(unsigned int workers) : queued_(0), stop_(false) {
+
+		if (workers == 0) {
+			unsigned int hardware = std::thread::hardware_concurrency();
+			workers = hardware > 1 ? hardware - 1 : 0;
+		}
+
+		queue_count_ = workers + 1;
+		queues_.reset(new Queue[queue_count_]);
+		for (unsigned int i = 0; i < workers; i++) {
+			threads_.push_back(std::thread(&JobSystem::WorkerLoop, this, i + 1));
+		}
+	}
+
+
+	JobSystem::~JobSystem() {
+
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex_);
+			stop_ = true;
+		}
+		sleep_cv_.notify_all();
+		for (size_t i = 0; i < threads_.size(); i++) {
+			threads_[i].join();
+		}
+	}
+
+
+	unsigned int JobSystem::GetThreadCount(void) const {
+
+		return queue_count_;
+	}
+
+
+	void JobSystem::Run(TaskGraph &graph) {
+
+		int size = graph.GetSize();
+		if (size == 0) {
+			return;
+		}
+
+		graph.pending_.reset(new std::atomic<int>[size]);
+		for (int i = 0; i < size; i++) {
+			graph.pending_[i].store(graph.tasks_[i].predecessors, std::memory_order_relaxed);
+		}
+		graph.remaining_.store(size, std::memory_order_relaxed);
+
+		for (int i = 0; i < size; i++) {
+			if (graph.tasks_[i].predecessors == 0) {
+				Work work = { &graph, i };
+				Push(work);
+			}
+		}
+
+		// Help until the whole graph is done
+		while (graph.remaining_.load(std::memory_order_acquire) > 0) {
+			Work work;
+			if (Pop(work)) {
+				Execute(work);
+			}
+			else {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+
+	void JobSystem::ParallelFor(int count, int grain, const std::function<void(int begin, int end)> &job) {
+
+		if (count <= 0) {
+			return;
+		}
+		if (grain < 1) {
+			grain = 1;
+		}
+		if (count <= grain || queue_count_ == 1) {
+			job(0, count);
+			return;
+		}
+
+		TaskGraph graph;
+		for (int begin = 0; begin < count; begin += grain) {
+			int end = begin + grain < count ? begin + grain : count;
+			graph.Add([&job, begin, end]() { job(begin, end); });
+		}
+		Run(graph);
+	}
+
+
+	void JobSystem::WorkerLoop(unsigned int index) {
+
+		current_system_g = this;
+		current_queue_g = index;
+
+		while (true) {
+			Work work;
+			if (Pop(work)) {
+				Execute(work);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(sleep_mutex_);
+			sleep_cv_.wait(lock, [this]() { return stop_ || queued_.load() > 0; });
+			if (stop_ && queued_.load() == 0) {
+				return;
+			}
+		}
+	}
+
+
+	unsigned int JobSystem::GetQueueIndex(void) const {
+
+		return current_system_g == this ? current_queue_g : 0;
+	}
+
+
+	void JobSystem::Push(const Work &work) {
+
+		Queue &queue = queues_[GetQueueIndex()];
+		{
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			queue.work.push_back(work);
+		}
+		queued_.fetch_add(1);
+
+		// Taking the lock orders the notification after a sleeping
+		// worker's check of 'queued_'
+		{
+			std::lock_guard<std::mutex> lock(sleep_mutex_);
+		}
+		sleep_cv_.notify_one();
+	}
+
+
+	bool JobSystem::Pop(Work &work) {
+
+		unsigned int own = GetQueueIndex();
+
+		// Newest task of our own deque first, it is likely still in cache
+		{
+			Queue &queue = queues_[own];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.work.empty()) {
+				work = queue.work.back();
+				queue.work.pop_back();
+				queued_.fetch_sub(1);
+				return true;
+			}
+		}
+
+		// Otherwise steal the oldest task of another deque
+		for (unsigned int i = 1; i < queue_count_; i++) {
+			Queue &queue = queues_[(own + i) % queue_count_];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (!queue.work.empty()) {
+				work = queue.work.front();
+				queue.work.pop_front();
+				queued_.fetch_sub(1);
+				return true;
+			}
+		}
+		return false;
+	}
+
+
+	void JobSystem::Execute(const Work &work) {
+
+		TaskGraph *graph = work.graph;
+		const TaskGraph::Task &task = graph->tasks_[work.task];
+		task.job();
+
+		for (size_t i = 0; i < task.successors.size(); i++) {
+			TaskGraph::TaskId successor = task.successors[i];
+			if (graph->pending_[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				Work next = { graph, successor };
+				Push(next);
+			}
+		}
+
+		// The graph may be destroyed as soon as the last task is counted
+		graph->remaining_.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
+} // namespace game
@@ -0,0 +1,119 @@
+#ifndef JOB_SYSTEM_H_
+#define JOB_SYSTEM_H_
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace game {
+
+	class JobSystem;
+
+	// Set of jobs with dependencies between them
+	//
+	// Build the graph with Add and Precede, then hand it to JobSystem::Run.
+	// A graph can be run several times, but only by one Run at a time
+	class TaskGraph {
+
+	public:
+		typedef int TaskId;
+
+		TaskGraph(void);
+		~TaskGraph();
+
+		// Add a job and return its identifier
+		TaskId Add(const std::function<void()> &job);
+
+		// Make 'after' wait until 'before' has finished
+		void Precede(TaskId before, TaskId after);
+
+		int GetSize(void) const;
+		void Clear(void);
+
+	private:
+		friend class JobSystem;
+
+		struct Task {
+			std::function<void()> job;
+			std::vector<TaskId> successors;
+			int predecessors;
+		};
+		std::vector<Task> tasks_;
+
+		// State of the current run
+		std::unique_ptr<std::atomic<int>[]> pending_; // Unfinished predecessors of each task
+		std::atomic<int> remaining_; // Tasks not finished yet
+
+		TaskGraph(const TaskGraph &);
+		TaskGraph &operator=(const TaskGraph &);
+
+	}; // class TaskGraph
+
+	// Pool of worker threads with work stealing
+	//
+	// Each worker owns a deque of ready tasks. It pushes and pops tasks at
+	// the back of its own deque, and when that runs dry it steals from the
+	// front of the others. The thread calling Run or ParallelFor works as
+	// well while it waits, so both calls are join points: when they return,
+	// every job they started has finished and its writes are visible to the
+	// caller. Jobs may call Run or ParallelFor themselves
+	class JobSystem {
+
+	public:
+		// Start 'workers' threads besides the calling one. With 0, one
+		// thread is started per hardware thread, minus the calling one
+		JobSystem(unsigned int workers = 0);
+		~JobSystem();
+
+		// Number of threads running jobs, including the calling one
+		unsigned int GetThreadCount(void) const;
+
+		// Run all jobs of a graph, respecting dependencies, and wait for them
+		void Run(TaskGraph &graph);
+
+		// Call 'job' on consecutive ranges [begin, end) that cover
+		// [0, count), with at most 'grain' elements each, and wait for them
+		void ParallelFor(int count, int grain, const std::function<void(int begin, int end)> &job);
+
+	private:
+		// Ready task of some graph
+		struct Work {
+			TaskGraph *graph;
+			TaskGraph::TaskId task;
+		};
+
+		// Deque of one thread. A mutex per deque keeps stealing simple;
+		// contention is low because thieves only come when idle
+		struct Queue {
+			std::mutex mutex;
+			std::deque<Work> work;
+		};
+
+		std::vector<std::thread> threads_;
+		std::unique_ptr<Queue[]> queues_; // One per thread, the caller's first
+		unsigned int queue_count_;
+
+		std::atomic<int> queued_; // Tasks waiting in all deques
+		std::mutex sleep_mutex_;
+		std::condition_variable sleep_cv_;
+		bool stop_;
+
+		void WorkerLoop(unsigned int index);
+		unsigned int GetQueueIndex(void) const;
+		void Push(const Work &work);
+		bool Pop(Work &work);
+		void Execute(const Work &work);
+
+		JobSystem(const JobSystem &);
+		JobSystem &operator=(const JobSystem &);
+
+	}; // class JobSystem
+
+} // namespace game
+
+#endif // JOB_SYSTEM_H_
@@ -1,14 +1,97 @@
 #include <iostream>
 #include <exception>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <algorithm>
 #include "game.h"
+#include "engine_counters.h"
 
 // Macro for printing exceptions
 #define PrintException(exception_object)\
 	std::cerr << exception_object.what() << std::endl
 
 // Main function that builds and runs the game
-int main(void){
+//
+// Options:
+//   --tick-rate N   run the simulation at N ticks per second (default 60)
+//   --world-size N  make the world N units on a side (default 600)
+//   --seed N        generate the world and spawns from seed N (default 1)
+//   --snapshot PATH save the generated world to PATH and load it from
+//                   there on later runs
+//   --no-snapshot   always generate the world (the default)
+//   --enemies N     scatter N more enemies over the world
+//   --headless N    run N ticks as fast as possible without a window,
+//                   with a scripted player, and print the tick rate
+//   --bench-frames N draw N frames offscreen, with a scripted player,
+//                   and print percentiles of the frame times
+//   --record PATH   write the input of every tick to PATH
+//   --replay PATH   replay the input recorded in PATH, with the settings
+//                   it was recorded with, headless unless --bench-frames
+//                   is given; --headless N stops it after N ticks
+//   --counters-csv PATH write the engine counters of every frame to PATH
+int main(int argc, char *argv[]){
     game::Game app; // Game application
+    int headless_ticks = 0;
+    int extra_enemies = 0;
+    int bench_frames = 0;
+    std::string record_path;
+    std::string replay_path;
+    std::string counters_path;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            double tick_rate = atof(argv[++i]);
+            if (tick_rate > 0.0) {
+                app.SetTickRate(tick_rate);
+            }
+        } else if (strcmp(argv[i], "--world-size") == 0 && i + 1 < argc) {
+            int world_size = atoi(argv[++i]);
+            if (world_size > 0) {
+                app.SetWorldSize(world_size);
+            }
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            app.SetSeed(strtoull(argv[++i], NULL, 10));
+        } else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+            app.SetSnapshotPath(argv[++i]);
+        } else if (strcmp(argv[i], "--no-snapshot") == 0) {
+            app.SetSnapshotPath("");
+        } else if (strcmp(argv[i], "--enemies") == 0 && i + 1 < argc) {
+            extra_enemies = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc) {
+            headless_ticks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-frames") == 0 && i + 1 < argc) {
+            bench_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--counters-csv") == 0 && i + 1 < argc) {
+            counters_path = argv[++i];
+        }
+    }
+
+    // A replay sets up the game as it was recorded, and runs headless for
+    // all of its ticks unless told otherwise
+    game::ReplayInput replay;
+    if (!replay_path.empty()) {
+        if (!replay.Load(replay_path)) {
+            std::cerr << "Could not read input recording " << replay_path << std::endl;
+            return 1;
+        }
+        app.UseSettings(replay.GetSettings());
+        extra_enemies = replay.GetSettings().extra_enemies;
+        if (headless_ticks <= 0 && bench_frames <= 0) {
+            headless_ticks = (int) std::min<uint64_t>(std::max<uint64_t>(replay.GetTickCount(), 1), INT_MAX);
+        }
+    }
+    if (!counters_path.empty() && !game::EngineCounters::OpenCsv(counters_path)) {
+        std::cerr << "Could not create counters file " << counters_path << std::endl;
+        return 1;
+    }
+    bool headless = headless_ticks > 0 && bench_frames <= 0;
+    app.SetHeadless(headless);
+    app.SetOffscreen(bench_frames > 0);
 
     try {
         // Initialize game
@@ -16,11 +99,33 @@ int main(void){
         // Setup the main resources and scene in the game
         app.SetupResources();
         app.SetupScene();
-        // Run game
-        app.MainLoop();
+        if (extra_enemies > 0) {
+            app.SpawnEnemies(extra_enemies);
+        }
+        if (!record_path.empty()) {
+            app.StartRecording(record_path);
+        }
+        // Run game, with the input of the replay or else a scripted player
+        // when there is no window
+        game::ScriptedInput scripted(app.GetSeed());
+        game::InputSource &input = replay_path.empty() ? (game::InputSource &) scripted : (game::InputSource &) replay;
+        game::RunStats stats;
+        if (bench_frames > 0) {
+            app.RunBenchmark(bench_frames, input, stats);
+            game::PrintRunStats(stats);
+        } else if (headless) {
+            app.RunHeadless(headless_ticks, input, stats);
+            game::PrintRunStats(stats);
+        } else {
+            app.MainLoop();
+        }
     }
     catch (std::exception &e){
         PrintException(e);
+        // Without a window there is no console to keep open
+        if (headless || bench_frames > 0) {
+            return 1;
+        }
 		while (1);
     }
 
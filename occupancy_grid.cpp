@@ -0,0 +1,104 @@
+#include <algorithm>
+
+#include "occupancy_grid.h"
+
+namespace game {
+
+	OccupancyGrid::OccupancyGrid(void) {
+
+		width_ = 0;
+		height_ = 0;
+		words_per_row_ = 0;
+	}
+
+
+	OccupancyGrid::~OccupancyGrid() {
+	}
+
+
+	void OccupancyGrid::Reset(int width, int height) {
+
+		width_ = std::max(width, 0);
+		height_ = std::max(height, 0);
+		words_per_row_ = (width_ + 63) / 64;
+		bits_.assign((size_t) words_per_row_ * height_, 0);
+	}
+
+
+	int OccupancyGrid::GetWidth(void) const {
+
+		return width_;
+	}
+
+
+	int OccupancyGrid::GetHeight(void) const {
+
+		return height_;
+	}
+
+
+	void OccupancyGrid::Fill(int x0, int z0, int x1, int z1) {
+
+		if (!Clip(x0, z0, x1, z1)) {
+			return;
+		}
+		int first_word = x0 / 64;
+		int last_word = (x1 - 1) / 64;
+		for (int z = z0; z < z1; z++) {
+			uint64_t *row = &bits_[(size_t) z * words_per_row_];
+			for (int word = first_word; word <= last_word; word++) {
+				row[word] |= GetMask(word, x0, x1);
+			}
+		}
+	}
+
+
+	bool OccupancyGrid::Test(int x0, int z0, int x1, int z1) const {
+
+		if (!Clip(x0, z0, x1, z1)) {
+			return false;
+		}
+		int first_word = x0 / 64;
+		int last_word = (x1 - 1) / 64;
+		for (int z = z0; z < z1; z++) {
+			const uint64_t *row = &bits_[(size_t) z * words_per_row_];
+			for (int word = first_word; word <= last_word; word++) {
+				if (row[word] & GetMask(word, x0, x1)) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+
+	bool OccupancyGrid::Get(int x, int z) const {
+
+		if (x < 0 || z < 0 || x >= width_ || z >= height_) {
+			return false;
+		}
+		return (bits_[(size_t) z * words_per_row_ + x / 64] >> (x % 64)) & 1;
+	}
+
+
+	bool OccupancyGrid::Clip(int &x0, int &z0, int &x1, int &z1) const {
+
+		x0 = std::max(x0, 0);
+		z0 = std::max(z0, 0);
+		x1 = std::min(x1, width_);
+		z1 = std::min(z1, height_);
+		return x0 < x1 && z0 < z1;
+	}
+
+
+	uint64_t OccupancyGrid::GetMask(int word, int x0, int x1) {
+
+		// Columns of the word covered by [x0, x1), as bit positions
+		int begin = std::max(x0 - word * 64, 0);
+		int end = std::min(x1 - word * 64, 64);
+		uint64_t high = (end == 64) ? ~(uint64_t) 0 : (((uint64_t) 1 << end) - 1);
+		uint64_t low = ((uint64_t) 1 << begin) - 1;
+		return high & ~low;
+	}
+
+} // namespace game
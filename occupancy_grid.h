@@ -0,0 +1,51 @@
+#ifndef OCCUPANCY_GRID_H_
+#define OCCUPANCY_GRID_H_
+
+#include <vector>
+#include <stdint.h>
+
+namespace game {
+
+	// Grid of occupied unit cells, one bit each
+	//
+	// Each row is packed in 64-bit words, so filling or testing a
+	// rectangle touches one word per row for every 64 columns it spans.
+	// Rectangles are given as [x0, x1) by [z0, z1) in cells and clipped to
+	// the grid
+	class OccupancyGrid {
+
+	public:
+		OccupancyGrid(void);
+		~OccupancyGrid();
+
+		// Resize to 'width' by 'height' cells, all free
+		void Reset(int width, int height);
+
+		int GetWidth(void) const;
+		int GetHeight(void) const;
+
+		// Mark every cell of the rectangle as occupied
+		void Fill(int x0, int z0, int x1, int z1);
+
+		// True if any cell of the rectangle is occupied
+		bool Test(int x0, int z0, int x1, int z1) const;
+
+		bool Get(int x, int z) const;
+
+	private:
+		int width_;
+		int height_;
+		int words_per_row_;
+		std::vector<uint64_t> bits_;
+
+		// Clip a rectangle to the grid; false if nothing is left
+		bool Clip(int &x0, int &z0, int &x1, int &z1) const;
+
+		// Mask of the bits of columns [x0, x1) that fall in word 'word'
+		static uint64_t GetMask(int word, int x0, int x1);
+
+	}; // class OccupancyGrid
+
+} // namespace game
+
+#endif // OCCUPANCY_GRID_H_
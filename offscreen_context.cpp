@@ -0,0 +1,172 @@
+#include <cstring>
+#ifdef HAVE_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include "offscreen_context.h"
+
+namespace game {
+
+	OffscreenContext::OffscreenContext(void) {
+
+		display_ = NULL;
+		context_ = NULL;
+		surface_ = NULL;
+		framebuffer_ = 0;
+		color_buffer_ = 0;
+		depth_buffer_ = 0;
+	}
+
+
+	OffscreenContext::~OffscreenContext() {
+
+		Destroy();
+	}
+
+
+#ifdef HAVE_EGL
+
+	// Display that needs no window system, or else the default one
+	static EGLDisplay GetDisplay(void) {
+
+		const char *extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+		PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (extensions && strstr(extensions, "EGL_MESA_platform_surfaceless") && get_platform_display) {
+			EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+			if (display != EGL_NO_DISPLAY && eglInitialize(display, NULL, NULL)) {
+				return display;
+			}
+		}
+		EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		if (display != EGL_NO_DISPLAY && eglInitialize(display, NULL, NULL)) {
+			return display;
+		}
+		return EGL_NO_DISPLAY;
+	}
+
+
+	bool OffscreenContext::Create(std::string &error) {
+
+		Destroy();
+		EGLDisplay display = GetDisplay();
+		if (display == EGL_NO_DISPLAY) {
+			error = "Could not open an EGL display";
+			return false;
+		}
+		display_ = display;
+
+		// Drawing goes to a framebuffer object, so the configuration only
+		// needs desktop OpenGL. Surfaceless displays may offer no pbuffer
+		// configurations, so any surface type is accepted after that
+		EGLint attributes[] = {
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+			EGL_NONE
+		};
+		EGLConfig config;
+		EGLint count = 0;
+		if (!eglChooseConfig(display, attributes, &config, 1, &count) || count == 0) {
+			attributes[1] = 0;
+			if (!eglChooseConfig(display, attributes, &config, 1, &count) || count == 0) {
+				error = "No EGL configuration supports desktop OpenGL";
+				Destroy();
+				return false;
+			}
+		}
+
+		eglBindAPI(EGL_OPENGL_API);
+		EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+		if (context == EGL_NO_CONTEXT) {
+			error = "Could not create an EGL context";
+			Destroy();
+			return false;
+		}
+		context_ = context;
+
+		// Without surfaceless contexts, a small pbuffer stands in for the
+		// window surface
+		const char *extensions = eglQueryString(display, EGL_EXTENSIONS);
+		EGLSurface surface = EGL_NO_SURFACE;
+		if (!extensions || !strstr(extensions, "EGL_KHR_surfaceless_context")) {
+			EGLint pbuffer_attributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+			surface = eglCreatePbufferSurface(display, config, pbuffer_attributes);
+			if (surface == EGL_NO_SURFACE) {
+				error = "Could not create an EGL pbuffer";
+				Destroy();
+				return false;
+			}
+			surface_ = surface;
+		}
+		if (!eglMakeCurrent(display, surface, surface, context)) {
+			error = "Could not make the EGL context current";
+			Destroy();
+			return false;
+		}
+		return true;
+	}
+
+
+	void OffscreenContext::Destroy(void) {
+
+		if (!display_) {
+			return;
+		}
+		if (framebuffer_) {
+			glDeleteFramebuffers(1, &framebuffer_);
+			glDeleteRenderbuffers(1, &color_buffer_);
+			glDeleteRenderbuffers(1, &depth_buffer_);
+			framebuffer_ = 0;
+			color_buffer_ = 0;
+			depth_buffer_ = 0;
+		}
+		eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		if (surface_) {
+			eglDestroySurface(display_, surface_);
+			surface_ = NULL;
+		}
+		if (context_) {
+			eglDestroyContext(display_, context_);
+			context_ = NULL;
+		}
+		eglTerminate(display_);
+		display_ = NULL;
+	}
+
+#else
+
+	bool OffscreenContext::Create(std::string &error) {
+
+		error = "Offscreen rendering needs a build with EGL";
+		return false;
+	}
+
+
+	void OffscreenContext::Destroy(void) {
+	}
+
+#endif
+
+
+	bool OffscreenContext::CreateTarget(int width, int height, std::string &error) {
+
+		glGenRenderbuffers(1, &color_buffer_);
+		glBindRenderbuffer(GL_RENDERBUFFER, color_buffer_);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+		glGenRenderbuffers(1, &depth_buffer_);
+		glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer_);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+		glGenFramebuffers(1, &framebuffer_);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer_);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_buffer_);
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+			error = "Offscreen framebuffer is incomplete";
+			return false;
+		}
+		return true;
+	}
+
+} // namespace game
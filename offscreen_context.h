@@ -0,0 +1,47 @@
+#ifndef OFFSCREEN_CONTEXT_H_
+#define OFFSCREEN_CONTEXT_H_
+
+#include <string>
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+namespace game {
+
+	// OpenGL context without a window, and a framebuffer to draw into
+	//
+	// The context comes from EGL. Mesa's surfaceless platform is tried
+	// first, so no display server is needed, and with its llvmpipe driver
+	// no GPU either. Only available in builds with HAVE_EGL
+	class OffscreenContext {
+
+	public:
+		OffscreenContext(void);
+		~OffscreenContext();
+
+		// Create the context and make it current. Returns false, setting
+		// 'error', if there is no EGL or no usable configuration
+		bool Create(std::string &error);
+
+		// Create a color and depth framebuffer of the given size and bind
+		// it for drawing. Needs the context, and GLEW initialized
+		bool CreateTarget(int width, int height, std::string &error);
+
+		void Destroy(void);
+
+	private:
+		void *display_; // EGLDisplay
+		void *context_; // EGLContext
+		void *surface_; // EGLSurface, if the context needs one
+
+		GLuint framebuffer_;
+		GLuint color_buffer_;
+		GLuint depth_buffer_;
+
+		OffscreenContext(const OffscreenContext &);
+		OffscreenContext &operator=(const OffscreenContext &);
+
+	}; // class OffscreenContext
+
+} // namespace game
+
+#endif // OFFSCREEN_CONTEXT_H_
@@ -0,0 +1,206 @@
+#include <cctype>
+#include <algorithm>
+
+#include "performance_hud.h"
+#include "engine_counters.h"
+
+namespace game {
+
+	// Rows of a 5x7 glyph from the top, with the left column in bit 4
+	struct Glyph {
+		char character;
+		unsigned char rows[7];
+	};
+
+	const Glyph glyphs_g[] = {
+		{ '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } },
+		{ '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+		{ '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } },
+		{ '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+		{ '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } },
+		{ '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+		{ '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } },
+		{ '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+		{ '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } },
+		{ '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+		{ 'A', { 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+		{ 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+		{ 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } },
+		{ 'D', { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+		{ 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } },
+		{ 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+		{ 'G', { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } },
+		{ 'H', { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+		{ 'I', { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+		{ 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+		{ 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } },
+		{ 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+		{ 'M', { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } },
+		{ 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+		{ 'O', { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+		{ 'P', { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+		{ 'Q', { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } },
+		{ 'R', { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+		{ 'S', { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } },
+		{ 'T', { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+		{ 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+		{ 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+		{ 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } },
+		{ 'X', { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+		{ 'Y', { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } },
+		{ 'Z', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } },
+		{ '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } },
+		{ ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } },
+		{ '-', { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } },
+		{ '_', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F } },
+		{ '/', { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 } }
+	};
+
+	// Screen pixels per font pixel, and the font pixels taken by each
+	// character and line, spacing included
+	const float hud_scale_g = 2.0f;
+	const int hud_advance_g = 6;
+	const int hud_line_height_g = 9;
+	const int hud_margin_g = 4;
+
+	const GLfloat hud_text_color_g[4] = { 1.0f, 1.0f, 0.6f, 1.0f };
+	const GLfloat hud_panel_color_g[4] = { 0.0f, 0.0f, 0.0f, 0.6f };
+
+	// Floats per vertex: position in pixels, then color
+	const int hud_vertex_floats_g = 6;
+
+
+	static const Glyph *FindGlyph(char character) {
+
+		char upper = (char) toupper((unsigned char) character);
+		for (size_t i = 0; i < sizeof(glyphs_g) / sizeof(glyphs_g[0]); i++) {
+			if (glyphs_g[i].character == upper) {
+				return &glyphs_g[i];
+			}
+		}
+		return NULL;
+	}
+
+
+	PerformanceHud::PerformanceHud(void) {
+
+		vertex_buffer_ = 0;
+		material_ = NULL;
+		visible_ = false;
+	}
+
+
+	PerformanceHud::~PerformanceHud() {
+
+		if (vertex_buffer_) {
+			glDeleteBuffers(1, &vertex_buffer_);
+		}
+	}
+
+
+	void PerformanceHud::Init(const Resource *material) {
+
+		material_ = material;
+		if (!vertex_buffer_) {
+			glGenBuffers(1, &vertex_buffer_);
+		}
+	}
+
+
+	void PerformanceHud::Toggle(void) {
+
+		visible_ = !visible_;
+	}
+
+
+	bool PerformanceHud::IsVisible(void) const {
+
+		return visible_;
+	}
+
+
+	void PerformanceHud::Draw(const std::vector<std::string> &lines, int width, int height) {
+
+		if (!vertex_buffer_ || lines.empty() || width <= 0 || height <= 0) {
+			return;
+		}
+
+		// The panel goes first so the text blends over it
+		size_t columns = 0;
+		for (size_t i = 0; i < lines.size(); i++) {
+			columns = std::max(columns, lines[i].size());
+		}
+		vertices_.clear();
+		AddQuad(0.0f, 0.0f, (columns * hud_advance_g + 2 * hud_margin_g) * hud_scale_g,
+			(lines.size() * hud_line_height_g + 2 * hud_margin_g) * hud_scale_g, hud_panel_color_g);
+		for (size_t i = 0; i < lines.size(); i++) {
+			float y = (hud_margin_g + i * hud_line_height_g) * hud_scale_g;
+			for (size_t j = 0; j < lines[i].size(); j++) {
+				AddCharacter(lines[i][j], (hud_margin_g + j * hud_advance_g) * hud_scale_g, y);
+			}
+		}
+
+		// Orphan the old buffer so the upload does not wait for the
+		// previous frame to finish drawing
+		GLsizeiptr size = vertices_.size() * sizeof(GLfloat);
+		glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer_);
+		glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices_.data());
+
+		glDisable(GL_DEPTH_TEST);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glBlendEquation(GL_FUNC_ADD);
+		GLuint program = material_->GetResource();
+		glUseProgram(program);
+		glUniform2f(glGetUniformLocation(program, "screen_size"), (float) width, (float) height);
+
+		GLint vertex_att = glGetAttribLocation(program, "vertex");
+		glVertexAttribPointer(vertex_att, 2, GL_FLOAT, GL_FALSE, hud_vertex_floats_g * sizeof(GLfloat), 0);
+		glEnableVertexAttribArray(vertex_att);
+		GLint color_att = glGetAttribLocation(program, "color");
+		glVertexAttribPointer(color_att, 4, GL_FLOAT, GL_FALSE, hud_vertex_floats_g * sizeof(GLfloat), (void *) (2 * sizeof(GLfloat)));
+		glEnableVertexAttribArray(color_att);
+
+		glDrawArrays(GL_TRIANGLES, 0, (GLsizei) (vertices_.size() / hud_vertex_floats_g));
+		glDisableVertexAttribArray(vertex_att);
+		glDisableVertexAttribArray(color_att);
+		glEnable(GL_DEPTH_TEST);
+		glDisable(GL_BLEND);
+		EngineCounters::Add(COUNTER_DRAW_CALLS);
+		EngineCounters::Add(COUNTER_PROGRAM_BINDS);
+		EngineCounters::Add(COUNTER_BUFFER_BINDS);
+		EngineCounters::Add(COUNTER_UNIFORM_UPLOADS);
+	}
+
+
+	void PerformanceHud::AddQuad(float x, float y, float width, float height, const GLfloat *color) {
+
+		const float corners[6][2] = {
+			{ x, y }, { x + width, y }, { x + width, y + height },
+			{ x, y }, { x + width, y + height }, { x, y + height }
+		};
+		for (int i = 0; i < 6; i++) {
+			vertices_.push_back(corners[i][0]);
+			vertices_.push_back(corners[i][1]);
+			vertices_.insert(vertices_.end(), color, color + 4);
+		}
+	}
+
+
+	void PerformanceHud::AddCharacter(char character, float x, float y) {
+
+		const Glyph *glyph = FindGlyph(character);
+		if (!glyph) {
+			return;
+		}
+		for (int row = 0; row < 7; row++) {
+			for (int column = 0; column < 5; column++) {
+				if (glyph->rows[row] & (0x10 >> column)) {
+					AddQuad(x + column * hud_scale_g, y + row * hud_scale_g, hud_scale_g, hud_scale_g, hud_text_color_g);
+				}
+			}
+		}
+	}
+
+} // namespace game
@@ -0,0 +1,51 @@
+#ifndef PERFORMANCE_HUD_H_
+#define PERFORMANCE_HUD_H_
+
+#include <string>
+#include <vector>
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "resource.h"
+
+namespace game {
+
+	// Lines of text drawn over the top left corner of the screen
+	//
+	// The text uses a small built-in bitmap font. Every lit pixel of every
+	// glyph becomes a quad, and all the quads of a frame, with the panel
+	// behind them, go to one buffer drawn with a single call
+	class PerformanceHud {
+
+	public:
+		PerformanceHud(void);
+		~PerformanceHud();
+
+		// Set the material of the text and create its vertex buffer.
+		// Needs a current OpenGL context
+		void Init(const Resource *material);
+
+		void Toggle(void);
+		bool IsVisible(void) const;
+
+		// Draw 'lines' over a viewport of 'width' by 'height' pixels.
+		// Characters without a glyph are left blank
+		void Draw(const std::vector<std::string> &lines, int width, int height);
+
+	private:
+		GLuint vertex_buffer_;
+		std::vector<GLfloat> vertices_;
+		const Resource *material_;
+		bool visible_;
+
+		void AddQuad(float x, float y, float width, float height, const GLfloat *color);
+		void AddCharacter(char character, float x, float y);
+
+		PerformanceHud(const PerformanceHud &);
+		PerformanceHud &operator=(const PerformanceHud &);
+
+	}; // class PerformanceHud
+
+} // namespace game
+
+#endif // PERFORMANCE_HUD_H_
@@ -0,0 +1,241 @@
+#include "point_box_batch.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define POINT_BOX_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define POINT_BOX_TARGET(isa)
+#else
+#define POINT_BOX_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace game {
+
+	void BoxSoA::Clear(void) {
+
+		min_x.clear();
+		min_y.clear();
+		min_z.clear();
+		max_x.clear();
+		max_y.clear();
+		max_z.clear();
+	}
+
+
+	void BoxSoA::Add(const AABB &box) {
+
+		min_x.push_back(box.min.x);
+		min_y.push_back(box.min.y);
+		min_z.push_back(box.min.z);
+		max_x.push_back(box.max.x);
+		max_y.push_back(box.max.y);
+		max_z.push_back(box.max.z);
+	}
+
+
+	// Scalar test of the points from 'begin' to 'end', also used for the
+	// points left over by the vector kernels
+	static void FindRange(const PointSoA &points, const BoxSoA &boxes, int begin, int end, int *hits) {
+
+		int box_count = boxes.Size();
+		for (int i = begin; i < end; i++) {
+			float x = points.x[i];
+			float y = points.y[i];
+			float z = points.z[i];
+			hits[i] = -1;
+			for (int b = 0; b < box_count; b++) {
+				if (x > boxes.min_x[b] && x < boxes.max_x[b] &&
+					y > boxes.min_y[b] && y < boxes.max_y[b] &&
+					z > boxes.min_z[b] && z < boxes.max_z[b]) {
+					hits[i] = b;
+					break;
+				}
+			}
+		}
+	}
+
+
+	// Store box 'b' for the lanes of 'mask', starting at point 'first'
+	static inline void StoreHits(int mask, int first, int b, int *hits) {
+
+		while (mask) {
+			int lane = 0;
+			while (!(mask & (1 << lane))) {
+				lane++;
+			}
+			hits[first + lane] = b;
+			mask &= mask - 1;
+		}
+	}
+
+
+	void PointBoxBatch::FindScalar(const PointSoA &points, const BoxSoA &boxes, int *hits) {
+
+		FindRange(points, boxes, 0, points.Size(), hits);
+	}
+
+
+#ifdef POINT_BOX_X86
+
+	POINT_BOX_TARGET("sse2")
+	void PointBoxBatch::FindSSE2(const PointSoA &points, const BoxSoA &boxes, int *hits) {
+
+		int count = points.Size();
+		int box_count = boxes.Size();
+		int blocks = count & ~3;
+		for (int i = 0; i < blocks; i += 4) {
+			__m128 x = _mm_loadu_ps(&points.x[i]);
+			__m128 y = _mm_loadu_ps(&points.y[i]);
+			__m128 z = _mm_loadu_ps(&points.z[i]);
+			hits[i] = hits[i + 1] = hits[i + 2] = hits[i + 3] = -1;
+
+			int pending = 0xf;
+			for (int b = 0; b < box_count && pending; b++) {
+				__m128 inside = _mm_and_ps(_mm_cmpgt_ps(x, _mm_set1_ps(boxes.min_x[b])), _mm_cmplt_ps(x, _mm_set1_ps(boxes.max_x[b])));
+				inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpgt_ps(y, _mm_set1_ps(boxes.min_y[b])), _mm_cmplt_ps(y, _mm_set1_ps(boxes.max_y[b]))));
+				inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpgt_ps(z, _mm_set1_ps(boxes.min_z[b])), _mm_cmplt_ps(z, _mm_set1_ps(boxes.max_z[b]))));
+				int mask = _mm_movemask_ps(inside) & pending;
+				if (mask) {
+					StoreHits(mask, i, b, hits);
+					pending &= ~mask;
+				}
+			}
+		}
+		FindRange(points, boxes, blocks, count, hits);
+	}
+
+
+	POINT_BOX_TARGET("avx")
+	void PointBoxBatch::FindAVX(const PointSoA &points, const BoxSoA &boxes, int *hits) {
+
+		int count = points.Size();
+		int box_count = boxes.Size();
+		int blocks = count & ~7;
+		for (int i = 0; i < blocks; i += 8) {
+			__m256 x = _mm256_loadu_ps(&points.x[i]);
+			__m256 y = _mm256_loadu_ps(&points.y[i]);
+			__m256 z = _mm256_loadu_ps(&points.z[i]);
+			for (int lane = 0; lane < 8; lane++) {
+				hits[i + lane] = -1;
+			}
+
+			int pending = 0xff;
+			for (int b = 0; b < box_count && pending; b++) {
+				__m256 inside = _mm256_and_ps(_mm256_cmp_ps(x, _mm256_set1_ps(boxes.min_x[b]), _CMP_GT_OQ), _mm256_cmp_ps(x, _mm256_set1_ps(boxes.max_x[b]), _CMP_LT_OQ));
+				inside = _mm256_and_ps(inside, _mm256_and_ps(_mm256_cmp_ps(y, _mm256_set1_ps(boxes.min_y[b]), _CMP_GT_OQ), _mm256_cmp_ps(y, _mm256_set1_ps(boxes.max_y[b]), _CMP_LT_OQ)));
+				inside = _mm256_and_ps(inside, _mm256_and_ps(_mm256_cmp_ps(z, _mm256_set1_ps(boxes.min_z[b]), _CMP_GT_OQ), _mm256_cmp_ps(z, _mm256_set1_ps(boxes.max_z[b]), _CMP_LT_OQ)));
+				int mask = _mm256_movemask_ps(inside) & pending;
+				if (mask) {
+					StoreHits(mask, i, b, hits);
+					pending &= ~mask;
+				}
+			}
+		}
+		FindRange(points, boxes, blocks, count, hits);
+	}
+
+
+	bool PointBoxBatch::HasSSE2(void) {
+
+#if defined(_M_X64) || defined(__x86_64__)
+		return true;
+#elif defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		return (info[3] & (1 << 26)) != 0;
+#else
+		return __builtin_cpu_supports("sse2") != 0;
+#endif
+	}
+
+
+	bool PointBoxBatch::HasAVX(void) {
+
+#if defined(_MSC_VER)
+		// The CPU must support AVX and the OS must save the YMM registers
+		int info[4];
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		return osxsave && avx && (_xgetbv(0) & 6) == 6;
+#else
+		return __builtin_cpu_supports("avx") != 0;
+#endif
+	}
+
+#else
+
+	// No vector kernels on this architecture
+	void PointBoxBatch::FindSSE2(const PointSoA &points, const BoxSoA &boxes, int *hits) {
+
+		FindScalar(points, boxes, hits);
+	}
+
+
+	void PointBoxBatch::FindAVX(const PointSoA &points, const BoxSoA &boxes, int *hits) {
+
+		FindScalar(points, boxes, hits);
+	}
+
+
+	bool PointBoxBatch::HasSSE2(void) {
+
+		return false;
+	}
+
+
+	bool PointBoxBatch::HasAVX(void) {
+
+		return false;
+	}
+
+#endif
+
+
+	typedef void (*PointBoxKernel)(const PointSoA &, const BoxSoA &, int *);
+
+	struct KernelChoice {
+		PointBoxKernel kernel;
+		const char *name;
+	};
+
+	static KernelChoice SelectKernel(void) {
+
+		KernelChoice choice;
+		if (PointBoxBatch::HasAVX()) {
+			choice.kernel = PointBoxBatch::FindAVX;
+			choice.name = "avx";
+		}
+		else if (PointBoxBatch::HasSSE2()) {
+			choice.kernel = PointBoxBatch::FindSSE2;
+			choice.name = "sse2";
+		}
+		else {
+			choice.kernel = PointBoxBatch::FindScalar;
+			choice.name = "scalar";
+		}
+		return choice;
+	}
+
+	// Picked once, the first time a batch is tested
+	static const KernelChoice &GetKernel(void) {
+
+		static const KernelChoice choice = SelectKernel();
+		return choice;
+	}
+
+
+	void PointBoxBatch::FindContainingBoxes(const PointSoA &points, const BoxSoA &boxes, int *hits) {
+
+		GetKernel().kernel(points, boxes, hits);
+	}
+
+
+	const char *PointBoxBatch::GetKernelName(void) {
+
+		return GetKernel().name;
+	}
+
+} // namespace game
@@ -0,0 +1,60 @@
+#ifndef POINT_BOX_BATCH_H_
+#define POINT_BOX_BATCH_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "aabb.h"
+
+namespace game {
+
+	// Points in structure-of-arrays layout
+	struct PointSoA {
+		std::vector<float> x, y, z;
+
+		void Clear(void) { x.clear(); y.clear(); z.clear(); }
+		void Add(glm::vec3 point) { x.push_back(point.x); y.push_back(point.y); z.push_back(point.z); }
+		int Size(void) const { return (int) x.size(); }
+	};
+
+	// Boxes in structure-of-arrays layout
+	struct BoxSoA {
+		std::vector<float> min_x, min_y, min_z;
+		std::vector<float> max_x, max_y, max_z;
+
+		void Clear(void);
+		void Add(const AABB &box);
+		int Size(void) const { return (int) min_x.size(); }
+	};
+
+	// Batch test of many points against many boxes
+	//
+	// The vector kernels load 4 (SSE2) or 8 (AVX) points at once and test
+	// them against one box per step, giving a lane mask of the points
+	// inside. A block stops walking the boxes once every lane has a hit.
+	// The widest kernel the CPU supports is picked at run time
+	class PointBoxBatch {
+
+	public:
+		// For every point, store in 'hits' the index of the first box
+		// strictly containing it, or -1. 'hits' holds points.Size() entries
+		static void FindContainingBoxes(const PointSoA &points, const BoxSoA &boxes, int *hits);
+
+		// Name of the kernel FindContainingBoxes uses: "avx", "sse2" or
+		// "scalar"
+		static const char *GetKernelName(void);
+
+		// Individual kernels, for benchmarks. The vector kernels must only
+		// be called when the CPU supports them
+		static void FindScalar(const PointSoA &points, const BoxSoA &boxes, int *hits);
+		static void FindSSE2(const PointSoA &points, const BoxSoA &boxes, int *hits);
+		static void FindAVX(const PointSoA &points, const BoxSoA &boxes, int *hits);
+
+		static bool HasSSE2(void);
+		static bool HasAVX(void);
+
+	}; // class PointBoxBatch
+
+} // namespace game
+
+#endif // POINT_BOX_BATCH_H_
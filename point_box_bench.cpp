@@ -0,0 +1,82 @@
+// Microbenchmark of the point-in-box kernels
+//
+// Tests 10000 projectiles against 1000 boxes on one thread with every
+// kernel the CPU supports, and checks that they agree
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+#include "point_box_batch.h"
+
+using namespace game;
+
+const int bench_points_g = 10000;
+const int bench_boxes_g = 1000;
+const int bench_repeats_g = 20;
+
+static float Random(float min, float max) {
+
+	return min + (max - min) * ((float) rand() / RAND_MAX);
+}
+
+
+// Run a kernel and print its throughput; returns false if its results
+// differ from 'expected'
+static bool Measure(const char *name, void (*kernel)(const PointSoA &, const BoxSoA &, int *), const PointSoA &points, const BoxSoA &boxes, const std::vector<int> &expected) {
+
+	std::vector<int> hits(points.Size());
+	kernel(points, boxes, hits.data());
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < bench_repeats_g; i++) {
+		kernel(points, boxes, hits.data());
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / bench_repeats_g;
+
+	std::cout << std::setw(8) << name
+		<< std::setw(12) << std::fixed << std::setprecision(3) << seconds * 1000.0 << " ms"
+		<< std::setw(14) << std::setprecision(2) << points.Size() / seconds / 1e6 << " Mpoints/s"
+		<< std::setw(14) << (double) points.Size() * boxes.Size() / seconds / 1e9 << " Gtests/s" << std::endl;
+	return hits == expected;
+}
+
+
+int main(void) {
+
+	// A 600 by 600 city like the game's, with most projectiles in the air
+	srand(1);
+	BoxSoA boxes;
+	for (int i = 0; i < bench_boxes_g; i++) {
+		glm::vec3 center(Random(0.0f, 600.0f), 0.0f, Random(0.0f, 600.0f));
+		glm::vec3 half(Random(2.0f, 6.0f), Random(5.0f, 40.0f), Random(2.0f, 6.0f));
+		boxes.Add(AABB(center - half, center + half));
+	}
+	PointSoA points;
+	for (int i = 0; i < bench_points_g; i++) {
+		points.Add(glm::vec3(Random(0.0f, 600.0f), Random(0.0f, 100.0f), Random(0.0f, 600.0f)));
+	}
+
+	std::vector<int> expected(points.Size());
+	PointBoxBatch::FindScalar(points, boxes, expected.data());
+	int inside = 0;
+	for (size_t i = 0; i < expected.size(); i++) {
+		inside += (expected[i] >= 0);
+	}
+	std::cout << bench_points_g << " points, " << bench_boxes_g << " boxes, " << inside << " points inside a box" << std::endl;
+	std::cout << "dispatch picks " << PointBoxBatch::GetKernelName() << std::endl;
+
+	bool ok = Measure("scalar", PointBoxBatch::FindScalar, points, boxes, expected);
+	if (PointBoxBatch::HasSSE2()) {
+		ok = Measure("sse2", PointBoxBatch::FindSSE2, points, boxes, expected) && ok;
+	}
+	if (PointBoxBatch::HasAVX()) {
+		ok = Measure("avx", PointBoxBatch::FindAVX, points, boxes, expected) && ok;
+	}
+	if (!ok) {
+		std::cerr << "Kernels disagree" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,58 @@
+#version 400
+
+// Vertex buffer
+in vec3 vertex;
+in vec3 normal;
+in vec3 color;
+
+// Instance buffer
+in vec4 instance_position; // Position of the projectile; the scale in w is not used
+in vec4 instance_orientation; // Quaternion
+
+// Uniform (global) buffer
+uniform mat4 view_mat;
+uniform float timer;
+
+// Attributes forwarded to the geometry shader
+out vec4 particle_color;
+out float particle_id;
+
+// Simulation parameters (constants)
+uniform vec3 up_vec = vec3(0.0, 1.0, 0.0); // Up direction
+uniform float speed = 10.0; // Control the speed of the motion, also used as the acceleration
+uniform float trail = 0.0; // 1 to stream the particles backwards along the projectile
+
+// Define some useful constants
+const float pi = 3.1415926536;
+const float pi_over_two = 1.5707963268;
+const float two_pi = 2.0*pi;
+
+
+void main()
+{
+    // Define particle id
+    particle_id = color.r; // Derived from the particle color. We use the id to keep track of particles
+
+    // Define time in a cyclic manner
+    float phase = two_pi*particle_id; // Start the sin wave later depending on the particle_id
+    float param = timer + phase; // The constant that divides "timer" also helps to adjust the "speed" of the fire
+    float rem = mod(param, pi_over_two); // Use the remainder of dividing by pi/2 so that we are always in the range [0..pi/2] where sin() gives values in [0..1]
+    float circtime = sin(rem); // Get time value in [0..1], according to a sinusoidal wave
+                                    
+    // Set up parameters of the particle motion
+    float t = abs(circtime)*(0.3 + abs(normal.y)); // Our time parameter
+
+    // First, work in local model coordinates (do not apply any transformation)
+    vec3 position = vertex;
+    position += speed*normal*mix(vec3(1.0), vec3(0.0, 0.0, -1.0), trail)*speed*t*t;
+
+    // Place the particle with the projectile, which is not scaled
+    vec4 q = instance_orientation;
+    position = instance_position.xyz + position + 2.0*cross(q.xyz, cross(q.xyz, position) + q.w*position);
+
+    // Define output position but do not apply the projection matrix yet
+    gl_Position = view_mat * vec4(position, 1.0);
+    // Define amount of blending depending on the cyclic time
+    float alpha = 1.0 - circtime*circtime;
+    particle_color = vec4(1.0, 1.0, 1.0, alpha);
+}
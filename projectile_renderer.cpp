@@ -0,0 +1,169 @@
+#include "projectile_renderer.h"
+#include "engine_counters.h"
+
+namespace game {
+
+	// Look of the fire trailing each type of projectile
+	struct FireStyle {
+		float speed; // How fast particles leave the projectile
+		float particle_size;
+		float trail; // 1 to stream the particles backwards, 0 to spread them
+	};
+
+	const FireStyle fire_styles_g[PROJECTILE_TYPE_COUNT] = {
+		{ 12.0f, 0.2f, 1.0f }, // PLAYER_BULLET
+		{ 12.0f, 0.2f, 1.0f }, // CHILD_BULLET
+		{ 10.0f, 0.5f, 0.0f }, // PLAYER_MISSILE
+		{ 10.0f, 0.5f, 0.0f } // ENEMY_MISSILE
+	};
+
+	// Floats per instance: position and scale, then orientation
+	const int instance_floats_g = 8;
+
+
+	ProjectileRenderer::ProjectileRenderer(void) {
+
+		instance_buffer_ = 0;
+		mesh_ = NULL;
+		material_ = NULL;
+		particles_ = NULL;
+		fire_material_ = NULL;
+		fire_texture_ = NULL;
+	}
+
+
+	ProjectileRenderer::~ProjectileRenderer() {
+
+		if (instance_buffer_) {
+			glDeleteBuffers(1, &instance_buffer_);
+		}
+	}
+
+
+	void ProjectileRenderer::Init(const Resource *mesh, const Resource *material, const Resource *particles, const Resource *fire_material, const Resource *fire_texture) {
+
+		mesh_ = mesh;
+		material_ = material;
+		particles_ = particles;
+		fire_material_ = fire_material;
+		fire_texture_ = fire_texture;
+		if (!instance_buffer_) {
+			glGenBuffers(1, &instance_buffer_);
+		}
+	}
+
+
+	void ProjectileRenderer::Draw(Camera *camera, const ProjectileStore &store, float interpolation, double time) {
+
+		int first[PROJECTILE_TYPE_COUNT], count[PROJECTILE_TYPE_COUNT];
+		store.WriteInstances(instances_, first, count, interpolation);
+		if (instances_.empty() || !instance_buffer_) {
+			return;
+		}
+
+		// Orphan the old buffer so the upload does not wait for the
+		// previous frame to finish drawing
+		GLsizeiptr size = instances_.size() * sizeof(GLfloat);
+		glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+		glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, size, instances_.data());
+
+		// Bodies all share one mesh, so they take a single call
+		glEnable(GL_DEPTH_TEST);
+		glDisable(GL_BLEND);
+		glDepthFunc(GL_LESS);
+		GLuint program = material_->GetResource();
+		glUseProgram(program);
+		camera->SetupShader(program);
+		SetupAttributes(program, mesh_, 0);
+		glDrawElementsInstanced(GL_TRIANGLES, mesh_->GetSize(), GL_UNSIGNED_INT, 0, (GLsizei) (instances_.size() / instance_floats_g));
+		EngineCounters::Add(COUNTER_DRAW_CALLS);
+		ResetAttributes(program);
+
+		// Fire particles, blended like particle scene nodes
+		glDisable(GL_DEPTH_TEST);
+		glEnable(GL_BLEND);
+		glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glBlendEquationSeparate(GL_FUNC_ADD, GL_MAX);
+		glDepthFunc(GL_ALWAYS);
+		program = fire_material_->GetResource();
+		glUseProgram(program);
+		camera->SetupShader(program);
+		glUniform1f(glGetUniformLocation(program, "timer"), (float) time);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, fire_texture_->GetResource());
+		glUniform1i(glGetUniformLocation(program, "tex_samp"), 0);
+		// Both programs take the camera matrices
+		EngineCounters::Add(COUNTER_PROGRAM_BINDS, 2);
+		EngineCounters::Add(COUNTER_TEXTURE_BINDS);
+		EngineCounters::Add(COUNTER_UNIFORM_UPLOADS, 2 * 2 + 2);
+		EngineCounters::Add(COUNTER_BUFFER_BINDS);
+
+		for (int type = 0; type < PROJECTILE_TYPE_COUNT; type++) {
+			if (count[type] == 0) {
+				continue;
+			}
+			const FireStyle &style = fire_styles_g[type];
+			glUniform1f(glGetUniformLocation(program, "speed"), style.speed);
+			glUniform1f(glGetUniformLocation(program, "particle_size"), style.particle_size);
+			glUniform1f(glGetUniformLocation(program, "trail"), style.trail);
+			SetupAttributes(program, particles_, first[type]);
+			glDrawArraysInstanced(GL_POINTS, 0, particles_->GetSize(), count[type]);
+			EngineCounters::Add(COUNTER_DRAW_CALLS);
+			EngineCounters::Add(COUNTER_UNIFORM_UPLOADS, 3);
+		}
+		ResetAttributes(program);
+	}
+
+
+	void ProjectileRenderer::SetupAttributes(GLuint program, const Resource *geometry, int first) {
+
+		// Per-vertex data, laid out as in SceneNode
+		glBindBuffer(GL_ARRAY_BUFFER, geometry->GetArrayBuffer());
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, geometry->GetElementArrayBuffer());
+		const char *names[] = { "vertex", "normal", "color", "uv" };
+		const int sizes[] = { 3, 3, 3, 2 };
+		int offset = 0;
+		for (int i = 0; i < 4; i++) {
+			GLint att = glGetAttribLocation(program, names[i]);
+			if (att >= 0) {
+				glVertexAttribPointer(att, sizes[i], GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (void *) (offset * sizeof(GLfloat)));
+				glEnableVertexAttribArray(att);
+			}
+			offset += sizes[i];
+		}
+
+		// Per-instance data, starting at projectile 'first'
+		glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+		EngineCounters::Add(COUNTER_BUFFER_BINDS, 3);
+		size_t base = first * instance_floats_g * sizeof(GLfloat);
+		GLint position_att = glGetAttribLocation(program, "instance_position");
+		if (position_att >= 0) {
+			glVertexAttribPointer(position_att, 4, GL_FLOAT, GL_FALSE, instance_floats_g * sizeof(GLfloat), (void *) base);
+			glVertexAttribDivisor(position_att, 1);
+			glEnableVertexAttribArray(position_att);
+		}
+		GLint orientation_att = glGetAttribLocation(program, "instance_orientation");
+		if (orientation_att >= 0) {
+			glVertexAttribPointer(orientation_att, 4, GL_FLOAT, GL_FALSE, instance_floats_g * sizeof(GLfloat), (void *) (base + 4 * sizeof(GLfloat)));
+			glVertexAttribDivisor(orientation_att, 1);
+			glEnableVertexAttribArray(orientation_att);
+		}
+	}
+
+
+	void ProjectileRenderer::ResetAttributes(GLuint program) {
+
+		// Scene nodes share attribute slots with these programs and expect
+		// every attribute to advance per vertex
+		const char *names[] = { "instance_position", "instance_orientation" };
+		for (int i = 0; i < 2; i++) {
+			GLint att = glGetAttribLocation(program, names[i]);
+			if (att >= 0) {
+				glVertexAttribDivisor(att, 0);
+				glDisableVertexAttribArray(att);
+			}
+		}
+	}
+
+} // namespace game
@@ -0,0 +1,52 @@
+#ifndef PROJECTILE_RENDERER_H_
+#define PROJECTILE_RENDERER_H_
+
+#include <vector>
+#define GLEW_STATIC
+#include <GL/glew.h>
+
+#include "resource.h"
+#include "camera.h"
+#include "projectile_store.h"
+
+namespace game {
+
+	// Draws all projectiles with instancing
+	//
+	// Each frame the draw data of the store is uploaded to one instance
+	// buffer. Every projectile type then takes two instanced calls: the
+	// body mesh, and the fire particles that trail it
+	class ProjectileRenderer {
+
+	public:
+		ProjectileRenderer(void);
+		~ProjectileRenderer();
+
+		// Set the resources shared by all projectiles and create the
+		// instance buffer. Needs a current OpenGL context
+		void Init(const Resource *mesh, const Resource *material, const Resource *particles, const Resource *fire_material, const Resource *fire_texture);
+
+		// Draw the projectiles 'interpolation' of a tick past their
+		// previous positions, with the fire animated to simulation 'time'
+		void Draw(Camera *camera, const ProjectileStore &store, float interpolation, double time);
+
+	private:
+		GLuint instance_buffer_;
+		std::vector<float> instances_;
+
+		const Resource *mesh_;
+		const Resource *material_;
+		const Resource *particles_;
+		const Resource *fire_material_;
+		const Resource *fire_texture_;
+
+		// Bind the vertex layout of 'geometry' and the instance attributes
+		// of 'first' onwards to 'program'
+		void SetupAttributes(GLuint program, const Resource *geometry, int first);
+		void ResetAttributes(GLuint program);
+
+	}; // class ProjectileRenderer
+
+} // namespace game
+
+#endif // PROJECTILE_RENDERER_H_
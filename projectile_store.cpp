@@ -0,0 +1,244 @@
+#include "projectile_store.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PROJECTILE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace game {
+
+	ProjectileStore::ProjectileStore(void) {
+	}
+
+
+	ProjectileStore::~ProjectileStore() {
+	}
+
+
+	int ProjectileStore::Add(const Projectile &projectile, float lifetime) {
+
+		glm::vec3 direction = glm::normalize(projectile.direction);
+		position_.Add(projectile.position);
+		previous_.Add(projectile.position);
+		direction_x_.push_back(direction.x);
+		direction_y_.push_back(direction.y);
+		direction_z_.push_back(direction.z);
+		speed_.push_back(projectile.speed);
+		floor_.push_back(projectile.floor);
+		lifetime_.push_back(lifetime);
+		type_.push_back((unsigned char) projectile.type);
+		alive_.push_back(1);
+		orientation_.push_back(projectile.orientation);
+		scale_.push_back(projectile.scale);
+		return Size() - 1;
+	}
+
+
+	void ProjectileStore::Integrate(glm::vec3 world_min, glm::vec3 world_max, float delta_time) {
+
+		int count = Size();
+		int blocks = 0;
+
+#ifdef PROJECTILE_SSE2
+		// Four projectiles per step; the bounds test gives a lane mask
+		// that clears the alive flag of the ones that left the world
+		blocks = count & ~3;
+		__m128 min_x = _mm_set1_ps(world_min.x);
+		__m128 min_z = _mm_set1_ps(world_min.z);
+		__m128 max_x = _mm_set1_ps(world_max.x);
+		__m128 max_y = _mm_set1_ps(world_max.y);
+		__m128 max_z = _mm_set1_ps(world_max.z);
+		__m128 dt = _mm_set1_ps(delta_time);
+		__m128 zero = _mm_setzero_ps();
+		for (int i = 0; i < blocks; i += 4) {
+			__m128 x = _mm_loadu_ps(&position_.x[i]);
+			__m128 y = _mm_loadu_ps(&position_.y[i]);
+			__m128 z = _mm_loadu_ps(&position_.z[i]);
+			_mm_storeu_ps(&previous_.x[i], x);
+			_mm_storeu_ps(&previous_.y[i], y);
+			_mm_storeu_ps(&previous_.z[i], z);
+
+			__m128 speed = _mm_loadu_ps(&speed_[i]);
+			x = _mm_add_ps(x, _mm_mul_ps(_mm_loadu_ps(&direction_x_[i]), speed));
+			y = _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(&direction_y_[i]), speed));
+			z = _mm_add_ps(z, _mm_mul_ps(_mm_loadu_ps(&direction_z_[i]), speed));
+			_mm_storeu_ps(&position_.x[i], x);
+			_mm_storeu_ps(&position_.y[i], y);
+			_mm_storeu_ps(&position_.z[i], z);
+
+			__m128 lifetime = _mm_sub_ps(_mm_loadu_ps(&lifetime_[i]), dt);
+			_mm_storeu_ps(&lifetime_[i], lifetime);
+
+			__m128 inside = _mm_and_ps(_mm_cmpge_ps(x, min_x), _mm_cmple_ps(x, max_x));
+			inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(z, min_z), _mm_cmple_ps(z, max_z)));
+			inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(y, _mm_loadu_ps(&floor_[i])), _mm_cmple_ps(y, max_y)));
+			inside = _mm_and_ps(inside, _mm_cmpgt_ps(lifetime, zero));
+			int mask = _mm_movemask_ps(inside);
+			alive_[i] &= mask & 1;
+			alive_[i + 1] &= (mask >> 1) & 1;
+			alive_[i + 2] &= (mask >> 2) & 1;
+			alive_[i + 3] &= (mask >> 3) & 1;
+		}
+#endif
+
+		IntegrateRange(blocks, count, world_min, world_max, delta_time);
+	}
+
+
+	void ProjectileStore::IntegrateRange(int begin, int end, glm::vec3 world_min, glm::vec3 world_max, float delta_time) {
+
+		for (int i = begin; i < end; i++) {
+			previous_.x[i] = position_.x[i];
+			previous_.y[i] = position_.y[i];
+			previous_.z[i] = position_.z[i];
+			float x = position_.x[i] += direction_x_[i] * speed_[i];
+			float y = position_.y[i] += direction_y_[i] * speed_[i];
+			float z = position_.z[i] += direction_z_[i] * speed_[i];
+			lifetime_[i] -= delta_time;
+
+			bool inside = x >= world_min.x && x <= world_max.x && z >= world_min.z && z <= world_max.z &&
+				y >= floor_[i] && y <= world_max.y && lifetime_[i] > 0.0f;
+			alive_[i] &= inside ? 1 : 0;
+		}
+	}
+
+
+	void ProjectileStore::Kill(int index) {
+
+		alive_[index] = 0;
+	}
+
+
+	bool ProjectileStore::IsAlive(int index) const {
+
+		return alive_[index] != 0;
+	}
+
+
+	void ProjectileStore::Compact(void) {
+
+		int i = 0;
+		while (i < Size()) {
+			if (alive_[i]) {
+				i++;
+			}
+			else {
+				MoveLast(i);
+			}
+		}
+	}
+
+
+	void ProjectileStore::MoveLast(int index) {
+
+		int last = Size() - 1;
+		position_.x[index] = position_.x[last];
+		position_.y[index] = position_.y[last];
+		position_.z[index] = position_.z[last];
+		previous_.x[index] = previous_.x[last];
+		previous_.y[index] = previous_.y[last];
+		previous_.z[index] = previous_.z[last];
+		direction_x_[index] = direction_x_[last];
+		direction_y_[index] = direction_y_[last];
+		direction_z_[index] = direction_z_[last];
+		speed_[index] = speed_[last];
+		floor_[index] = floor_[last];
+		lifetime_[index] = lifetime_[last];
+		type_[index] = type_[last];
+		alive_[index] = alive_[last];
+		orientation_[index] = orientation_[last];
+		scale_[index] = scale_[last];
+
+		position_.x.pop_back();
+		position_.y.pop_back();
+		position_.z.pop_back();
+		previous_.x.pop_back();
+		previous_.y.pop_back();
+		previous_.z.pop_back();
+		direction_x_.pop_back();
+		direction_y_.pop_back();
+		direction_z_.pop_back();
+		speed_.pop_back();
+		floor_.pop_back();
+		lifetime_.pop_back();
+		type_.pop_back();
+		alive_.pop_back();
+		orientation_.pop_back();
+		scale_.pop_back();
+	}
+
+
+	int ProjectileStore::Size(void) const {
+
+		return position_.Size();
+	}
+
+
+	ProjectileType ProjectileStore::GetType(int index) const {
+
+		return (ProjectileType) type_[index];
+	}
+
+
+	glm::vec3 ProjectileStore::GetPosition(int index) const {
+
+		return glm::vec3(position_.x[index], position_.y[index], position_.z[index]);
+	}
+
+
+	void ProjectileStore::SetPosition(int index, glm::vec3 position) {
+
+		position_.x[index] = position.x;
+		position_.y[index] = position.y;
+		position_.z[index] = position.z;
+	}
+
+
+	glm::vec3 ProjectileStore::GetPreviousPosition(int index) const {
+
+		return glm::vec3(previous_.x[index], previous_.y[index], previous_.z[index]);
+	}
+
+
+	const PointSoA &ProjectileStore::GetPositions(void) const {
+
+		return position_;
+	}
+
+
+	void ProjectileStore::WriteInstances(std::vector<float> &instances, int first[PROJECTILE_TYPE_COUNT], int count[PROJECTILE_TYPE_COUNT], float interpolation) const {
+
+		// Counting sort by type
+		for (int type = 0; type < PROJECTILE_TYPE_COUNT; type++) {
+			count[type] = 0;
+		}
+		for (int i = 0; i < Size(); i++) {
+			if (alive_[i]) {
+				count[type_[i]]++;
+			}
+		}
+		int total = 0;
+		int next[PROJECTILE_TYPE_COUNT];
+		for (int type = 0; type < PROJECTILE_TYPE_COUNT; type++) {
+			first[type] = next[type] = total;
+			total += count[type];
+		}
+
+		instances.resize(total * 8);
+		for (int i = 0; i < Size(); i++) {
+			if (!alive_[i]) {
+				continue;
+			}
+			float *instance = &instances[8 * next[type_[i]]++];
+			instance[0] = previous_.x[i] + (position_.x[i] - previous_.x[i]) * interpolation;
+			instance[1] = previous_.y[i] + (position_.y[i] - previous_.y[i]) * interpolation;
+			instance[2] = previous_.z[i] + (position_.z[i] - previous_.z[i]) * interpolation;
+			instance[3] = scale_[i];
+			instance[4] = orientation_[i].x;
+			instance[5] = orientation_[i].y;
+			instance[6] = orientation_[i].z;
+			instance[7] = orientation_[i].w;
+		}
+	}
+
+} // namespace game
@@ -0,0 +1,97 @@
+#ifndef PROJECTILE_STORE_H_
+#define PROJECTILE_STORE_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+#define GLM_FORCE_RADIANS
+#include <glm/gtc/quaternion.hpp>
+
+#include "point_box_batch.h"
+
+namespace game {
+
+	// Kinds of projectiles
+	enum ProjectileType {
+		PLAYER_BULLET = 0,
+		CHILD_BULLET = 1,
+		PLAYER_MISSILE = 2, // Explodes against buildings
+		ENEMY_MISSILE = 3,
+		PROJECTILE_TYPE_COUNT = 4
+	};
+
+	// Description of a new projectile
+	struct Projectile {
+		ProjectileType type;
+		float speed; // Distance covered per update
+		float floor; // Height under which the projectile is discarded
+		glm::vec3 direction;
+		glm::vec3 position;
+		glm::quat orientation; // Only used to draw it
+		float scale; // Only used to draw it
+	};
+
+	// All projectiles in flight, in structure-of-arrays layout
+	//
+	// Projectiles are not scene nodes: they are moved by one pass over
+	// plain float arrays and drawn with one instanced call per type.
+	// Projectiles are addressed by index. Kill only marks a projectile;
+	// Compact removes the dead ones by moving the last projectile into
+	// their slot, so indices are stable from one Compact to the next
+	class ProjectileStore {
+
+	public:
+		ProjectileStore(void);
+		~ProjectileStore();
+
+		// Add a projectile and return its index. 'lifetime' is in seconds
+		int Add(const Projectile &projectile, float lifetime);
+
+		// Move every projectile one step along its direction, and kill
+		// the ones that leave the box between 'world_min' and 'world_max',
+		// fall under their floor or run out of lifetime
+		void Integrate(glm::vec3 world_min, glm::vec3 world_max, float delta_time);
+
+		void Kill(int index);
+		bool IsAlive(int index) const;
+
+		// Remove the projectiles killed so far
+		void Compact(void);
+
+		int Size(void) const;
+		ProjectileType GetType(int index) const;
+		glm::vec3 GetPosition(int index) const;
+		void SetPosition(int index, glm::vec3 position);
+		// Position before the last Integrate
+		glm::vec3 GetPreviousPosition(int index) const;
+
+		// Positions of all projectiles, for batch tests
+		const PointSoA &GetPositions(void) const;
+
+		// Write the draw data of the live projectiles grouped by type: 8
+		// floats each, the position and scale then the orientation. Sets
+		// 'first' and 'count' to the range of each type, in projectiles.
+		// Positions are 'interpolation' of the way from the previous tick
+		void WriteInstances(std::vector<float> &instances, int first[PROJECTILE_TYPE_COUNT], int count[PROJECTILE_TYPE_COUNT], float interpolation) const;
+
+	private:
+		PointSoA position_;
+		PointSoA previous_;
+		std::vector<float> direction_x_; // Normalized
+		std::vector<float> direction_y_;
+		std::vector<float> direction_z_;
+		std::vector<float> speed_;
+		std::vector<float> floor_;
+		std::vector<float> lifetime_; // Seconds left
+		std::vector<unsigned char> type_;
+		std::vector<unsigned char> alive_;
+		std::vector<glm::quat> orientation_;
+		std::vector<float> scale_;
+
+		void IntegrateRange(int begin, int end, glm::vec3 world_min, glm::vec3 world_max, float delta_time);
+		void MoveLast(int index);
+
+	}; // class ProjectileStore
+
+} // namespace game
+
+#endif // PROJECTILE_STORE_H_
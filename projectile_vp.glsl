@@ -0,0 +1,32 @@
+#version 130
+
+// Vertex buffer
+in vec3 vertex;
+in vec3 color;
+
+// Instance buffer
+in vec4 instance_position; // Position, with the scale in w
+in vec4 instance_orientation; // Quaternion
+
+// Uniform (global) buffer
+uniform mat4 view_mat;
+uniform mat4 projection_mat;
+
+// Attributes forwarded to the fragment shader
+out vec4 color_interp;
+
+
+// Rotate a vector by a unit quaternion
+vec3 rotate(vec4 q, vec3 v)
+{
+    return v + 2.0*cross(q.xyz, cross(q.xyz, v) + q.w*v);
+}
+
+
+void main()
+{
+    vec3 position = instance_position.xyz + rotate(instance_orientation, vertex*instance_position.w);
+    gl_Position = projection_mat * view_mat * vec4(position, 1.0);
+
+    color_interp = vec4(color, 1.0);
+}
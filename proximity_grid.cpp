@@ -0,0 +1,223 @@
+#include <cmath>
+
+#include "proximity_grid.h"
+
+namespace game {
+
+	ProximityGrid::ProximityGrid(void) {
+
+		cell_size_ = 1.0f;
+		size_ = 0;
+	}
+
+
+	ProximityGrid::~ProximityGrid() {
+	}
+
+
+	void ProximityGrid::Reset(float cell_size) {
+
+		cell_size_ = cell_size;
+		size_ = 0;
+		cells_.clear();
+		cell_index_.clear();
+		slots_.clear();
+	}
+
+
+	void ProximityGrid::Insert(EntityId entity, glm::vec3 position) {
+
+		if (Has(entity)) {
+			Move(entity, position);
+			return;
+		}
+		uint32_t index = GetEntityIndex(entity);
+		if (index >= slots_.size()) {
+			Slot empty = { -1, -1 };
+			slots_.resize(index + 1, empty);
+		}
+		// An entity that died without being removed gives its place up
+		// to the one reusing its index
+		if (slots_[index].cell >= 0) {
+			Detach(index);
+			size_--;
+		}
+
+		int cell = GetCell(position);
+		Entry entry = { entity, position };
+		slots_[index].cell = cell;
+		slots_[index].index = (int) cells_[cell].entries.size();
+		cells_[cell].entries.push_back(entry);
+		size_++;
+	}
+
+
+	void ProximityGrid::Move(EntityId entity, glm::vec3 position) {
+
+		if (!Has(entity)) {
+			return;
+		}
+
+		// Staying in the same cell is the common case
+		Slot &slot = slots_[GetEntityIndex(entity)];
+		Cell &current = cells_[slot.cell];
+		if (current.column == GetCoordinate(position.x) && current.row == GetCoordinate(position.z)) {
+			current.entries[slot.index].position = position;
+			return;
+		}
+
+		Detach(GetEntityIndex(entity));
+		size_--;
+		Insert(entity, position);
+	}
+
+
+	void ProximityGrid::Remove(EntityId entity) {
+
+		if (!Has(entity)) {
+			return;
+		}
+		Detach(GetEntityIndex(entity));
+		size_--;
+	}
+
+
+	bool ProximityGrid::Has(EntityId entity) const {
+
+		uint32_t index = GetEntityIndex(entity);
+		if (index >= slots_.size() || slots_[index].cell < 0) {
+			return false;
+		}
+		const Slot &slot = slots_[index];
+		return cells_[slot.cell].entries[slot.index].entity == entity;
+	}
+
+
+	int ProximityGrid::Size(void) const {
+
+		return size_;
+	}
+
+
+	int ProximityGrid::Query(glm::vec3 center, float radius, std::vector<EntityId> &entities) const {
+
+		int first_column = GetCoordinate(center.x - radius);
+		int last_column = GetCoordinate(center.x + radius);
+		int first_row = GetCoordinate(center.z - radius);
+		int last_row = GetCoordinate(center.z + radius);
+		float radius2 = radius * radius;
+
+		// A large radius can cover more cells than exist, in which case
+		// walking the existing cells is cheaper than looking each one up
+		int tested = 0;
+		double covered = ((double) last_column - first_column + 1) * ((double) last_row - first_row + 1);
+		if (covered > (double) cells_.size()) {
+			for (size_t i = 0; i < cells_.size(); i++) {
+				const Cell &cell = cells_[i];
+				if (cell.column >= first_column && cell.column <= last_column && cell.row >= first_row && cell.row <= last_row) {
+					tested += QueryCell(cell, center, radius2, entities);
+				}
+			}
+		} else {
+			for (int row = first_row; row <= last_row; row++) {
+				for (int column = first_column; column <= last_column; column++) {
+					int cell = FindCell(column, row);
+					if (cell >= 0) {
+						tested += QueryCell(cells_[cell], center, radius2, entities);
+					}
+				}
+			}
+		}
+		return tested;
+	}
+
+
+	int ProximityGrid::GetCoordinate(float coordinate) const {
+
+		return (int) std::floor(coordinate / cell_size_);
+	}
+
+
+	unsigned long long ProximityGrid::GetKey(int column, int row) const {
+
+		return ((unsigned long long) (unsigned int) column << 32) | (unsigned int) row;
+	}
+
+
+	int ProximityGrid::FindCell(int column, int row) const {
+
+		std::unordered_map<unsigned long long, int>::const_iterator it = cell_index_.find(GetKey(column, row));
+		return it == cell_index_.end() ? -1 : it->second;
+	}
+
+
+	int ProximityGrid::GetCell(glm::vec3 position) {
+
+		int column = GetCoordinate(position.x);
+		int row = GetCoordinate(position.z);
+		int cell = FindCell(column, row);
+		if (cell < 0) {
+			cell = (int) cells_.size();
+			Cell created;
+			created.column = column;
+			created.row = row;
+			cells_.push_back(created);
+			cell_index_[GetKey(column, row)] = cell;
+		}
+		return cell;
+	}
+
+
+	void ProximityGrid::Detach(uint32_t index) {
+
+		// Swap the last entry of the cell into the hole
+		Slot &slot = slots_[index];
+		std::vector<Entry> &entries = cells_[slot.cell].entries;
+		int last = (int) entries.size() - 1;
+		if (slot.index != last) {
+			entries[slot.index] = entries[last];
+			slots_[GetEntityIndex(entries[slot.index].entity)].index = slot.index;
+		}
+		entries.pop_back();
+		int emptied = entries.empty() ? slot.cell : -1;
+		slot.cell = -1;
+
+		// An empty cell is dropped, so the cells follow where the
+		// entities are rather than everywhere they have been
+		if (emptied >= 0) {
+			DropCell(emptied);
+		}
+	}
+
+
+	void ProximityGrid::DropCell(int cell) {
+
+		// Swap the last cell into the hole, and point its entities and
+		// its key at its new place
+		cell_index_.erase(GetKey(cells_[cell].column, cells_[cell].row));
+		int last = (int) cells_.size() - 1;
+		if (cell != last) {
+			cells_[cell].column = cells_[last].column;
+			cells_[cell].row = cells_[last].row;
+			cells_[cell].entries.swap(cells_[last].entries);
+			cell_index_[GetKey(cells_[cell].column, cells_[cell].row)] = cell;
+			for (size_t i = 0; i < cells_[cell].entries.size(); i++) {
+				slots_[GetEntityIndex(cells_[cell].entries[i].entity)].cell = cell;
+			}
+		}
+		cells_.pop_back();
+	}
+
+
+	int ProximityGrid::QueryCell(const Cell &cell, glm::vec3 center, float radius2, std::vector<EntityId> &entities) const {
+
+		for (size_t i = 0; i < cell.entries.size(); i++) {
+			glm::vec3 offset = cell.entries[i].position - center;
+			if (glm::dot(offset, offset) <= radius2) {
+				entities.push_back(cell.entries[i].entity);
+			}
+		}
+		return (int) cell.entries.size();
+	}
+
+} // namespace game
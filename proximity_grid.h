@@ -0,0 +1,78 @@
+#ifndef PROXIMITY_GRID_H_
+#define PROXIMITY_GRID_H_
+
+#include <vector>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include "component_array.h"
+
+namespace game {
+
+	// Entities kept in square cells over the XZ plane, for radius queries
+	//
+	// The grid is never rebuilt; entities are updated one at a time.
+	// Moving within a cell only stores the new position, and crossing into
+	// another cell is a swap-remove from the old cell plus an append to
+	// the new one. Cells are created on first use and dropped once empty,
+	// so the grid has no bounds. Entities are placed by index; an entity inserted over a dead
+	// one holding its index takes its place
+	class ProximityGrid {
+
+	public:
+		ProximityGrid(void);
+		~ProximityGrid();
+
+		// Remove all entities and set the side of the cells
+		void Reset(float cell_size);
+
+		// Add an entity, or move it if it is already in the grid
+		void Insert(EntityId entity, glm::vec3 position);
+
+		// Update the position of an entity in the grid
+		void Move(EntityId entity, glm::vec3 position);
+
+		// Remove an entity, if it is in the grid
+		void Remove(EntityId entity);
+
+		bool Has(EntityId entity) const;
+		int Size(void) const;
+
+		// Append to 'entities' every entity within 'radius' of 'center'.
+		// Returns how many entities were tested against the radius
+		int Query(glm::vec3 center, float radius, std::vector<EntityId> &entities) const;
+
+	private:
+		struct Entry {
+			EntityId entity;
+			glm::vec3 position;
+		};
+		struct Cell {
+			int column;
+			int row;
+			std::vector<Entry> entries;
+		};
+		struct Slot {
+			int cell; // Index in cells_, or -1 if the entity is not in the grid
+			int index; // Index in the entries of the cell
+		};
+
+		float cell_size_;
+		int size_;
+		std::vector<Cell> cells_;
+		std::unordered_map<unsigned long long, int> cell_index_; // Cell coordinates -> cells_
+		std::vector<Slot> slots_; // Entity index -> place in the grid
+
+		int GetCoordinate(float coordinate) const;
+		unsigned long long GetKey(int column, int row) const;
+		int FindCell(int column, int row) const;
+		int GetCell(glm::vec3 position);
+		void Detach(uint32_t index);
+		void DropCell(int cell);
+		int QueryCell(const Cell &cell, glm::vec3 center, float radius2, std::vector<EntityId> &entities) const;
+
+	}; // class ProximityGrid
+
+} // namespace game
+
+#endif // PROXIMITY_GRID_H_
@@ -0,0 +1,71 @@
+#include "random.h"
+
+namespace game {
+
+	Random::Random(void) {
+
+		Seed(0, 0);
+	}
+
+
+	Random::Random(uint64_t seed, uint64_t stream) {
+
+		Seed(seed, stream);
+	}
+
+
+	void Random::Seed(uint64_t seed, uint64_t stream) {
+
+		// Initialization from the PCG reference implementation
+		state_ = 0;
+		increment_ = (stream << 1) | 1;
+		Next();
+		state_ += seed;
+		Next();
+	}
+
+
+	uint32_t Random::Next(void) {
+
+		uint64_t old = state_;
+		state_ = old * 6364136223846793005ULL + increment_;
+		uint32_t xorshifted = (uint32_t) (((old >> 18) ^ old) >> 27);
+		uint32_t rotation = (uint32_t) (old >> 59);
+		return (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31));
+	}
+
+
+	int Random::NextInt(int count) {
+
+		// Scale the 32 bits to the range; the bias is below 2^-32 * count
+		return (int) (((uint64_t) Next() * (uint32_t) count) >> 32);
+	}
+
+
+	float Random::NextFloat(void) {
+
+		// 24 bits fill the mantissa exactly, so the result is below 1
+		return (float) (Next() >> 8) * (1.0f / 16777216.0f);
+	}
+
+
+	float Random::NextFloat(float min, float max) {
+
+		return min + (max - min) * NextFloat();
+	}
+
+
+	void Random::GetState(uint64_t &state, uint64_t &increment) const {
+
+		state = state_;
+		increment = increment_;
+	}
+
+
+	void Random::SetState(uint64_t state, uint64_t increment) {
+
+		state_ = state;
+		increment_ = increment;
+	}
+
+} // namespace game
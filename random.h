@@ -0,0 +1,43 @@
+#ifndef RANDOM_H_
+#define RANDOM_H_
+
+#include <stdint.h>
+
+namespace game {
+
+	// Small seedable random generator (PCG32)
+	//
+	// Each generator is a 64-bit state and a stream selector. Generators
+	// with the same seed and stream give the same sequence on every
+	// platform, and different streams are independent, so each subsystem
+	// or each piece of the world can own one
+	class Random {
+
+	public:
+		Random(void);
+		Random(uint64_t seed, uint64_t stream = 0);
+
+		void Seed(uint64_t seed, uint64_t stream = 0);
+
+		uint32_t Next(void);
+
+		// Uniform integer in [0, count), count > 0
+		int NextInt(int count);
+
+		// Uniform float in [0, 1), or in [min, max)
+		float NextFloat(void);
+		float NextFloat(float min, float max);
+
+		// Raw state, to save a generator and resume it later
+		void GetState(uint64_t &state, uint64_t &increment) const;
+		void SetState(uint64_t state, uint64_t increment);
+
+	private:
+		uint64_t state_;
+		uint64_t increment_; // Odd; selects the stream
+
+	}; // class Random
+
+} // namespace game
+
+#endif // RANDOM_H_
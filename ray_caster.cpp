@@ -0,0 +1,73 @@
+#include "ray_caster.h"
+
+namespace game {
+
+	// Rays handed to a worker at a time
+	const int ray_cast_grain_g = 8;
+
+
+	RayCaster::RayCaster(void) {
+	}
+
+
+	RayCaster::~RayCaster() {
+	}
+
+
+	void RayCaster::SetOccluders(const std::vector<const StaticBVH *> &occluders) {
+
+		occluders_ = occluders;
+	}
+
+
+	void RayCaster::SetTargets(const std::vector<AABB> &boxes) {
+
+		targets_.Build(boxes);
+	}
+
+
+	int RayCaster::AddRay(glm::vec3 origin, glm::vec3 direction, float max_distance) {
+
+		Ray ray = { origin, direction, max_distance };
+		rays_.push_back(ray);
+		return (int) rays_.size() - 1;
+	}
+
+
+	void RayCaster::Cast(JobSystem &jobs) {
+
+		hits_.resize(rays_.size());
+		jobs.ParallelFor((int) rays_.size(), ray_cast_grain_g, [&](int begin, int end) {
+			for (int i = begin; i < end; i++) {
+				const Ray &ray = rays_[i];
+
+				// The first occluder shortens the ray, so targets behind
+				// it are never reached
+				float max_distance = ray.max_distance;
+				RayHit hit;
+				for (size_t o = 0; o < occluders_.size(); o++) {
+					if (occluders_[o]->IntersectRay(ray.origin, ray.direction, max_distance, hit)) {
+						max_distance = hit.t;
+					}
+				}
+				if (!targets_.IntersectRay(ray.origin, ray.direction, max_distance, hits_[i])) {
+					hits_[i].item = -1;
+				}
+			}
+		});
+		rays_.clear();
+	}
+
+
+	int RayCaster::GetRayCount(void) const {
+
+		return (int) hits_.size();
+	}
+
+
+	const RayHit &RayCaster::GetHit(int ray) const {
+
+		return hits_[ray];
+	}
+
+} // namespace game
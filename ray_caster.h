@@ -0,0 +1,61 @@
+#ifndef RAY_CASTER_H_
+#define RAY_CASTER_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "aabb.h"
+#include "static_bvh.h"
+#include "job_system.h"
+
+namespace game {
+
+	// Casts batches of rays against moving targets and static occluders
+	//
+	// Targets are boxes handed over every frame; they go into a hierarchy
+	// rebuilt by SetTargets, which for a few hundred boxes costs less than
+	// testing every ray against every box. Occluders are the hierarchies
+	// of the static world, one per chunk. Each ray reports the closest
+	// target in front of the first occluder it meets
+	class RayCaster {
+
+	public:
+		RayCaster(void);
+		~RayCaster();
+
+		// Geometry that stops rays. The hierarchies are kept by pointer
+		void SetOccluders(const std::vector<const StaticBVH *> &occluders);
+
+		// Replace the targets; rays report target i for boxes[i]
+		void SetTargets(const std::vector<AABB> &boxes);
+
+		// Queue a ray for the next Cast and return its index
+		int AddRay(glm::vec3 origin, glm::vec3 direction, float max_distance);
+
+		// Cast the queued rays, spread over the workers, then clear the
+		// queue. Results stay available until the next Cast
+		void Cast(JobSystem &jobs);
+
+		int GetRayCount(void) const;
+
+		// Result of a ray of the last Cast: 'item' is the target hit, or
+		// -1 if the ray hit nothing or an occluder came first
+		const RayHit &GetHit(int ray) const;
+
+	private:
+		struct Ray {
+			glm::vec3 origin;
+			glm::vec3 direction;
+			float max_distance;
+		};
+
+		std::vector<const StaticBVH *> occluders_;
+		StaticBVH targets_;
+		std::vector<Ray> rays_;
+		std::vector<RayHit> hits_;
+
+	}; // class RayCaster
+
+} // namespace game
+
+#endif // RAY_CASTER_H_
@@ -0,0 +1,463 @@
+// Performance regression benchmark of whole game sessions
+//
+// Runs a set of workloads, each in a fresh game: built-in sessions that
+// hold one kind of input for the whole run, and any input recordings
+// given with --replay. Every workload is drawn offscreen, or only
+// simulated with --headless, and measured: percentiles of tick and frame
+// times, heap allocations and draw calls. The results are written as
+// JSON, and compared with an earlier result given with --baseline.
+//
+// Options:
+//   --ticks N             ticks of each built-in workload (default 1200);
+//                         caps recordings too when given
+//   --headless            simulate only; no frame times or draw calls
+//   --enemies N           scatter N more enemies in built-in workloads
+//   --replay PATH         also run the input recorded in PATH, with the
+//                         settings it was recorded with; may be repeated
+//   --out PATH            write the results to PATH (default
+//                         replay_bench.json)
+//   --baseline PATH       compare with the results in PATH and exit with
+//                         1 if any workload got slower
+//   --time-threshold F    fraction a time percentile may grow by before
+//                         it is a regression (default 0.10)
+//   --count-threshold F   fraction allocations and draw calls per tick
+//                         may grow by (default 0)
+//
+// Times only compare on the machine that made the baseline, so CI keeps
+// the result of its previous run and passes it with --baseline. The
+// checked-in replay_bench.baseline.json holds the counts alone, from a
+// headless run at the default ticks: allocations do not depend on the
+// machine, only on the code and the standard library. CTest runs it as
+// the replay_bench_baseline test. After a change that allocates more or
+// less on purpose, write it again with
+//
+//   replay_bench --headless --out replay_bench.baseline.json
+//
+// and delete the "seconds" and "*_ms" members. A baseline is only
+// compared with a run of the same mode and ticks
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+
+#include "game.h"
+#include "engine_counters.h"
+
+using namespace game;
+
+const int default_ticks_g = 1200;
+const std::string default_out_path_g = "replay_bench.json";
+const double default_time_threshold_g = 0.10;
+const float idle_turn_g = 2.0f; // Mouse pixels per tick of the built-in sessions
+
+
+// Holds the same input for every tick
+class HeldInput : public InputSource {
+
+public:
+	HeldInput(uint32_t buttons, glm::vec2 mouse) {
+		input_.buttons = buttons;
+		input_.mouse = mouse;
+	}
+
+	virtual bool Next(TickInput &input) {
+		input = input_;
+		return true;
+	}
+
+private:
+	TickInput input_;
+
+}; // class HeldInput
+
+
+// Session run by the benchmark
+struct Workload {
+	std::string name;
+	uint32_t buttons; // Held for the built-in sessions
+	bool rescue; // Collect the hostages before the run
+	std::string replay_path; // Recording to play instead, if not empty
+};
+
+// Measurements of a workload
+struct WorkloadResult {
+	std::string name;
+	RunStats stats;
+	unsigned long long allocations;
+};
+
+
+// Run 'workload' in a new game and measure it. 'ticks' of 0 runs a
+// recording for all of its ticks
+static WorkloadResult RunWorkload(const Workload &workload, int ticks, bool headless, int extra_enemies) {
+
+	WorkloadResult result;
+	result.name = workload.name;
+	result.allocations = 0;
+
+	ReplayInput replay;
+	HeldInput held(workload.buttons, glm::vec2(idle_turn_g, 0.0f));
+	InputSource *input = &held;
+	Game *app = new Game();
+	try {
+		if (!workload.replay_path.empty()) {
+			if (!replay.Load(workload.replay_path)) {
+				throw(GameException(std::string("Could not read input recording ") + workload.replay_path));
+			}
+			app->UseSettings(replay.GetSettings());
+			extra_enemies = replay.GetSettings().extra_enemies;
+			if (ticks <= 0) {
+				ticks = (int) std::min<uint64_t>(std::max<uint64_t>(replay.GetTickCount(), 1), INT_MAX);
+			}
+			input = &replay;
+		}
+		// Every workload generates its world, so none depends on what an
+		// earlier one saved, and no files are left behind
+		app->SetSnapshotPath("");
+		app->SetHeadless(headless);
+		app->SetOffscreen(!headless);
+		app->Init();
+		app->SetupResources();
+		app->SetupScene();
+		if (extra_enemies > 0) {
+			app->SpawnEnemies(extra_enemies);
+		}
+		if (workload.rescue) {
+			app->RescueHostages();
+		}
+
+		unsigned long long start = EngineCounters::GetAllocationTotal();
+		if (headless) {
+			app->RunHeadless(ticks, *input, result.stats);
+		} else {
+			app->RunBenchmark(ticks, *input, result.stats);
+		}
+		result.allocations = EngineCounters::GetAllocationTotal() - start;
+	}
+	catch (...) {
+		delete app;
+		throw;
+	}
+	delete app;
+	return result;
+}
+
+
+// Write the percentiles of 'times' as a JSON object, unless there are
+// none, as for frames of headless runs
+static void WritePercentiles(std::ostream &out, const char *name, const std::vector<double> &times) {
+
+	if (times.empty()) {
+		return;
+	}
+	out << "      \"" << name << "\": { \"p50\": " << GetPercentile(times, 0.50) << ", \"p95\": " << GetPercentile(times, 0.95)
+		<< ", \"p99\": " << GetPercentile(times, 0.99) << ", \"max\": " << GetPercentile(times, 1.0) << " },\n";
+}
+
+
+static void WriteResults(std::ostream &out, const std::vector<WorkloadResult> &results, bool headless) {
+
+	out << std::fixed << std::setprecision(4);
+	out << "{\n  \"mode\": \"" << (headless ? "headless" : "offscreen") << "\",\n  \"workloads\": {\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const WorkloadResult &result = results[i];
+		const RunStats &stats = result.stats;
+		long long draw_calls = 0;
+		for (size_t f = 0; f < stats.frame_draw_calls.size(); f++) {
+			draw_calls += stats.frame_draw_calls[f];
+		}
+		// Allocations are counted over the warm-up too
+		int ticks = std::max(stats.ticks + stats.warmup_ticks, 1);
+		int frames = (int) stats.frame_draw_calls.size();
+
+		out << "    \"" << result.name << "\": {\n";
+		out << "      \"ticks\": " << stats.ticks << ",\n";
+		out << "      \"seconds\": " << stats.seconds << ",\n";
+		WritePercentiles(out, "tick_ms", stats.tick_times);
+		WritePercentiles(out, "cpu_frame_ms", stats.cpu_frame_times);
+		WritePercentiles(out, "gpu_frame_ms", stats.gpu_frame_times);
+		out << "      \"allocations\": " << result.allocations << ",\n";
+		out << "      \"allocations_per_tick\": " << (double) result.allocations / ticks << ",\n";
+		if (!stats.frame_draw_calls.empty()) {
+			out << "      \"draw_calls_per_frame\": " << (double) draw_calls / frames << ",\n";
+		}
+		out << "      \"entities\": " << stats.entities << ",\n";
+		out << "      \"projectiles\": " << stats.projectiles << "\n";
+		out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "  }\n}\n";
+}
+
+
+// Reads the numbers of a JSON document into 'values', keyed by their
+// path of member names joined with dots. Strings and literals are
+// skipped; enough for the files written above
+class JsonNumbers {
+
+public:
+	JsonNumbers(const std::string &text, std::map<std::string, double> &values) : text_(text), values_(values) {
+		position_ = 0;
+	}
+
+	bool Parse(void) {
+		return ParseValue("") && (SkipSpace(), position_ == text_.size());
+	}
+
+private:
+	const std::string &text_;
+	std::map<std::string, double> &values_;
+	size_t position_;
+
+	void SkipSpace(void) {
+		while (position_ < text_.size() && isspace((unsigned char) text_[position_])) {
+			position_++;
+		}
+	}
+
+	bool ParseString(std::string &value) {
+		if (position_ >= text_.size() || text_[position_] != '"') {
+			return false;
+		}
+		value.clear();
+		for (position_++; position_ < text_.size() && text_[position_] != '"'; position_++) {
+			if (text_[position_] == '\\') {
+				position_++;
+			}
+			if (position_ < text_.size()) {
+				value += text_[position_];
+			}
+		}
+		return position_++ < text_.size();
+	}
+
+	bool ParseValue(const std::string &path) {
+		SkipSpace();
+		if (position_ >= text_.size()) {
+			return false;
+		}
+		char c = text_[position_];
+		if (c == '{' || c == '[') {
+			char close = c == '{' ? '}' : ']';
+			position_++;
+			SkipSpace();
+			for (int index = 0; position_ < text_.size() && text_[position_] != close; index++) {
+				std::string key;
+				if (c == '{') {
+					if (!ParseString(key)) {
+						return false;
+					}
+					SkipSpace();
+					if (position_ >= text_.size() || text_[position_++] != ':') {
+						return false;
+					}
+				} else {
+					std::stringstream ss;
+					ss << index;
+					key = ss.str();
+				}
+				if (!ParseValue(path.empty() ? key : path + "." + key)) {
+					return false;
+				}
+				SkipSpace();
+				if (position_ < text_.size() && text_[position_] == ',') {
+					position_++;
+					SkipSpace();
+				}
+			}
+			return position_++ < text_.size();
+		}
+		if (c == '"') {
+			std::string value;
+			return ParseString(value);
+		}
+		const char *start = text_.c_str() + position_;
+		char *end;
+		double value = strtod(start, &end);
+		if (end != start) {
+			values_[path] = value;
+			position_ += end - start;
+			return true;
+		}
+		while (position_ < text_.size() && isalpha((unsigned char) text_[position_])) {
+			position_++;
+		}
+		return text_.c_str() + position_ != start;
+	}
+
+}; // class JsonNumbers
+
+
+static bool EndsWith(const std::string &text, const std::string &end) {
+
+	return text.size() >= end.size() && text.compare(text.size() - end.size(), end.size(), end) == 0;
+}
+
+
+// Value of the "mode" member of the results in 'text', or an empty
+// string. JsonNumbers skips strings, and this is the only one compared
+static std::string GetMode(const std::string &text) {
+
+	const std::string member = "\"mode\": \"";
+	size_t start = text.find(member);
+	if (start == std::string::npos) {
+		return "";
+	}
+	start += member.size();
+	size_t end = text.find('"', start);
+	return end == std::string::npos ? "" : text.substr(start, end - start);
+}
+
+
+// Compare the results with a baseline, printing every measurement that
+// grew by more than its threshold. Returns false if any did. Largest
+// times are only reported, as one slow frame is too noisy to fail on.
+// Workloads run for another number of ticks than in the baseline fail,
+// as none of their measurements compare
+static bool CompareWithBaseline(const std::map<std::string, double> &current, const std::map<std::string, double> &baseline, double time_threshold, double count_threshold) {
+
+	bool ok = true;
+	for (std::map<std::string, double>::const_iterator it = current.begin(); it != current.end(); ++it) {
+		const std::string &key = it->first;
+		double threshold;
+		bool report_only = false;
+		if (EndsWith(key, ".ticks")) {
+			std::map<std::string, double>::const_iterator base = baseline.find(key);
+			if (base != baseline.end() && base->second != it->second) {
+				std::cerr << "Baseline " << key << " is " << base->second << ", not " << it->second << std::endl;
+				ok = false;
+			}
+			continue;
+		} else if (EndsWith(key, "_ms.p50") || EndsWith(key, "_ms.p95") || EndsWith(key, "_ms.p99")) {
+			threshold = time_threshold;
+		} else if (EndsWith(key, "_ms.max")) {
+			threshold = time_threshold;
+			report_only = true;
+		} else if (EndsWith(key, ".allocations_per_tick") || EndsWith(key, ".draw_calls_per_frame")) {
+			threshold = count_threshold;
+		} else {
+			continue;
+		}
+		std::map<std::string, double>::const_iterator base = baseline.find(key);
+		if (base == baseline.end()) {
+			continue;
+		}
+		// Results are written with 4 decimals, so smaller changes are lost
+		double limit = base->second * (1.0 + threshold) + 0.0001;
+		if (it->second > limit && report_only) {
+			std::cerr << "Slower " << key << " (not failing): " << it->second << " against " << base->second << std::endl;
+		} else if (it->second > limit) {
+			std::cerr << "Regression in " << key << ": " << it->second << " against " << base->second << std::endl;
+			ok = false;
+		}
+	}
+	return ok;
+}
+
+
+int main(int argc, char *argv[]) {
+
+	int ticks = 0;
+	bool headless = false;
+	int extra_enemies = 0;
+	std::string out_path = default_out_path_g;
+	std::string baseline_path;
+	double time_threshold = default_time_threshold_g;
+	double count_threshold = 0.0;
+	std::vector<std::string> replay_paths;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+			ticks = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--headless") == 0) {
+			headless = true;
+		} else if (strcmp(argv[i], "--enemies") == 0 && i + 1 < argc) {
+			extra_enemies = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+			replay_paths.push_back(argv[++i]);
+		} else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			out_path = argv[++i];
+		} else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+			baseline_path = argv[++i];
+		} else if (strcmp(argv[i], "--time-threshold") == 0 && i + 1 < argc) {
+			time_threshold = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--count-threshold") == 0 && i + 1 < argc) {
+			count_threshold = atof(argv[++i]);
+		} else {
+			std::cerr << "Unknown option " << argv[i] << std::endl;
+			return 1;
+		}
+	}
+
+	// Idle flight, the minigun, missile barrages and their explosions,
+	// and the minigun with hostages firing along
+	const uint32_t m1 = 1u << INPUT_M1;
+	std::vector<Workload> workloads;
+	Workload idle = { "idle", 0, false, "" };
+	Workload minigun = { "minigun", m1, false, "" };
+	Workload missiles = { "missiles", (1u << INPUT_M3) | (1u << INPUT_W), false, "" };
+	Workload hostages = { "hostages", m1, true, "" };
+	workloads.push_back(idle);
+	workloads.push_back(minigun);
+	workloads.push_back(missiles);
+	workloads.push_back(hostages);
+	for (size_t i = 0; i < replay_paths.size(); i++) {
+		std::string name = replay_paths[i].substr(replay_paths[i].find_last_of("/\\") + 1);
+		Workload replay = { "replay:" + name, 0, false, replay_paths[i] };
+		workloads.push_back(replay);
+	}
+
+	std::vector<WorkloadResult> results;
+	for (size_t i = 0; i < workloads.size(); i++) {
+		std::cerr << "Running " << workloads[i].name << std::endl;
+		int workload_ticks = ticks;
+		if (workloads[i].replay_path.empty() && workload_ticks <= 0) {
+			workload_ticks = default_ticks_g;
+		}
+		try {
+			results.push_back(RunWorkload(workloads[i], workload_ticks, headless, extra_enemies));
+		}
+		catch (std::exception &e) {
+			std::cerr << e.what() << std::endl;
+			return 1;
+		}
+	}
+
+	// The game prints its progress on stdout, so results go to a file
+	std::stringstream json;
+	WriteResults(json, results, headless);
+	std::ofstream out(out_path.c_str());
+	if (!(out << json.str())) {
+		std::cerr << "Could not write " << out_path << std::endl;
+		return 1;
+	}
+	out.close();
+
+	if (!baseline_path.empty()) {
+		std::ifstream file(baseline_path.c_str());
+		std::stringstream text;
+		text << file.rdbuf();
+		std::map<std::string, double> baseline;
+		std::map<std::string, double> current;
+		std::string baseline_text = text.str();
+		std::string current_text = json.str();
+		if (!file || !JsonNumbers(baseline_text, baseline).Parse()) {
+			std::cerr << "Could not read baseline " << baseline_path << std::endl;
+			return 1;
+		}
+		JsonNumbers(current_text, current).Parse();
+		if (GetMode(baseline_text) != GetMode(current_text)) {
+			std::cerr << "Baseline " << baseline_path << " is of a " << GetMode(baseline_text) << " run, not " << GetMode(current_text) << std::endl;
+			return 1;
+		}
+		if (!CompareWithBaseline(current, baseline, time_threshold, count_threshold)) {
+			return 1;
+		}
+		std::cerr << "No regressions against " << baseline_path << std::endl;
+	}
+	return 0;
+}
@@ -6,7 +6,7 @@ namespace game {
 
 Resource::Resource(ResourceType type, std::string name, GLuint resource, GLsizei size){
     type_ = type;
-    name_ = name;
+    name_ = StringInterner::Intern(name);
     resource_ = resource;
     size_ = size;
 }
@@ -14,7 +14,7 @@ Resource::Resource(ResourceType type, std::string name, GLuint resource, GLsizei
 
 Resource::Resource(ResourceType type, std::string name, GLuint array_buffer, GLuint element_array_buffer, GLsizei size){
     type_ = type;
-    name_ = name;
+    name_ = StringInterner::Intern(name);
     array_buffer_ = array_buffer;
     element_array_buffer_ = element_array_buffer;
     size_ = size;
@@ -23,7 +23,7 @@ Resource::Resource(ResourceType type, std::string name, GLuint array_buffer, GLu
 Resource::Resource(ResourceType type, std::string name, GLfloat *data, GLsizei size) {
 
 	type_ = type;
-	name_ = name;
+	name_ = StringInterner::Intern(name);
 	data_ = data;
 	size_ = size;
 }
@@ -39,7 +39,13 @@ ResourceType Resource::GetType(void) const {
 }
 
 
-const std::string Resource::GetName(void) const {
+const std::string &Resource::GetName(void) const {
+
+    return StringInterner::GetString(name_);
+}
+
+
+NameId Resource::GetNameId(void) const {
 
     return name_;
 }
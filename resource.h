@@ -6,6 +6,8 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include "string_interner.h"
+
 namespace game {
 
     // Possible resource types
@@ -16,7 +18,7 @@ namespace game {
 
         private:
             ResourceType type_; // Type of resource
-            std::string name_; // Reference name
+            NameId name_; // Interned reference name
             union {
                 struct {
                     GLuint resource_; // OpenGL handle for resource
@@ -37,7 +39,8 @@ namespace game {
 			Resource(ResourceType type, std::string name, GLfloat *data, GLsizei size);
             ~Resource();
             ResourceType GetType(void) const;
-            const std::string GetName(void) const;
+            const std::string &GetName(void) const;
+            NameId GetNameId(void) const;
             GLuint GetResource(void) const;
             GLuint GetArrayBuffer(void) const;
             GLuint GetElementArrayBuffer(void) const;
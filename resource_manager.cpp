@@ -11,6 +11,8 @@
 namespace game {
 
 ResourceManager::ResourceManager(void){
+
+	headless_ = false;
 }
 
 
@@ -25,6 +27,8 @@ void ResourceManager::AddResource(ResourceType type, const std::string name, GLu
 	res = new Resource(type, name, resource, size);
 
 	resource_.push_back(res);
+	// The first resource added under a name wins, as in a linear search
+	resource_index_.insert(std::make_pair(res->GetNameId(), res));
 }
 
 
@@ -35,6 +39,8 @@ void ResourceManager::AddResource(ResourceType type, const std::string name, GLu
 	res = new Resource(type, name, array_buffer, element_array_buffer, size);
 
 	resource_.push_back(res);
+	// The first resource added under a name wins, as in a linear search
+	resource_index_.insert(std::make_pair(res->GetNameId(), res));
 }
 
 void ResourceManager::AddResource(ResourceType type, const std::string name, GLfloat *data, GLsizei size) {
@@ -44,6 +50,8 @@ void ResourceManager::AddResource(ResourceType type, const std::string name, GLf
 	res = new Resource(type, name, data, size);
 
 	resource_.push_back(res);
+	// The first resource added under a name wins, as in a linear search
+	resource_index_.insert(std::make_pair(res->GetNameId(), res));
 }
 
 
@@ -65,19 +73,69 @@ void ResourceManager::LoadResource(ResourceType type, const std::string name, co
 }
 
 
+void ResourceManager::SetHeadless(bool headless) {
+
+	headless_ = headless;
+}
+
+
+bool ResourceManager::IsHeadless(void) const {
+
+	return headless_;
+}
+
+
+GLuint ResourceManager::CreateBuffer(GLenum target, GLsizeiptr size, const void *data) {
+
+	if (headless_) {
+		return 0;
+	}
+	GLuint buffer;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(target, buffer);
+	glBufferData(target, size, data, GL_STATIC_DRAW);
+	return buffer;
+}
+
+
+void ResourceManager::DeleteBuffer(GLuint buffer) {
+
+	if (!headless_) {
+		glDeleteBuffers(1, &buffer);
+	}
+}
+
+
 Resource *ResourceManager::GetResource(const std::string name) const {
 
+    // A name that was never interned cannot belong to any resource
+    NameId id = StringInterner::Find(name);
+    if (id == INVALID_NAME_ID){
+        return NULL;
+    }
+    return GetResource(id);
+}
+
+
+Resource *ResourceManager::GetResource(NameId name) const {
+
     // Find resource with the specified name
-    for (int i = 0; i < resource_.size(); i++){
-        if (resource_[i]->GetName() == name){
-            return resource_[i];
-        }
+    std::unordered_map<NameId, Resource*>::const_iterator it = resource_index_.find(name);
+    if (it == resource_index_.end()){
+        return NULL;
     }
-    return NULL;
+    return it->second;
 }
 
 void ResourceManager::LoadTexture(const std::string name, const char *filename) {
 
+	// Without a renderer the texture is only named, so lookups still
+	// find it
+	if (headless_) {
+		AddResource(Texture, name, (GLuint) 0, 0);
+		return;
+	}
+
 	// Load texture from file
 	GLuint texture = SOIL_load_OGL_texture(filename, SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID, 0);
 	if (!texture) {
@@ -91,7 +149,28 @@ void ResourceManager::LoadTexture(const std::string name, const char *filename)
 void ResourceManager::LoadMesh(const std::string name, const char *filename) {
 
 	// First load model into memory. If that goes well, we transfer the
-	// mesh to an OpenGL buffer
+	// mesh to OpenGL buffers
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	ParseMesh(filename, vertices, indices);
+
+	// Without a renderer only the size of the mesh is kept
+	if (headless_) {
+		AddResource(Mesh, name, 0, 0, (GLsizei) indices.size());
+		return;
+	}
+
+	// Create OpenGL buffers and copy data
+	GLuint vbo = CreateBuffer(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data());
+	GLuint ebo = CreateBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data());
+
+	// Create resource
+	AddResource(Mesh, name, vbo, ebo, (GLsizei) indices.size());
+}
+
+
+void ResourceManager::ParseMesh(const char *filename, std::vector<GLfloat> &vertices, std::vector<GLuint> &indices) {
+
 	TriMesh mesh;
 
 	// Parse file
@@ -278,7 +357,7 @@ void ResourceManager::LoadMesh(const std::string name, const char *filename) {
 
 	// If we got to this point, the file was parsed successfully and the
 	// mesh is in memory
-	// Now, transfer the mesh to OpenGL buffers
+	// Now, lay it out as the OpenGL buffers want it
 	// Create three new vertices for each face, in case vertex
 	// normals/texture coordinates are not consistent over the mesh
 
@@ -286,21 +365,11 @@ void ResourceManager::LoadMesh(const std::string name, const char *filename) {
 	const int vertex_att = 11;
 	const int face_att = 3;
 
-	// Create OpenGL buffers and copy data
-	GLuint vbo, ebo;
-
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, mesh.face.size() * 3 * vertex_att * sizeof(GLuint), 0, GL_STATIC_DRAW);
-
-	glGenBuffers(1, &ebo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.face.size() * face_att * sizeof(GLuint), 0, GL_STATIC_DRAW);
-
-	unsigned int vertex_index = 0;
+	vertices.assign(mesh.face.size() * 3 * vertex_att, 0.0f);
+	indices.resize(mesh.face.size() * face_att);
 	for (unsigned int i = 0; i < mesh.face.size(); i++) {
 		// Add three vertices and their attributes
-		GLfloat att[3 * vertex_att] = { 0 };
+		GLfloat *att = &vertices[i * 3 * vertex_att];
 		for (int j = 0; j < 3; j++) {
 			// Position
 			att[j*vertex_att + 0] = mesh.position[mesh.face[i].i[j]][0];
@@ -327,23 +396,14 @@ void ResourceManager::LoadMesh(const std::string name, const char *filename) {
 			}
 		}
 
-		// Copy attributes to buffer
-		glBufferSubData(GL_ARRAY_BUFFER, i * 3 * vertex_att * sizeof(GLfloat), 3 * vertex_att * sizeof(GLfloat), att);
-
 		// Add triangle
-		GLuint findex[face_att] = { 0 };
-		findex[0] = vertex_index;
-		findex[1] = vertex_index + 1;
-		findex[2] = vertex_index + 2;
-		vertex_index += 3;
-
-		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, i * face_att * sizeof(GLuint), face_att * sizeof(GLuint), findex);
+		indices[i * face_att + 0] = i * 3;
+		indices[i * face_att + 1] = i * 3 + 1;
+		indices[i * face_att + 2] = i * 3 + 2;
 	}
-
-	// Create resource
-	AddResource(Mesh, name, vbo, ebo, mesh.face.size() * face_att);
 }
 
+
 void string_trim(std::string str, std::string to_trim) {
 
 	// Trim any character in to_trim from the beginning of the string str
@@ -470,6 +530,12 @@ template <typename T> T str_to_num(const std::string &str) {
 
 void ResourceManager::LoadMaterial(const std::string name, const char *prefix) {
 
+	// Without a renderer there is nothing to compile the shaders for
+	if (headless_) {
+		AddResource(Material, name, (GLuint) 0, 0);
+		return;
+	}
+
 	// Load vertex program source code
 	std::string filename = std::string(prefix) + std::string(VERTEX_PROGRAM_EXTENSION);
 	std::string vp = LoadTextFile(filename.c_str());
@@ -677,13 +743,9 @@ void ResourceManager::CreateTorus(std::string object_name, float loop_radius, fl
     //glBindVertexArray(vao);
 
     GLuint vbo, ebo;
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertex_num * vertex_att * sizeof(GLfloat), vertex, GL_STATIC_DRAW);
+    vbo = CreateBuffer(GL_ARRAY_BUFFER, vertex_num * vertex_att * sizeof(GLfloat), vertex);
 
-    glGenBuffers(1, &ebo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, face_num * face_att * sizeof(GLuint), face, GL_STATIC_DRAW);
+    ebo = CreateBuffer(GL_ELEMENT_ARRAY_BUFFER, face_num * face_att * sizeof(GLuint), face);
 
     // Free data buffers
     delete [] vertex;
@@ -779,13 +841,9 @@ void ResourceManager::CreateSphere(std::string object_name, float radius, int nu
     //glBindVertexArray(vao);
 
     GLuint vbo, ebo;
-    glGenBuffers(1, &vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertex_num * vertex_att * sizeof(GLfloat), vertex, GL_STATIC_DRAW);
+    vbo = CreateBuffer(GL_ARRAY_BUFFER, vertex_num * vertex_att * sizeof(GLfloat), vertex);
 
-    glGenBuffers(1, &ebo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, face_num * face_att * sizeof(GLuint), face, GL_STATIC_DRAW);
+    ebo = CreateBuffer(GL_ELEMENT_ARRAY_BUFFER, face_num * face_att * sizeof(GLuint), face);
 
     // Free data buffers
     delete [] vertex;
@@ -920,14 +978,10 @@ void ResourceManager::CreateCylinder(std::string object_name, float height, floa
 
 	GLuint vbo, ebo;
 	// Create buffer for vertices
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, vertex_num * vertex_att * sizeof(GLfloat), vertex, GL_STATIC_DRAW);
+	vbo = CreateBuffer(GL_ARRAY_BUFFER, vertex_num * vertex_att * sizeof(GLfloat), vertex);
 
 	// Create buffer for faces
-	glGenBuffers(1, &ebo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, face_num * face_att * sizeof(GLuint), face, GL_STATIC_DRAW);
+	ebo = CreateBuffer(GL_ELEMENT_ARRAY_BUFFER, face_num * face_att * sizeof(GLuint), face);
 
 	// Free data buffers
 	delete[] vertex;
@@ -999,9 +1053,7 @@ void ResourceManager::CreateCube(std::string object_name) {
 
 	// Create OpenGL buffer for vertices
 	GLuint vbo;
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertex), vertex, GL_STATIC_DRAW);
+	vbo = CreateBuffer(GL_ARRAY_BUFFER, sizeof(vertex), vertex);
 	// Create resource
 	AddResource(PointSet, object_name, vbo, sizeof(vertex));
 
@@ -1009,7 +1061,7 @@ void ResourceManager::CreateCube(std::string object_name) {
 
 }
 
-void ResourceManager::CreateMissileParticles(std::string object_name, int num_particles) {
+void ResourceManager::CreateMissileParticles(std::string object_name, Random &random, int num_particles) {
 
 	// Create a set of points which will be the particles
 	// This is similar to drawing a torus
@@ -1031,7 +1083,10 @@ void ResourceManager::CreateMissileParticles(std::string object_name, int num_pa
 	for (int i = 0; i < num_particles; i++) {
 
 		// Define the normal and point based on theta and phi
-		glm::vec3 normal(glm::vec3((rand() % 40)/400.0f - 0.05, (rand() % 40)/400.0f - 0.05,-1.0));
+		// Separate statements fix the order of the draws
+		float spread_x = random.NextInt(40) / 400.0f - 0.05f;
+		float spread_y = random.NextInt(40) / 400.0f - 0.05f;
+		glm::vec3 normal(glm::vec3(spread_x, spread_y, -1.0));
 		normal = glm::normalize(normal);
 		glm::vec3 position = glm::vec3(0.0);
 		glm::vec3 color(i / (float)num_particles, 0.0, 1.0 - (i / (float)num_particles)); // The red channel of the color stores the particle id
@@ -1046,9 +1101,7 @@ void ResourceManager::CreateMissileParticles(std::string object_name, int num_pa
 
 	// Create OpenGL buffers and copy data
 	GLuint vbo;
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, num_particles * particle_att * sizeof(GLfloat), particle, GL_STATIC_DRAW);
+	vbo = CreateBuffer(GL_ARRAY_BUFFER, num_particles * particle_att * sizeof(GLfloat), particle);
 
 	// Free data buffers
 	delete[] particle;
@@ -1057,7 +1110,7 @@ void ResourceManager::CreateMissileParticles(std::string object_name, int num_pa
 	AddResource(PointSet, object_name, vbo, 0, num_particles);
 }
 
-void ResourceManager::CreateTorusParticles(std::string object_name, int num_particles, float loop_radius, float circle_radius) {
+void ResourceManager::CreateTorusParticles(std::string object_name, Random &random, int num_particles, float loop_radius, float circle_radius) {
 
 	// Create a set of points which will be the particles
 	// This is similar to drawing a torus
@@ -1084,8 +1137,8 @@ void ResourceManager::CreateTorusParticles(std::string object_name, int num_part
 		// Get a random point on a torus
 
 		// Get two random numbers
-		u = ((double)rand() / (RAND_MAX));
-		v = ((double)rand() / (RAND_MAX));
+		u = random.NextFloat();
+		v = random.NextFloat();
 
 		// Use u to define the angle theta along the loop of the torus
 		theta = u * 2.0*glm::pi<float>();
@@ -1100,9 +1153,9 @@ void ResourceManager::CreateTorusParticles(std::string object_name, int num_part
 
 																						  // Now sample a point on a sphere to define a direction for points to wander around
 																						  // Get three random numbers
-		u = ((double)rand() / (RAND_MAX));
-		v = ((double)rand() / (RAND_MAX));
-		w = ((double)rand() / (RAND_MAX));
+		u = random.NextFloat();
+		v = random.NextFloat();
+		w = random.NextFloat();
 
 		// Use u to define the angle theta along one direction of the sphere
 		theta = u * 2.0*glm::pi<float>();
@@ -1127,9 +1180,7 @@ void ResourceManager::CreateTorusParticles(std::string object_name, int num_part
 
 	// Create OpenGL buffers and copy data
 	GLuint vbo;
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, num_particles * particle_att * sizeof(GLfloat), particle, GL_STATIC_DRAW);
+	vbo = CreateBuffer(GL_ARRAY_BUFFER, num_particles * particle_att * sizeof(GLfloat), particle);
 
 	// Free data buffers
 	delete[] particle;
@@ -1139,7 +1190,7 @@ void ResourceManager::CreateTorusParticles(std::string object_name, int num_part
 }
 
 
-void ResourceManager::CreateControlPoints(std::string object_name, int num_control_points) {
+void ResourceManager::CreateControlPoints(std::string object_name, Random &random, int num_control_points) {
 
 	// Adjust number of control points, if needed, so that we have
 	// groups of four control points
@@ -1194,9 +1245,9 @@ void ResourceManager::CreateControlPoints(std::string object_name, int num_contr
 			// Other points: we can freely assign random values to them
 			// Get 3 random numbers
 			float u, v, w;
-			u = ((double)rand() / (RAND_MAX));
-			v = ((double)rand() / (RAND_MAX));
-			w = ((double)rand() / (RAND_MAX));
+			u = random.NextFloat();
+			v = random.NextFloat();
+			w = random.NextFloat();
 
 
 			// Define control points based on u, v, and w and scale by the control point index
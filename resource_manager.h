@@ -3,11 +3,13 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
 #define GLEW_STATIC
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
 #include "resource.h"
+#include "random.h"
 
 // Default extensions for different shader source files
 #define VERTEX_PROGRAM_EXTENSION "_vp.glsl"
@@ -30,8 +32,22 @@ namespace game {
             // Load a resource from a file, according to the specified type
             void LoadResource(ResourceType type, const std::string name, const char *filename);
 			void LoadTexture(const std::string name, const char *filename);
+            // Without a renderer, resources are registered with handle 0
+            // and nothing is sent to OpenGL; geometry is still built, so
+            // generators draw the same numbers. Set before loading anything
+            void SetHeadless(bool headless);
+            bool IsHeadless(void) const;
+            // Copy data to a new static buffer object, bound to 'target'.
+            // Returns 0 without a renderer
+            GLuint CreateBuffer(GLenum target, GLsizeiptr size, const void *data);
+            void DeleteBuffer(GLuint buffer);
             // Get the resource with the specified name
             Resource *GetResource(const std::string name) const;
+            Resource *GetResource(NameId name) const;
+            // Read the OBJ file 'filename' into the vertex and index arrays
+            // LoadMesh uploads, 11 floats per vertex and 3 indices per
+            // triangle. Needs no OpenGL; throws on a malformed file
+            static void ParseMesh(const char *filename, std::vector<GLfloat> &vertices, std::vector<GLuint> &indices);
 
             // Methods to create specific resources
             // Create the geometry for a torus and add it to the list of resources
@@ -39,15 +55,18 @@ namespace game {
             void CreateSphere(std::string object_name, float radius = 0.6, int num_samples_theta = 90, int num_samples_phi = 45);
 			void CreateCylinder(std::string object_name, float height = 0.0, float circle_radius = 0.2, int num_line_samples = 3, int num_circle_samples = 30, int startingPoint = -1);
 			void CreateCube(std::string object_name);
-			void CreateMissileParticles(std::string object_name, int num_particles = 200);
+			void CreateMissileParticles(std::string object_name, Random &random, int num_particles = 200);
 			void CreateParticle(std::string object_name);
-			void CreateControlPoints(std::string object_name, int num_control_points);
-			void CreateTorusParticles(std::string object_name, int num_particles = 20000, float loop_radius = 0.6, float circle_radius = 0.2);
+			void CreateControlPoints(std::string object_name, Random &random, int num_control_points);
+			void CreateTorusParticles(std::string object_name, Random &random, int num_particles = 20000, float loop_radius = 0.6, float circle_radius = 0.2);
 
         private:
             // List storing all resources
             std::vector<Resource*> resource_; 
+            // Index of the resources by interned name
+            std::unordered_map<NameId, Resource*> resource_index_;
 			GLfloat *control_point;
+			bool headless_;
  
             // Methods to load specific types of resources
             // Load shaders programs
@@ -0,0 +1,47 @@
+#include <iostream>
+#include <algorithm>
+
+#include "run_stats.h"
+
+namespace game {
+
+	double GetPercentile(std::vector<double> times, double fraction) {
+
+		if (times.empty()) {
+			return 0.0;
+		}
+		size_t rank = (size_t) (fraction * (times.size() - 1) + 0.5);
+		std::nth_element(times.begin(), times.begin() + rank, times.end());
+		return times[rank];
+	}
+
+
+	// Print the 50th, 95th and 99th percentiles and the largest of 'times'
+	static void PrintPercentiles(const char *label, const std::vector<double> &times) {
+
+		if (times.empty()) {
+			return;
+		}
+		std::cout << label << " ms: p50 " << GetPercentile(times, 0.50) << ", p95 " << GetPercentile(times, 0.95)
+			<< ", p99 " << GetPercentile(times, 0.99) << ", max " << GetPercentile(times, 1.0) << std::endl;
+	}
+
+
+	void PrintRunStats(const RunStats &stats) {
+
+		std::cout << "Ran " << stats.ticks << " ticks (" << stats.simulated_seconds << " s simulated) in " << stats.seconds << " s: "
+			<< (stats.seconds > 0.0 ? stats.ticks / stats.seconds : 0.0) << " ticks/s, " << stats.entities << " entities, "
+			<< stats.projectiles << " projectiles" << std::endl;
+		PrintPercentiles("Tick", stats.tick_times);
+		PrintPercentiles("CPU frame", stats.cpu_frame_times);
+		PrintPercentiles("GPU frame", stats.gpu_frame_times);
+		if (!stats.frame_draw_calls.empty()) {
+			long long total = 0;
+			for (size_t i = 0; i < stats.frame_draw_calls.size(); i++) {
+				total += stats.frame_draw_calls[i];
+			}
+			std::cout << "Draw calls per frame: " << (double) total / stats.frame_draw_calls.size() << std::endl;
+		}
+	}
+
+} // namespace game
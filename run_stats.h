@@ -0,0 +1,32 @@
+#ifndef RUN_STATS_H_
+#define RUN_STATS_H_
+
+#include <string>
+#include <vector>
+
+namespace game {
+
+	// Measurements of a headless or benchmark run. Times are in
+	// milliseconds, one entry per tick or per timed frame
+	struct RunStats {
+		int ticks;
+		int warmup_ticks; // Run before the measured ticks
+		double seconds; // Wall time of the whole run
+		double simulated_seconds;
+		std::vector<double> tick_times; // Game::Step, simulation only
+		std::vector<double> cpu_frame_times; // Issuing the draws of a frame
+		std::vector<double> gpu_frame_times; // Empty without timer queries
+		std::vector<int> frame_draw_calls;
+		int entities; // At the end of the run
+		int projectiles;
+	};
+
+	// Value below which 'fraction' of 'times' lie, or 0 if it is empty
+	double GetPercentile(std::vector<double> times, double fraction);
+
+	// Print the rate of a run and the percentiles of its times
+	void PrintRunStats(const RunStats &stats);
+
+} // namespace game
+
+#endif // RUN_STATS_H_
@@ -8,9 +8,13 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "scene_graph.h"
+#include "engine_counters.h"
 
 namespace game {
 
+	// Name of the node that follows the camera
+	const NameId camera_node_name_g = StringInterner::Intern("Camera");
+
 	SceneGraph::SceneGraph(void) {
 
 		background_color_ = glm::vec3(0.0, 0.0, 0.0);
@@ -39,7 +43,18 @@ namespace game {
 	}
 
 
-	SceneNode *SceneGraph::GetNode(std::string node_name) const {
+	SceneNode *SceneGraph::GetNode(const std::string &node_name) const {
+
+		// A name that was never interned cannot belong to any node
+		NameId id = StringInterner::Find(node_name);
+		if (id == INVALID_NAME_ID) {
+			return NULL;
+		}
+		return GetNode(id);
+	}
+
+
+	SceneNode *SceneGraph::GetNode(NameId node_name) const {
 
 		// Find node with the specified name
 		std::stack<SceneNode *> stck;
@@ -47,7 +62,7 @@ namespace game {
 		while (stck.size() > 0) {
 			SceneNode *current = stck.top();
 			stck.pop();
-			if (current->GetName() == node_name) {
+			if (current->GetNameId() == node_name) {
 				//std::printf("found");
 				return current;
 			}
@@ -60,8 +75,11 @@ namespace game {
 	}
 
 
-	void SceneGraph::Draw(Camera *camera) {
-		SceneNode* cameraNode = GetNode("Camera");
+	void SceneGraph::Draw(Camera *camera, float interpolation, double time) {
+		SceneNode::SetInterpolation(interpolation);
+		SceneNode::SetTime(time);
+		camera->SetInterpolation(interpolation);
+		SceneNode* cameraNode = GetNode(camera_node_name_g);
 		cameraNode->SetOrientation(camera->GetOrientation());
 		cameraNode->SetPosition(camera->GetPosition());
 		// Clear background
@@ -77,16 +95,32 @@ namespace game {
 		// Initialize stack of transformations
 		std::stack<glm::mat4> transf;
 		transf.push(glm::mat4(1.0));
-		// Traverse hierarchy
+		// Traverse hierarchy, counting the work for the engine counters
+		int traversed = 0;
+		int drawn = 0;
+		int texture_binds = 0;
+		int uniform_uploads = 0;
 		while (stck.size() > 0) {
 			// Get next node to be processed and pop it from the stack
 			SceneNode *current = stck.top();
 			stck.pop();
+			traversed++;
 			// Get transformation corresponding to the parent of the next node
 			glm::mat4 parent_transf = transf.top();
 			transf.pop();
+			// Skip hidden subtrees entirely
+			current->RefreshVisibility();
+			if (!current->GetVisible()) {
+				continue;
+			}
 			// Draw node based on parent transformation
 			glm::mat4 current_transf = current->Draw(camera, parent_transf);
+			int textures, uniforms;
+			if (current->GetDrawCounts(textures, uniforms)) {
+				drawn++;
+				texture_binds += textures;
+				uniform_uploads += uniforms;
+			}
 			// Push children of the node to the stack, along with the node's
 			// transformation
 			for (std::vector<SceneNode *>::const_iterator it = current->children_begin();
@@ -96,23 +130,63 @@ namespace game {
 
 			}
 		}
+		EngineCounters::Add(COUNTER_NODES_TRAVERSED, traversed);
+		// Each node drawn binds its program and two buffers, then makes
+		// one call
+		EngineCounters::Add(COUNTER_NODES_DRAWN, drawn);
+		EngineCounters::Add(COUNTER_DRAW_CALLS, drawn);
+		EngineCounters::Add(COUNTER_PROGRAM_BINDS, drawn);
+		EngineCounters::Add(COUNTER_BUFFER_BINDS, 2 * drawn);
+		EngineCounters::Add(COUNTER_TEXTURE_BINDS, texture_binds);
+		EngineCounters::Add(COUNTER_UNIFORM_UPLOADS, uniform_uploads);
 	}
 
 
 	void SceneGraph::Update(void) {
 
+		UpdateSubtree(root_);
+	}
+
+
+	void SceneGraph::Update(JobSystem &jobs) {
+
+		// Nodes only touch their own state in Update, so subtrees that do
+		// not share nodes can run concurrently once their parent is done
+		root_->SaveState();
+		root_->Update();
+		root_->RefreshVisibility();
+		EngineCounters::Add(COUNTER_NODES_TRAVERSED);
+
+		std::vector<SceneNode *> subtrees(root_->children_begin(), root_->children_end());
+		jobs.ParallelFor((int) subtrees.size(), 16, [&subtrees](int begin, int end) {
+			for (int i = begin; i < end; i++) {
+				UpdateSubtree(subtrees[i]);
+			}
+		});
+	}
+
+
+	void SceneGraph::UpdateSubtree(SceneNode *node) {
+
 		// Traverse hierarchy to update all nodes
 		std::stack<SceneNode *> stck;
-		stck.push(root_);
+		stck.push(node);
+		int traversed = 0;
 		while (stck.size() > 0) {
 			SceneNode *current = stck.top();
 			stck.pop();
+			traversed++;
+			current->SaveState();
 			current->Update();
+			// Parents are visited before their children, so the effective
+			// bit of the parent is already up to date here
+			current->RefreshVisibility();
 			for (std::vector<SceneNode *>::const_iterator it = current->children_begin();
 			it != current->children_end(); it++) {
 				stck.push(*it);
 			}
 		}
+		EngineCounters::Add(COUNTER_NODES_TRAVERSED, traversed);
 	}
 
 } // namespace game
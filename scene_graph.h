@@ -11,6 +11,7 @@
 #include "resource.h"
 #include "camera.h"
 #include "helicopter.h"
+#include "job_system.h"
 
 namespace game {
 
@@ -35,13 +36,23 @@ namespace game {
 		// Set root of the hierarchy
 		void SetRoot(SceneNode *node);
 		// Find a scene node with a specific name
-		SceneNode *GetNode(std::string node_name) const;
+		SceneNode *GetNode(const std::string &node_name) const;
+		SceneNode *GetNode(NameId node_name) const;
 
-		// Draw the entire scene
-		void Draw(Camera *camera);
+		// Draw the entire scene, 'interpolation' of a tick past the
+		// previous update. Animated shaders run at simulation 'time'
+		void Draw(Camera *camera, float interpolation, double time);
 
-		// Update entire scene
+		// Update entire scene. Each node first saves its state, so the
+		// next draws can interpolate from it
 		void Update(void);
+		// Update entire scene, with the subtrees under the root running
+		// as parallel jobs. Returns once every node is updated
+		void Update(JobSystem &jobs);
+
+	private:
+		// Update a node and all its descendants
+		static void UpdateSubtree(SceneNode *node);
 
 	}; // class SceneGraph
 
@@ -9,18 +9,25 @@
 
 namespace game {
 
+	VisibilitySet SceneNode::visibility_;
+	float SceneNode::interpolation_ = 1.0f;
+	double SceneNode::time_ = 0.0;
+
 	SceneNode::SceneNode() {
 
+		index_ = visibility_.Allocate();
+		parent_ = NULL;
+		has_previous_ = false;
 	}
 
 SceneNode::SceneNode(const std::string name, const Resource *geometry, const Resource *material, const Resource *texture){
 
-	visible_ = true;
-	hit = false;
+	index_ = visibility_.Allocate();
 	particle_ = false;
 	blending_ = false;
+	has_previous_ = false;
     // Set name of scene node
-    name_ = name;
+    name_ = StringInterner::Intern(name);
 
     if (geometry){
         // Set geometry
@@ -63,17 +70,20 @@ SceneNode::SceneNode(const std::string name, const Resource *geometry, const Res
 
 
 SceneNode::~SceneNode(){
+
+	visibility_.Free(index_);
 }
 
 
-const std::string SceneNode::GetName(void) const {
-	//std::cout << name_ << std::endl;
-    return name_;
+const std::string &SceneNode::GetName(void) const {
+
+    return StringInterner::GetString(name_);
 }
 
-void SceneNode::SetHit(float dmg) {
-	this->hit = true;
-	this->hitDmg = dmg;
+
+NameId SceneNode::GetNameId(void) const {
+
+    return name_;
 }
 
 glm::vec3 SceneNode::GetPosition(void) const {
@@ -96,23 +106,62 @@ glm::vec3 SceneNode::GetScale(void) const {
 
 void SceneNode::SetPosition(glm::vec3 position){
 
-	std::string test = name_;
     position_ = position;
 }
 
 void SceneNode::SetVisible(bool visible) {
-	this->visible_ = visible;
-	if (this->children_.size() > 0) {
-		for (std::vector<SceneNode *>::const_iterator it = this->children_begin();
-		it != children_end(); it++) {
-			SceneNode* current = *it;
-			current->SetVisible(visible);
-		}
+
+	visibility_.SetLocal(index_, visible);
+	RefreshVisibility();
+}
+
+bool SceneNode::GetVisible() const {
+
+	return visibility_.GetEffective(index_);
+}
+
+bool SceneNode::GetLocalVisible() const {
+
+	return visibility_.GetLocal(index_);
+}
+
+void SceneNode::RefreshVisibility(void) {
+
+	bool visible = visibility_.GetLocal(index_);
+	if (parent_) {
+		visible = visible && visibility_.GetEffective(parent_->index_);
 	}
+	visibility_.SetEffective(index_, visible);
 }
 
-bool SceneNode::GetVisible() {
-	return visible_;
+unsigned int SceneNode::GetIndex(void) const {
+
+	return index_;
+}
+
+const VisibilitySet &SceneNode::GetVisibilitySet(void) {
+
+	return visibility_;
+}
+
+
+void SceneNode::SaveState(void) {
+
+	previous_position_ = position_;
+	previous_orientation_ = orientation_;
+	has_previous_ = true;
+}
+
+
+void SceneNode::SetInterpolation(float interpolation) {
+
+	interpolation_ = interpolation;
+}
+
+
+void SceneNode::SetTime(double time) {
+
+	time_ = time;
 }
 
 
@@ -190,64 +239,75 @@ GLuint SceneNode::GetMaterial(void) const {
 
 
 glm::mat4 SceneNode::Draw(Camera *camera, glm::mat4 parent_transf){
-	if (visible_) {
-		if ((array_buffer_ > 0) && (material_ > 0)) {
-			// Select proper material (shader program)
-			if (blending_) {
-				glDisable(GL_DEPTH_TEST);
-				glEnable(GL_BLEND);
-				//glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Simpler form
-				glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-				glBlendEquationSeparate(GL_FUNC_ADD, GL_MAX);
-				glDepthFunc(GL_ALWAYS);
-			}
-
-			else {
-				glEnable(GL_DEPTH_TEST);
-				glDisable(GL_BLEND);
-				glDepthFunc(GL_LESS);
-			}
-
-			glUseProgram(material_);
-
-			// Set geometry to draw
-			glBindBuffer(GL_ARRAY_BUFFER, array_buffer_);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_array_buffer_);
-
-			// Set globals for camera
-			camera->SetupShader(material_);
-
-			for (int i = 0; i < shader_att_.size(); i++) {
-				shader_att_[i].SetupShader(material_);
-			}
-
-			// Set world matrix and other shader input variables
-			glm::mat4 transf = SetupShader(material_, parent_transf);
-
-			// Draw geometry
-			if (mode_ == GL_POINTS && !particle_) {
-				glDrawArrays(GL_TRIANGLES, 0, size_);
-			} else if (mode_ == GL_POINTS && particle_) {
-				glDrawArrays(mode_, 0, size_);
-			} else {
-				glDrawElements(mode_, size_, GL_UNSIGNED_INT, 0);
-			}
-
-			
-
-			return transf;
+	// Hidden subtrees are skipped by the scene graph before reaching here
+	if ((array_buffer_ > 0) && (material_ > 0)) {
+		// Select proper material (shader program)
+		if (blending_) {
+			glDisable(GL_DEPTH_TEST);
+			glEnable(GL_BLEND);
+			//glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA); // Simpler form
+			glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			glBlendEquationSeparate(GL_FUNC_ADD, GL_MAX);
+			glDepthFunc(GL_ALWAYS);
 		}
+
 		else {
-			glm::mat4 rotation = glm::mat4_cast(orientation_);
-			glm::mat4 translation = glm::translate(glm::mat4(1.0), position_);
-			glm::mat4 transf = parent_transf * translation * rotation;
-			return transf;
+			glEnable(GL_DEPTH_TEST);
+			glDisable(GL_BLEND);
+			glDepthFunc(GL_LESS);
+		}
+
+		glUseProgram(material_);
+
+		// Set geometry to draw
+		glBindBuffer(GL_ARRAY_BUFFER, array_buffer_);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_array_buffer_);
+
+		// Set globals for camera
+		camera->SetupShader(material_);
+
+		for (size_t i = 0; i < shader_att_.size(); i++) {
+			shader_att_[i].SetupShader(material_);
 		}
+
+		// Set world matrix and other shader input variables
+		glm::mat4 transf = SetupShader(material_, parent_transf);
+
+		// Draw geometry
+		if (mode_ == GL_POINTS && !particle_) {
+			glDrawArrays(GL_TRIANGLES, 0, size_);
+		} else if (mode_ == GL_POINTS && particle_) {
+			glDrawArrays(mode_, 0, size_);
+		} else {
+			glDrawElements(mode_, size_, GL_UNSIGNED_INT, 0);
+		}
+
+		
+
+		return transf;
+	}
+	else {
+		// Children hang off the same blended transform as drawn nodes
+		glm::mat4 local_transf;
+		return ComposeTransform(parent_transf, local_transf);
 	}
 }
 
 
 
+bool SceneNode::GetDrawCounts(int &texture_binds, int &uniform_uploads) const {
+
+	if (array_buffer_ == 0 || material_ == 0) {
+		return false;
+	}
+	// Camera matrices, shader attributes, then the world and normal
+	// matrices, timer and texture of SetupShader
+	texture_binds = texture_ ? 1 : 0;
+	uniform_uploads = 2 + (int) shader_att_.size() + 3 + texture_binds;
+	return true;
+}
+
+
 glm::quat SceneNode::GetAngM(void) const {
 
 	return angm_;
@@ -267,6 +327,25 @@ void SceneNode::Update(void) {
 
 
 
+glm::mat4 SceneNode::ComposeTransform(const glm::mat4 &parent_transf, glm::mat4 &local_transf) const {
+
+    // World transformation, blended from the previous tick unless the
+    // node appeared since
+    glm::vec3 position = position_;
+    glm::quat orientation = orientation_;
+    if (has_previous_) {
+        position = glm::mix(previous_position_, position_, interpolation_);
+        orientation = glm::slerp(previous_orientation_, orientation_, interpolation_);
+    }
+    glm::mat4 scaling = glm::scale(glm::mat4(1.0), scale_);
+    glm::mat4 rotation = glm::mat4_cast(orientation);
+    glm::mat4 translation = glm::translate(glm::mat4(1.0), position);
+    glm::mat4 transf = parent_transf * translation * rotation;
+    local_transf = transf * scaling;
+    return transf;
+}
+
+
 glm::mat4 SceneNode::SetupShader(GLuint program, glm::mat4 parent_transf){
 
     // Set attributes for shaders
@@ -286,12 +365,8 @@ glm::mat4 SceneNode::SetupShader(GLuint program, glm::mat4 parent_transf){
     glVertexAttribPointer(tex_att, 2, GL_FLOAT, GL_FALSE, 11*sizeof(GLfloat), (void *) (9*sizeof(GLfloat)));
     glEnableVertexAttribArray(tex_att);
 
-    // World transformation
-    glm::mat4 scaling = glm::scale(glm::mat4(1.0), scale_);
-    glm::mat4 rotation = glm::mat4_cast(orientation_);
-    glm::mat4 translation = glm::translate(glm::mat4(1.0), position_);
-    glm::mat4 transf = parent_transf * translation * rotation;
-    glm::mat4 local_transf = transf * scaling;
+    glm::mat4 local_transf;
+    glm::mat4 transf = ComposeTransform(parent_transf, local_transf);
 
     GLint world_mat = glGetUniformLocation(program, "world_mat");
     glUniformMatrix4fv(world_mat, 1, GL_FALSE, glm::value_ptr(local_transf));
@@ -316,8 +391,7 @@ glm::mat4 SceneNode::SetupShader(GLuint program, glm::mat4 parent_transf){
 
     // Timer
     GLint timer_var = glGetUniformLocation(program, "timer");
-    double current_time = glfwGetTime();
-    glUniform1f(timer_var, (float) current_time);
+    glUniform1f(timer_var, (float) time_);
 
     // Return transformation of node combined with parent, without scaling
     return transf;
@@ -328,12 +402,33 @@ void SceneNode::AddChild(SceneNode *node){
 
     children_.push_back(node);
     node->parent_ = this;
+    node->RefreshVisibility();
 }
 
 void SceneNode::AddChild(SceneNode *node, bool test) {
 
 	children_.insert(children_.begin(),node);
 	node->parent_ = this;
+	node->RefreshVisibility();
+}
+
+
+void SceneNode::RemoveChild(SceneNode *node) {
+
+	for (std::vector<SceneNode *>::iterator it = children_.begin();
+	it != children_.end(); it++) {
+		if (*it == node) {
+			children_.erase(it);
+			node->parent_ = NULL;
+			break;
+		}
+	}
+}
+
+
+SceneNode *SceneNode::GetParent(void) const {
+
+	return parent_;
 }
 
 
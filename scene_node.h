@@ -13,6 +13,8 @@
 #include "resource.h"
 #include "camera.h"
 #include "shader_attribute.h"
+#include "visibility_set.h"
+#include "string_interner.h"
 #include <iostream>
 namespace game {
 
@@ -25,10 +27,11 @@ namespace game {
 		SceneNode(const std::string name, const Resource *geometry, const Resource *material, const Resource *texture);
 
 		// Destructor
-		~SceneNode();
+		virtual ~SceneNode();
 
 		// Get name of node
-		const std::string GetName(void) const;
+		const std::string &GetName(void) const;
+		NameId GetNameId(void) const;
 
 		// Get node attributes
 		glm::vec3 GetPosition(void) const;
@@ -46,8 +49,27 @@ namespace game {
 		void Translate(glm::vec3 trans);
 		void Rotate(glm::quat rot);
 		void Scale(glm::vec3 scale);
+		// Visibility is stored in a shared bitset: SetVisible only writes
+		// the local bit of this node, and descendants pick up the change
+		// the next time the scene graph is traversed
 		void SetVisible(bool visible);
-		bool GetVisible();
+		// Effective visibility (local flag and all ancestors)
+		bool GetVisible() const;
+		// Flag set on this node alone
+		bool GetLocalVisible() const;
+		// Recompute the effective bit from the local bit and the parent
+		void RefreshVisibility(void);
+		// Dense index of the node, used as key for the visibility bits and
+		// for entity components. The index of a deleted node is reused
+		unsigned int GetIndex(void) const;
+		static const VisibilitySet &GetVisibilitySet(void);
+		// Keep the transformation of the last simulation tick. Nodes are
+		// drawn between it and the current one, by the fraction of a tick
+		// set with SetInterpolation
+		void SaveState(void);
+		static void SetInterpolation(float interpolation);
+		// Time passed to the timer uniform of every node drawn
+		static void SetTime(double time);
 		void SetParticle(bool particle);
 		void SetBlending(bool blend);
 		// Shader attributes
@@ -56,9 +78,17 @@ namespace game {
 		void ClearShaderAttributes(void);
 		
 
+		// Transformation of the node, blended between ticks, combined
+		// with 'parent_transf'. Returns it without scaling, as passed on
+		// to children, and sets 'local_transf' to it with scaling
+		glm::mat4 ComposeTransform(const glm::mat4 &parent_transf, glm::mat4 &local_transf) const;
+
 		// Draw the node according to scene parameters in 'camera'
 		// variable
 		virtual glm::mat4 Draw(Camera *camera, glm::mat4 parent_transf);
+		// Texture binds and uniform uploads of one call to Draw, for the
+		// engine counters. Returns false if the node draws nothing
+		bool GetDrawCounts(int &texture_binds, int &uniform_uploads) const;
 
 		// Update the node
 		virtual void Update(void);
@@ -70,21 +100,19 @@ namespace game {
 		GLsizei GetSize(void) const;
 		GLuint GetMaterial(void) const;
 
-		void SetHit(float dmg);
-
-
 		glm::quat GetAngM(void) const;
 		void SetAngM(glm::quat angm);
 
 		// Hierarchy-related methods
 		void AddChild(SceneNode *node);
 		void AddChild(SceneNode *node, bool test);
+		// Detach a child, without deleting it
+		void RemoveChild(SceneNode *node);
+		SceneNode *GetParent(void) const;
 		std::vector<SceneNode *>::const_iterator children_begin() const;
 		std::vector<SceneNode *>::const_iterator children_end() const;
 
 
-		glm::vec3 direction;
-
 		/*
 		[0] - [3] Top Four Vertices
 		[4] - [7] Bottom Four Vertices
@@ -95,7 +123,7 @@ namespace game {
 		glm::vec3* boundingBox;
 		// Hierarchy
 	protected:
-		std::string name_; // Name of the scene node
+		NameId name_; // Interned name of the scene node
 		GLuint array_buffer_; // References to geometry: vertex and array buffers
 		GLuint element_array_buffer_;
 		GLuint texture_;//texture
@@ -104,19 +132,27 @@ namespace game {
 		GLuint material_; // Reference to shader program
 		glm::vec3 position_; // Position of node
 		glm::quat orientation_; // Orientation of node
+		glm::vec3 previous_position_; // Transformation at the last tick
+		glm::quat previous_orientation_;
+		bool has_previous_; // False until the node lives through a tick
 		glm::vec3 scale_; // Scale of node
 		glm::vec3 forward;
-		bool visible_;
+		unsigned int index_; // Slot in the visibility bitset and entity id
 		bool particle_;
-		bool hit;
 		bool blending_;
-		float hitDmg;
 		glm::quat angm_;
 		
 		SceneNode *parent_;
 		std::vector<SceneNode *> children_;
 		std::vector<ShaderAttribute> shader_att_; // Shader attributes
 
+		// Visibility bits of all nodes
+		static VisibilitySet visibility_;
+
+		// Fraction of a tick drawn past the previous transformations
+		static float interpolation_;
+		static double time_;
+
 		// Set matrices that transform the node in a shader program
 		// Return transformation of current node combined with
 		// parent transformation, without including scaling
@@ -0,0 +1,230 @@
+#include <algorithm>
+
+#include "static_bvh.h"
+
+namespace game {
+
+	// Build settings
+	const int bvh_bin_count_g = 16; // Candidate split planes per axis, plus one
+	const int bvh_min_leaf_g = 2; // Nodes with this many items or less are always leaves
+	const int bvh_max_leaf_g = 8; // Nodes with more items are always split
+
+
+	StaticBVH::StaticBVH(void) {
+	}
+
+
+	StaticBVH::~StaticBVH() {
+	}
+
+
+	void StaticBVH::Build(const std::vector<AABB> &boxes) {
+
+		boxes_ = boxes;
+		nodes_.clear();
+		items_.resize(boxes.size());
+		for (size_t i = 0; i < boxes.size(); i++) {
+			items_[i] = (int) i;
+		}
+		if (boxes.empty()) {
+			return;
+		}
+
+		std::vector<glm::vec3> centers(boxes.size());
+		for (size_t i = 0; i < boxes.size(); i++) {
+			centers[i] = boxes[i].GetCenter();
+		}
+		nodes_.reserve(2 * boxes.size());
+		BuildNode(centers, 0, (int) boxes.size());
+	}
+
+
+	int StaticBVH::GetItemCount(void) const {
+
+		return (int) boxes_.size();
+	}
+
+
+	void StaticBVH::BuildNode(std::vector<glm::vec3> &centers, int begin, int end) {
+
+		// Nodes are appended in depth-first order, so keep an index:
+		// recursion may reallocate the array
+		int index = (int) nodes_.size();
+		nodes_.push_back(Node());
+
+		AABB box, center_box;
+		for (int i = begin; i < end; i++) {
+			box.Grow(boxes_[items_[i]]);
+			center_box.Grow(centers[items_[i]]);
+		}
+		int count = end - begin;
+		nodes_[index].box = box;
+		nodes_[index].first = begin;
+		nodes_[index].count = count;
+		nodes_[index].skip = index + 1;
+		if (count <= bvh_min_leaf_g) {
+			return;
+		}
+
+		// Binned surface area heuristic: bucket the centers along each
+		// axis and evaluate a split between every pair of buckets
+		float best_cost = 1e30f;
+		int best_axis = -1;
+		int best_split = 0;
+		for (int axis = 0; axis < 3; axis++) {
+			float extent = center_box.max[axis] - center_box.min[axis];
+			if (extent <= 0.0f) {
+				continue;
+			}
+			float scale = bvh_bin_count_g / extent;
+
+			AABB bin_boxes[bvh_bin_count_g];
+			int bin_counts[bvh_bin_count_g] = { 0 };
+			for (int i = begin; i < end; i++) {
+				int bin = std::min(bvh_bin_count_g - 1, (int) ((centers[items_[i]][axis] - center_box.min[axis]) * scale));
+				bin_counts[bin]++;
+				bin_boxes[bin].Grow(boxes_[items_[i]]);
+			}
+
+			// Sweep from the left, then from the right
+			float left_area[bvh_bin_count_g - 1];
+			int left_count[bvh_bin_count_g - 1];
+			AABB left;
+			int left_total = 0;
+			for (int i = 0; i < bvh_bin_count_g - 1; i++) {
+				left.Grow(bin_boxes[i]);
+				left_total += bin_counts[i];
+				left_area[i] = left_total ? left.GetHalfArea() : 0.0f;
+				left_count[i] = left_total;
+			}
+			AABB right;
+			int right_total = 0;
+			for (int i = bvh_bin_count_g - 1; i > 0; i--) {
+				right.Grow(bin_boxes[i]);
+				right_total += bin_counts[i];
+				if (left_count[i - 1] == 0 || right_total == 0) {
+					continue;
+				}
+				float cost = left_count[i - 1] * left_area[i - 1] + right_total * right.GetHalfArea();
+				if (cost < best_cost) {
+					best_cost = cost;
+					best_axis = axis;
+					best_split = i;
+				}
+			}
+		}
+
+		// Keep the leaf if splitting does not pay off
+		float leaf_cost = count * box.GetHalfArea();
+		if (count <= bvh_max_leaf_g && (best_axis < 0 || best_cost >= leaf_cost)) {
+			return;
+		}
+
+		int middle;
+		if (best_axis >= 0) {
+			float min = center_box.min[best_axis];
+			float scale = bvh_bin_count_g / (center_box.max[best_axis] - min);
+			int *middle_item = std::partition(&items_[begin], &items_[begin] + count, [&](int item) {
+				return std::min(bvh_bin_count_g - 1, (int) ((centers[item][best_axis] - min) * scale)) < best_split;
+			});
+			middle = (int) (middle_item - &items_[0]);
+		}
+		else {
+			// All centers coincide: split in two halves
+			middle = begin + count / 2;
+		}
+
+		nodes_[index].count = 0;
+		BuildNode(centers, begin, middle);
+		BuildNode(centers, middle, end);
+		nodes_[index].skip = (int) nodes_.size();
+	}
+
+
+	int StaticBVH::FindPoint(glm::vec3 point) const {
+
+		int i = 0;
+		int size = (int) nodes_.size();
+		while (i < size) {
+			const Node &node = nodes_[i];
+			if (!node.box.Contains(point)) {
+				i = node.skip;
+				continue;
+			}
+			for (int j = node.first; j < node.first + node.count; j++) {
+				if (boxes_[items_[j]].Contains(point)) {
+					return items_[j];
+				}
+			}
+			i++;
+		}
+		return -1;
+	}
+
+
+	bool StaticBVH::IntersectSegment(glm::vec3 a, glm::vec3 b, RayHit &hit) const {
+
+		return Raycast(a, b - a, 1.0f, hit);
+	}
+
+
+	bool StaticBVH::IntersectRay(glm::vec3 origin, glm::vec3 direction, float max_distance, RayHit &hit) const {
+
+		return Raycast(origin, glm::normalize(direction), max_distance, hit);
+	}
+
+
+	void StaticBVH::QuerySphere(glm::vec3 center, float radius, std::vector<int> &items) const {
+
+		int i = 0;
+		int size = (int) nodes_.size();
+		while (i < size) {
+			const Node &node = nodes_[i];
+			if (!node.box.OverlapsSphere(center, radius)) {
+				i = node.skip;
+				continue;
+			}
+			for (int j = node.first; j < node.first + node.count; j++) {
+				if (boxes_[items_[j]].OverlapsSphere(center, radius)) {
+					items.push_back(items_[j]);
+				}
+			}
+			i++;
+		}
+	}
+
+
+	bool StaticBVH::Raycast(glm::vec3 origin, glm::vec3 dir, float t_max, RayHit &hit) const {
+
+		glm::vec3 inv_dir = AABB::InverseDirection(dir);
+		hit.item = -1;
+		hit.t = t_max;
+
+		// Nodes are not visited front to back, but subtrees entered
+		// beyond the closest hit so far are skipped
+		int i = 0;
+		int size = (int) nodes_.size();
+		while (i < size) {
+			const Node &node = nodes_[i];
+			float t;
+			if (!node.box.IntersectRay(origin, inv_dir, hit.t, t)) {
+				i = node.skip;
+				continue;
+			}
+			for (int j = node.first; j < node.first + node.count; j++) {
+				if (boxes_[items_[j]].IntersectRay(origin, inv_dir, hit.t, t) && (hit.item < 0 || t < hit.t)) {
+					hit.item = items_[j];
+					hit.t = t;
+				}
+			}
+			i++;
+		}
+
+		if (hit.item < 0) {
+			return false;
+		}
+		hit.point = origin + dir * hit.t;
+		return true;
+	}
+
+} // namespace game
@@ -0,0 +1,70 @@
+#ifndef STATIC_BVH_H_
+#define STATIC_BVH_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "aabb.h"
+
+namespace game {
+
+	// Result of a ray or segment query
+	struct RayHit {
+		int item; // Item hit, or -1
+		float t; // Parameter of the hit along the ray or segment
+		glm::vec3 point;
+	};
+
+	// Bounding volume hierarchy over static boxes
+	//
+	// The tree is built once with the surface area heuristic and stored as
+	// a flat array in depth-first order. The first child of a node is the
+	// node right after it, and every node keeps the index at which its
+	// subtree ends; queries walk the array front to back, jumping to that
+	// index when a subtree can be skipped, so they need no stack
+	class StaticBVH {
+
+	public:
+		StaticBVH(void);
+		~StaticBVH();
+
+		// Build the tree over 'boxes'. Queries report items as the index of
+		// their box in this vector
+		void Build(const std::vector<AABB> &boxes);
+
+		int GetItemCount(void) const;
+
+		// First item that contains the point, or -1
+		int FindPoint(glm::vec3 point) const;
+
+		// Closest item crossed by the segment from 'a' to 'b'. 't' is in
+		// [0, 1] along the segment
+		bool IntersectSegment(glm::vec3 a, glm::vec3 b, RayHit &hit) const;
+
+		// Closest item crossed by the ray, up to 'max_distance'. 't' is the
+		// distance along the normalized direction
+		bool IntersectRay(glm::vec3 origin, glm::vec3 direction, float max_distance, RayHit &hit) const;
+
+		// Append to 'items' every item overlapping the sphere
+		void QuerySphere(glm::vec3 center, float radius, std::vector<int> &items) const;
+
+	private:
+		struct Node {
+			AABB box;
+			int skip; // Index of the first node after this subtree
+			int first; // First entry in items_, for leaves
+			int count; // Number of items, 0 for inner nodes
+		};
+
+		std::vector<Node> nodes_;
+		std::vector<int> items_; // Items referenced by the leaves
+		std::vector<AABB> boxes_; // Box of each item
+
+		void BuildNode(std::vector<glm::vec3> &centers, int begin, int end);
+		bool Raycast(glm::vec3 origin, glm::vec3 dir, float t_max, RayHit &hit) const;
+
+	}; // class StaticBVH
+
+} // namespace game
+
+#endif // STATIC_BVH_H_
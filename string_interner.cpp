@@ -0,0 +1,59 @@
+#include <stdexcept>
+
+#include "string_interner.h"
+
+namespace game {
+
+	NameId StringInterner::Intern(const std::string &str) {
+
+		Table &table = GetTable();
+		Table::const_iterator it = table.find(str);
+		if (it != table.end()) {
+			return it->second;
+		}
+
+		// Keys of an unordered_map never move, so the strings vector can
+		// point straight into the table
+		std::vector<const std::string *> &strings = GetStrings();
+		NameId id = (NameId) strings.size();
+		it = table.insert(std::make_pair(str, id)).first;
+		strings.push_back(&it->first);
+		return id;
+	}
+
+
+	NameId StringInterner::Find(const std::string &str) {
+
+		Table &table = GetTable();
+		Table::const_iterator it = table.find(str);
+		if (it == table.end()) {
+			return INVALID_NAME_ID;
+		}
+		return it->second;
+	}
+
+
+	const std::string &StringInterner::GetString(NameId id) {
+
+		std::vector<const std::string *> &strings = GetStrings();
+		if (id >= strings.size()) {
+			throw(std::out_of_range(std::string("Invalid name identifier")));
+		}
+		return *strings[id];
+	}
+
+
+	StringInterner::Table &StringInterner::GetTable(void) {
+
+		static Table table;
+		return table;
+	}
+
+
+	std::vector<const std::string *> &StringInterner::GetStrings(void) {
+
+		static std::vector<const std::string *> strings;
+		return strings;
+	}
+
+} // namespace game
@@ -0,0 +1,48 @@
+#ifndef STRING_INTERNER_H_
+#define STRING_INTERNER_H_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+
+namespace game {
+
+	// Identifier of an interned string
+	typedef uint32_t NameId;
+
+	// Returned by StringInterner::Find when the string was never interned
+	const NameId INVALID_NAME_ID = 0xFFFFFFFF;
+
+	// Global table that maps names to 32-bit identifiers
+	//
+	// Names of scene nodes and resources are interned once at creation;
+	// afterwards they are compared and looked up by identifier only. The
+	// stored strings are never released, so references returned by
+	// GetString stay valid for the lifetime of the program. The table is
+	// not thread-safe and should only be filled from the main thread
+	class StringInterner {
+
+	public:
+		// Return the identifier of a string, adding it if needed
+		static NameId Intern(const std::string &str);
+
+		// Return the identifier of a string without adding it
+		static NameId Find(const std::string &str);
+
+		// Get the string corresponding to an identifier
+		static const std::string &GetString(NameId id);
+
+	private:
+		typedef std::unordered_map<std::string, NameId> Table;
+
+		// Storage is kept in function-local statics so that other globals
+		// can intern names during static initialization
+		static Table &GetTable(void);
+		static std::vector<const std::string *> &GetStrings(void);
+
+	}; // class StringInterner
+
+} // namespace game
+
+#endif // STRING_INTERNER_H_
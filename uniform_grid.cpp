@@ -0,0 +1,136 @@
+#include <cmath>
+
+#include "uniform_grid.h"
+
+namespace game {
+
+	UniformGrid::UniformGrid(void) {
+
+		min_ = glm::vec2(0.0, 0.0);
+		cell_size_ = 1.0f;
+		columns_ = 0;
+		rows_ = 0;
+	}
+
+
+	UniformGrid::~UniformGrid() {
+	}
+
+
+	void UniformGrid::Reset(glm::vec2 min, glm::vec2 max, float cell_size) {
+
+		min_ = min;
+		cell_size_ = cell_size;
+		columns_ = (int) std::ceil((max.x - min.x) / cell_size);
+		rows_ = (int) std::ceil((max.y - min.y) / cell_size);
+		if (columns_ < 1) {
+			columns_ = 1;
+		}
+		if (rows_ < 1) {
+			rows_ = 1;
+		}
+
+		cell_start_.assign(columns_ * rows_ + 1, 0);
+		items_.clear();
+		pending_.clear();
+	}
+
+
+	void UniformGrid::Insert(int item, glm::vec2 min, glm::vec2 max) {
+
+		// Clamp to the grid, so items bigger than the world (the floor)
+		// land in every cell
+		int first_column = glm::max(GetColumn(min.x), 0);
+		int last_column = glm::min(GetColumn(max.x), columns_ - 1);
+		int first_row = glm::max(GetRow(min.y), 0);
+		int last_row = glm::min(GetRow(max.y), rows_ - 1);
+
+		for (int row = first_row; row <= last_row; row++) {
+			for (int column = first_column; column <= last_column; column++) {
+				pending_.push_back(std::make_pair(row * columns_ + column, item));
+			}
+		}
+	}
+
+
+	void UniformGrid::Build(void) {
+
+		// Counting sort of the pending items by cell, appended to the
+		// items already packed
+		std::vector<int> counts(columns_ * rows_, 0);
+		for (int cell = 0; cell < columns_ * rows_; cell++) {
+			counts[cell] = cell_start_[cell + 1] - cell_start_[cell];
+		}
+		for (size_t i = 0; i < pending_.size(); i++) {
+			counts[pending_[i].first]++;
+		}
+
+		std::vector<int> start(columns_ * rows_ + 1, 0);
+		for (int cell = 0; cell < columns_ * rows_; cell++) {
+			start[cell + 1] = start[cell] + counts[cell];
+		}
+
+		std::vector<int> items(start.back());
+		std::vector<int> next(start.begin(), start.end() - 1);
+		for (int cell = 0; cell < columns_ * rows_; cell++) {
+			for (int i = cell_start_[cell]; i < cell_start_[cell + 1]; i++) {
+				items[next[cell]++] = items_[i];
+			}
+		}
+		for (size_t i = 0; i < pending_.size(); i++) {
+			items[next[pending_[i].first]++] = pending_[i].second;
+		}
+
+		cell_start_.swap(start);
+		items_.swap(items);
+		pending_.clear();
+	}
+
+
+	const int *UniformGrid::Query(glm::vec3 point, int &count) const {
+
+		int cell = GetCell(point);
+		if (cell < 0 || items_.empty()) {
+			count = 0;
+			return NULL;
+		}
+		return GetItems(cell, count);
+	}
+
+
+	int UniformGrid::GetCellCount(void) const {
+
+		return columns_ * rows_;
+	}
+
+
+	int UniformGrid::GetCell(glm::vec3 point) const {
+
+		int column = GetColumn(point.x);
+		int row = GetRow(point.z);
+		if (column < 0 || column >= columns_ || row < 0 || row >= rows_) {
+			return -1;
+		}
+		return row * columns_ + column;
+	}
+
+
+	const int *UniformGrid::GetItems(int cell, int &count) const {
+
+		count = cell_start_[cell + 1] - cell_start_[cell];
+		return items_.data() + cell_start_[cell];
+	}
+
+
+	int UniformGrid::GetColumn(float x) const {
+
+		return (int) std::floor((x - min_.x) / cell_size_);
+	}
+
+
+	int UniformGrid::GetRow(float z) const {
+
+		return (int) std::floor((z - min_.y) / cell_size_);
+	}
+
+} // namespace game
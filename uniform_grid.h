@@ -0,0 +1,67 @@
+#ifndef UNIFORM_GRID_H_
+#define UNIFORM_GRID_H_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace game {
+
+	// Static grid of square cells over the XZ plane
+	//
+	// Each item is an integer with a rectangle on the XZ plane, and is
+	// listed in every cell its rectangle overlaps. Items are inserted once,
+	// then Build packs the lists of all cells into one array, so a point
+	// query is a cell lookup followed by a scan of a short contiguous list
+	class UniformGrid {
+
+	public:
+		UniformGrid(void);
+		~UniformGrid();
+
+		// Cover the rectangle from 'min' to 'max' (x and z) with cells of
+		// side 'cell_size'. Removes all items
+		void Reset(glm::vec2 min, glm::vec2 max, float cell_size);
+
+		// Add an item overlapping the rectangle from 'min' to 'max'. The
+		// item is not visible to queries until Build is called
+		void Insert(int item, glm::vec2 min, glm::vec2 max);
+
+		// Pack the items inserted so far
+		void Build(void);
+
+		// Items whose rectangle may contain the x and z coordinates of
+		// 'point'. Returns the first item and sets 'count'; points outside
+		// the grid have no items
+		const int *Query(glm::vec3 point, int &count) const;
+
+		// Cell containing the x and z coordinates of 'point', or -1 for
+		// points outside the grid
+		int GetCell(glm::vec3 point) const;
+
+		// Items of a cell from GetCell. Returns the first item and sets
+		// 'count'
+		const int *GetItems(int cell, int &count) const;
+
+		// Cells are numbered from 0 to GetCellCount() - 1
+		int GetCellCount(void) const;
+
+	private:
+		glm::vec2 min_;
+		float cell_size_;
+		int columns_; // Cells along x
+		int rows_; // Cells along z
+
+		std::vector<int> cell_start_; // Start of each cell's list in items_, plus the end
+		std::vector<int> items_;
+
+		// Items inserted since the last Build, as (cell, item) pairs
+		std::vector<std::pair<int, int> > pending_;
+
+		int GetColumn(float x) const;
+		int GetRow(float z) const;
+
+	}; // class UniformGrid
+
+} // namespace game
+
+#endif // UNIFORM_GRID_H_
@@ -0,0 +1,70 @@
+#include "visibility_set.h"
+
+namespace game {
+
+	VisibilitySet::VisibilitySet(void) {
+
+		size_ = 0;
+	}
+
+
+	VisibilitySet::~VisibilitySet() {
+	}
+
+
+	unsigned int VisibilitySet::Allocate(void) {
+
+		unsigned int slot;
+		if (!free_.empty()) {
+			slot = free_.back();
+			free_.pop_back();
+		}
+		else {
+			slot = size_++;
+			if ((slot >> 6) >= local_.size()) {
+				local_.emplace_back(0);
+				effective_.emplace_back(0);
+			}
+		}
+		SetLocal(slot, true);
+		SetEffective(slot, true);
+		return slot;
+	}
+
+
+	void VisibilitySet::Free(unsigned int slot) {
+
+		free_.push_back(slot);
+	}
+
+
+	unsigned int VisibilitySet::GetSize(void) const {
+
+		return size_;
+	}
+
+
+	void VisibilitySet::SetLocal(unsigned int slot, bool visible) {
+
+		uint64_t mask = ((uint64_t) 1) << (slot & 63);
+		if (visible) {
+			local_[slot >> 6].fetch_or(mask, std::memory_order_relaxed);
+		}
+		else {
+			local_[slot >> 6].fetch_and(~mask, std::memory_order_relaxed);
+		}
+	}
+
+
+	void VisibilitySet::SetEffective(unsigned int slot, bool visible) {
+
+		uint64_t mask = ((uint64_t) 1) << (slot & 63);
+		if (visible) {
+			effective_[slot >> 6].fetch_or(mask, std::memory_order_relaxed);
+		}
+		else {
+			effective_[slot >> 6].fetch_and(~mask, std::memory_order_relaxed);
+		}
+	}
+
+} // namespace game
@@ -0,0 +1,62 @@
+#ifndef VISIBILITY_SET_H_
+#define VISIBILITY_SET_H_
+
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <stdint.h>
+
+namespace game {
+
+	// Bitset that stores the visibility of every scene node
+	//
+	// Each node owns one slot with two bits. The local bit is the flag set
+	// through SceneNode::SetVisible. The effective bit is the local bit
+	// combined with the effective bit of the parent, and is refreshed
+	// while the scene graph is traversed, so hiding a subtree only writes
+	// the bits of its root
+	//
+	// Slots of deleted nodes are given back and handed out again, so the
+	// set stays as large as the most nodes alive at once
+	//
+	// Bits are set with atomic operations on their word, so nodes sharing
+	// a word can be updated from different threads. Allocate and Free must
+	// not run concurrently with anything else
+	class VisibilitySet {
+
+	public:
+		VisibilitySet(void);
+		~VisibilitySet();
+
+		// Reserve a slot, visible by default. Freed slots are reused first
+		unsigned int Allocate(void);
+
+		// Give a slot back
+		void Free(unsigned int slot);
+
+		// Number of slots ever created, in use or free
+		unsigned int GetSize(void) const;
+
+		void SetLocal(unsigned int slot, bool visible);
+		void SetEffective(unsigned int slot, bool visible);
+
+		bool GetLocal(unsigned int slot) const {
+			return (local_[slot >> 6].load(std::memory_order_relaxed) >> (slot & 63)) & 1;
+		}
+		bool GetEffective(unsigned int slot) const {
+			return (effective_[slot >> 6].load(std::memory_order_relaxed) >> (slot & 63)) & 1;
+		}
+
+	private:
+		// Atomics cannot be moved, and a deque never moves its elements
+		// when growing at the end
+		std::deque<std::atomic<uint64_t> > local_;
+		std::deque<std::atomic<uint64_t> > effective_;
+		unsigned int size_;
+		std::vector<unsigned int> free_;
+
+	}; // class VisibilitySet
+
+} // namespace game
+
+#endif // VISIBILITY_SET_H_
@@ -0,0 +1,333 @@
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "world_snapshot.h"
+
+namespace game {
+
+	// The version is bumped whenever the layout below or the generation of
+	// chunks changes
+	const char snapshot_magic_g[8] = { 'E', 'V', 'A', 'C', 'W', 'R', 'L', 'D' };
+	const uint32_t snapshot_version_g = 1;
+
+
+	// Start of the file. The arrays follow at the given offsets, each
+	// aligned to 8 bytes
+	struct WorldSnapshot::Header {
+		char magic[8];
+		uint32_t version;
+		int32_t world_size;
+		uint64_t seed;
+		float chunk_size;
+		float spacing;
+
+		// Sizes of the records, so a file from a compiler with another
+		// layout is refused
+		uint32_t lot_record;
+		uint32_t box_record;
+		uint32_t hostage_record;
+		uint32_t hostage_count;
+
+		uint64_t spawn_state;
+		uint64_t spawn_increment;
+
+		uint32_t chunk_count;
+		uint32_t lot_count; // Corners are eight per lot
+		uint32_t box_count;
+		uint32_t padding;
+		uint64_t chunks_offset;
+		uint64_t lots_offset;
+		uint64_t boxes_offset;
+		uint64_t corners_offset;
+		uint64_t hostages_offset;
+	};
+
+
+	// Chunks are sorted by column, then row
+	struct WorldSnapshot::ChunkEntry {
+		int32_t column;
+		int32_t row;
+		uint32_t first_lot;
+		uint32_t lot_count;
+		uint32_t first_box;
+		uint32_t box_count;
+	};
+
+
+	static bool ChunkBefore(const WorldChunk *a, const WorldChunk *b) {
+
+		return a->column < b->column || (a->column == b->column && a->row < b->row);
+	}
+
+
+	static uint64_t AlignOffset(uint64_t offset) {
+
+		return (offset + 7) & ~(uint64_t) 7;
+	}
+
+
+	WorldSnapshot::WorldSnapshot(void) {
+
+		data_ = NULL;
+		size_ = 0;
+	}
+
+
+	WorldSnapshot::~WorldSnapshot() {
+
+		Close();
+	}
+
+
+	bool WorldSnapshot::Load(const std::string &path, const WorldSnapshotKey &key) {
+
+		Close();
+
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG) sizeof(Header)) {
+			CloseHandle(file);
+			return false;
+		}
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		CloseHandle(file);
+		if (!mapping) {
+			return false;
+		}
+		// The view keeps the mapping alive
+		void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (!data) {
+			return false;
+		}
+		data_ = (const char *) data;
+		size_ = (size_t) size.QuadPart;
+#else
+		int file = open(path.c_str(), O_RDONLY);
+		if (file < 0) {
+			return false;
+		}
+		struct stat status;
+		if (fstat(file, &status) != 0 || status.st_size < (off_t) sizeof(Header)) {
+			close(file);
+			return false;
+		}
+		// The mapping outlives the descriptor
+		void *data = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		if (data == MAP_FAILED) {
+			return false;
+		}
+		data_ = (const char *) data;
+		size_ = (size_t) status.st_size;
+#endif
+
+		if (!Validate(key)) {
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+
+	void WorldSnapshot::Close(void) {
+
+		if (!data_) {
+			return;
+		}
+#ifdef _WIN32
+		UnmapViewOfFile(data_);
+#else
+		munmap((void *) data_, size_);
+#endif
+		data_ = NULL;
+		size_ = 0;
+	}
+
+
+	bool WorldSnapshot::IsLoaded(void) const {
+
+		return data_ != NULL;
+	}
+
+
+	bool WorldSnapshot::GetChunk(WorldChunk &chunk) const {
+
+		if (!data_) {
+			return false;
+		}
+
+		// Binary search of the sorted chunk table
+		const Header *header = GetHeader();
+		const ChunkEntry *entries = (const ChunkEntry *) (data_ + header->chunks_offset);
+		int first = 0;
+		int last = (int) header->chunk_count - 1;
+		while (first <= last) {
+			int middle = (first + last) / 2;
+			const ChunkEntry &entry = entries[middle];
+			if (entry.column == chunk.column && entry.row == chunk.row) {
+				const BuildingLot *lots = (const BuildingLot *) (data_ + header->lots_offset) + entry.first_lot;
+				const AABB *boxes = (const AABB *) (data_ + header->boxes_offset) + entry.first_box;
+				const glm::vec3 *corners = (const glm::vec3 *) (data_ + header->corners_offset) + 8 * (size_t) entry.first_lot;
+				chunk.lots.assign(lots, lots + entry.lot_count);
+				chunk.boxes.assign(boxes, boxes + entry.box_count);
+				chunk.corners.assign(corners, corners + 8 * (size_t) entry.lot_count);
+				return true;
+			}
+			if (entry.column < chunk.column || (entry.column == chunk.column && entry.row < chunk.row)) {
+				first = middle + 1;
+			} else {
+				last = middle - 1;
+			}
+		}
+		return false;
+	}
+
+
+	void WorldSnapshot::GetHostages(std::vector<HostagePlacement> &hostages) const {
+
+		if (!data_) {
+			return;
+		}
+		const Header *header = GetHeader();
+		const HostagePlacement *placements = (const HostagePlacement *) (data_ + header->hostages_offset);
+		hostages.insert(hostages.end(), placements, placements + header->hostage_count);
+	}
+
+
+	void WorldSnapshot::GetSpawnState(Random &spawn_random) const {
+
+		if (!data_) {
+			return;
+		}
+		spawn_random.SetState(GetHeader()->spawn_state, GetHeader()->spawn_increment);
+	}
+
+
+	bool WorldSnapshot::Write(const std::string &path, const WorldSnapshotKey &key, const std::vector<WorldChunk *> &chunks,
+		const std::vector<HostagePlacement> &hostages, const Random &spawn_random) {
+
+		std::vector<WorldChunk *> sorted(chunks);
+		std::sort(sorted.begin(), sorted.end(), ChunkBefore);
+
+		Header header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, snapshot_magic_g, sizeof(header.magic));
+		header.version = snapshot_version_g;
+		header.world_size = key.world_size;
+		header.seed = key.seed;
+		header.chunk_size = key.chunk_size;
+		header.spacing = key.spacing;
+		header.lot_record = sizeof(BuildingLot);
+		header.box_record = sizeof(AABB);
+		header.hostage_record = sizeof(HostagePlacement);
+		header.hostage_count = (uint32_t) hostages.size();
+		spawn_random.GetState(header.spawn_state, header.spawn_increment);
+
+		std::vector<ChunkEntry> entries(sorted.size());
+		for (size_t i = 0; i < sorted.size(); i++) {
+			entries[i].column = sorted[i]->column;
+			entries[i].row = sorted[i]->row;
+			entries[i].first_lot = header.lot_count;
+			entries[i].lot_count = (uint32_t) sorted[i]->lots.size();
+			entries[i].first_box = header.box_count;
+			entries[i].box_count = (uint32_t) sorted[i]->boxes.size();
+			header.lot_count += entries[i].lot_count;
+			header.box_count += entries[i].box_count;
+		}
+		header.chunk_count = (uint32_t) entries.size();
+		header.chunks_offset = AlignOffset(sizeof(Header));
+		header.lots_offset = AlignOffset(header.chunks_offset + entries.size() * sizeof(ChunkEntry));
+		header.boxes_offset = AlignOffset(header.lots_offset + (uint64_t) header.lot_count * sizeof(BuildingLot));
+		header.corners_offset = AlignOffset(header.boxes_offset + (uint64_t) header.box_count * sizeof(AABB));
+		header.hostages_offset = AlignOffset(header.corners_offset + (uint64_t) header.lot_count * 8 * sizeof(glm::vec3));
+
+		std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+		if (!file) {
+			return false;
+		}
+		static const char zeros[8] = { 0 };
+		uint64_t written = 0;
+		auto pad = [&](uint64_t offset) {
+			file.write(zeros, (std::streamsize) (offset - written));
+			written = offset;
+		};
+		auto write = [&](const void *bytes, size_t count) {
+			file.write((const char *) bytes, (std::streamsize) count);
+			written += count;
+		};
+
+		write(&header, sizeof(header));
+		pad(header.chunks_offset);
+		write(entries.data(), entries.size() * sizeof(ChunkEntry));
+		pad(header.lots_offset);
+		for (size_t i = 0; i < sorted.size(); i++) {
+			write(sorted[i]->lots.data(), sorted[i]->lots.size() * sizeof(BuildingLot));
+		}
+		pad(header.boxes_offset);
+		for (size_t i = 0; i < sorted.size(); i++) {
+			write(sorted[i]->boxes.data(), sorted[i]->boxes.size() * sizeof(AABB));
+		}
+		pad(header.corners_offset);
+		for (size_t i = 0; i < sorted.size(); i++) {
+			write(sorted[i]->corners.data(), sorted[i]->corners.size() * sizeof(glm::vec3));
+		}
+		pad(header.hostages_offset);
+		write(hostages.data(), hostages.size() * sizeof(HostagePlacement));
+		return (bool) file;
+	}
+
+
+	const WorldSnapshot::Header *WorldSnapshot::GetHeader(void) const {
+
+		return (const Header *) data_;
+	}
+
+
+	bool WorldSnapshot::Validate(const WorldSnapshotKey &key) const {
+
+		const Header *header = GetHeader();
+		if (memcmp(header->magic, snapshot_magic_g, sizeof(header->magic)) != 0 || header->version != snapshot_version_g) {
+			return false;
+		}
+		if (header->seed != key.seed || header->world_size != key.world_size || header->chunk_size != key.chunk_size || header->spacing != key.spacing) {
+			return false;
+		}
+		if (header->lot_record != sizeof(BuildingLot) || header->box_record != sizeof(AABB) || header->hostage_record != sizeof(HostagePlacement)) {
+			return false;
+		}
+
+		// Every array must lie inside the file, and every chunk inside the
+		// arrays
+		if (header->chunks_offset + (uint64_t) header->chunk_count * sizeof(ChunkEntry) > size_ ||
+			header->lots_offset + (uint64_t) header->lot_count * sizeof(BuildingLot) > size_ ||
+			header->boxes_offset + (uint64_t) header->box_count * sizeof(AABB) > size_ ||
+			header->corners_offset + (uint64_t) header->lot_count * 8 * sizeof(glm::vec3) > size_ ||
+			header->hostages_offset + (uint64_t) header->hostage_count * sizeof(HostagePlacement) > size_) {
+			return false;
+		}
+		const ChunkEntry *entries = (const ChunkEntry *) (data_ + header->chunks_offset);
+		for (uint32_t i = 0; i < header->chunk_count; i++) {
+			if ((uint64_t) entries[i].first_lot + entries[i].lot_count > header->lot_count ||
+				(uint64_t) entries[i].first_box + entries[i].box_count > header->box_count) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+} // namespace game
@@ -0,0 +1,81 @@
+#ifndef WORLD_SNAPSHOT_H_
+#define WORLD_SNAPSHOT_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <glm/glm.hpp>
+
+#include "chunk_streamer.h"
+#include "random.h"
+
+namespace game {
+
+	// Where a hostage and its four captors are placed
+	struct HostagePlacement {
+		int location; // Spawn point the placement was drawn from
+		glm::vec3 captors[4];
+		glm::vec3 hostage;
+	};
+
+	// Settings the generated world depends on. A snapshot is only used
+	// if all of them match
+	struct WorldSnapshotKey {
+		uint64_t seed;
+		int32_t world_size;
+		float chunk_size;
+		float spacing;
+	};
+
+	// Generated world saved to a file and mapped back into memory
+	//
+	// The file holds the lots, boxes and corners of the chunks attached at
+	// startup, the initial hostage placements and the state of the spawn
+	// generator after them. Loading maps the file and checks its header;
+	// chunks are then copied straight out of the mapping, in place of
+	// running the city generator. The file is in native byte order and
+	// layout, so a file from another platform fails the check and is
+	// written again
+	class WorldSnapshot {
+
+	public:
+		WorldSnapshot(void);
+		~WorldSnapshot();
+
+		// Map the snapshot at 'path'. Returns false, leaving nothing mapped,
+		// if the file is missing, damaged or made with another key
+		bool Load(const std::string &path, const WorldSnapshotKey &key);
+		void Close(void);
+		bool IsLoaded(void) const;
+
+		// Copy the lots, boxes and corners of the chunk at the column and
+		// row of 'chunk'. Returns false if the snapshot does not have it.
+		// Safe to call from several threads
+		bool GetChunk(WorldChunk &chunk) const;
+
+		void GetHostages(std::vector<HostagePlacement> &hostages) const;
+		void GetSpawnState(Random &spawn_random) const;
+
+		// Write a snapshot of 'chunks', which must have been generated
+		// with 'key', and of the initial spawns
+		static bool Write(const std::string &path, const WorldSnapshotKey &key, const std::vector<WorldChunk *> &chunks,
+			const std::vector<HostagePlacement> &hostages, const Random &spawn_random);
+
+	private:
+		struct Header;
+		struct ChunkEntry;
+
+		const char *data_; // Mapped file, or NULL
+		size_t size_;
+
+		const Header *GetHeader(void) const;
+		bool Validate(const WorldSnapshotKey &key) const;
+
+		WorldSnapshot(const WorldSnapshot &);
+		WorldSnapshot &operator=(const WorldSnapshot &);
+
+	}; // class WorldSnapshot
+
+} // namespace game
+
+#endif // WORLD_SNAPSHOT_H_